@@ -9,13 +9,27 @@ AC_DEFUN([AM_REFCODE_DOWNLOAD],
     AM_CONDITIONAL(REFCODE_DOWNLOAD,      test "x$REFCODE_DOWNLOAD" = "xyes")
   ])
 
-AC_DEFUN([AM_APPLY_PATCHES],
+AC_DEFUN([AM_SIMD_KERNELS],
   [
-    AC_ARG_ENABLE(apply-patches,
-      AC_HELP_STRING([--enable-apply-patches], [apply experimental optimisation patches]),
+    AC_ARG_ENABLE(simd-kernels,
+      AC_HELP_STRING([--enable-simd-kernels], [use SSE4.1/AVX2/NEON versions of the encoder correlation loops]),
       [
-        APPLY_PATCHES=$enableval
+        SIMD_KERNELS=$enableval
       ],
-    [APPLY_PATCHES=yes]) dnl Default value
-    AM_CONDITIONAL(APPLY_PATCHES,      test "x$APPLY_PATCHES" = "xyes")
+    [SIMD_KERNELS=no]) dnl Default value
+    AM_CONDITIONAL(SIMD_KERNELS,      test "x$SIMD_KERNELS" = "xyes")
+  ])
+
+AC_DEFUN([AM_PROBES],
+  [
+    AC_ARG_ENABLE(probes,
+      AC_HELP_STRING([--enable-probes], [add USDT probes and a GStreamer tracer at the codec stage boundaries]),
+      [
+        PROBES=$enableval
+      ],
+    [PROBES=no]) dnl Default value
+    if test "x$PROBES" = "xyes"; then
+      AC_CHECK_HEADER(sys/sdt.h, , AC_MSG_ERROR([--enable-probes needs sys/sdt.h (systemtap-sdt-dev)]))
+    fi
+    AM_CONDITIONAL(PROBES,      test "x$PROBES" = "xyes")
   ])
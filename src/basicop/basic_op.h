@@ -0,0 +1,577 @@
+/* GladSToNe optimised basic operators
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/*
+ * Replacement for the reference code's basic_op.h, always used by libg729.
+ * It is found before the reference header through the include path, pulls
+ * it in for the declarations of the operators it doesn't override, and
+ * redirects the rest to static inline versions.
+ *
+ * The reference operators report saturation through the process-wide
+ * Overflow flag, which codec instances running on different threads would
+ * share. Here Overflow is thread-local instead: the macro below makes
+ * every use of it in the codec, reference code included, refer to
+ * g729_overflow (see overflow.c). It goes through a function so that the
+ * block scope "extern Flag Overflow;" of some reference functions still
+ * declares the same thing.
+ *
+ * The Carry flag of the carry operators (L_add_c, L_macNs...) gets the
+ * same treatment.
+ *
+ * Every operator of basic_op.c has a version here, bit-exact including
+ * the updates of Overflow and Carry: note that sature(), and thus add(),
+ * sub(), mult(), mult_r() and div_s(), clear Overflow when they don't
+ * saturate. basic_op.c is therefore not linked at all, and nothing in the
+ * codec can reach its process-wide flags.
+ */
+
+#ifndef __G729_FAST_BASIC_OP_H__
+#define __G729_FAST_BASIC_OP_H__
+
+/* the reference declares round() as an operator, which clashes with the
+ * C99 round() of <math.h>: its declaration is renamed out of the way, the
+ * round() macro below takes over */
+#define round g729_ref_round
+#include_next "basic_op.h"
+#undef round
+
+#include <stdint.h>
+#include <stdlib.h>
+
+extern __thread Flag g729_overflow;
+extern __thread Flag g729_carry;
+
+static inline Flag *
+g729_overflow_ptr (void)
+{
+  return &g729_overflow;
+}
+
+static inline Flag *
+g729_carry_ptr (void)
+{
+  return &g729_carry;
+}
+
+#define Overflow        (*g729_overflow_ptr ())
+#define Carry           (*g729_carry_ptr ())
+
+static inline Word16
+g729_sature (Word32 L_var1)
+{
+  if (L_var1 > 0x00007fffL) {
+    Overflow = 1;
+    return MAX_16;
+  }
+
+  if (L_var1 < -0x00008000L) {
+    Overflow = 1;
+    return MIN_16;
+  }
+
+  Overflow = 0;
+  return (Word16) L_var1;
+}
+
+static inline Word16
+g729_add (Word16 var1, Word16 var2)
+{
+  return g729_sature ((Word32) var1 + var2);
+}
+
+static inline Word16
+g729_sub (Word16 var1, Word16 var2)
+{
+  return g729_sature ((Word32) var1 - var2);
+}
+
+static inline Word16
+g729_abs_s (Word16 var1)
+{
+  if (var1 == MIN_16)
+    return MAX_16;
+
+  return var1 < 0 ? -var1 : var1;
+}
+
+static inline Word16 g729_shr (Word16 var1, Word16 var2);
+
+static inline Word16
+g729_shl (Word16 var1, Word16 var2)
+{
+  Word32 resultat;
+
+  if (var2 < 0)
+    return g729_shr (var1, -var2);
+
+  if (var2 > 15) {
+    if (var1 == 0)
+      return 0;
+    Overflow = 1;
+    return var1 > 0 ? MAX_16 : MIN_16;
+  }
+
+  resultat = (Word32) var1 * ((Word32) 1 << var2);
+  if (resultat != (Word16) resultat) {
+    Overflow = 1;
+    return var1 > 0 ? MAX_16 : MIN_16;
+  }
+
+  return (Word16) resultat;
+}
+
+static inline Word16
+g729_shr (Word16 var1, Word16 var2)
+{
+  if (var2 < 0)
+    return g729_shl (var1, -var2);
+
+  if (var2 >= 15)
+    return var1 < 0 ? -1 : 0;
+
+  /* >> of a negative value is arithmetic with GCC and Clang */
+  return var1 >> var2;
+}
+
+static inline Word16
+g729_mult (Word16 var1, Word16 var2)
+{
+  return g729_sature (((Word32) var1 * var2) >> 15);
+}
+
+static inline Word32
+g729_L_mult (Word16 var1, Word16 var2)
+{
+  Word32 L_produit = (Word32) var1 * var2;
+
+  if (__builtin_expect (L_produit == 0x40000000L, 0)) {
+    Overflow = 1;
+    return MAX_32;
+  }
+
+  return L_produit * 2;
+}
+
+static inline Word16
+g729_negate (Word16 var1)
+{
+  return var1 == MIN_16 ? MAX_16 : -var1;
+}
+
+static inline Word16
+g729_extract_h (Word32 L_var1)
+{
+  return (Word16) (L_var1 >> 16);
+}
+
+static inline Word16
+g729_extract_l (Word32 L_var1)
+{
+  return (Word16) L_var1;
+}
+
+static inline Word32
+g729_L_add (Word32 L_var1, Word32 L_var2)
+{
+  int32_t L_var_out;
+
+  if (__builtin_add_overflow ((int32_t) L_var1, (int32_t) L_var2, &L_var_out)) {
+    Overflow = 1;
+    return L_var1 < 0 ? MIN_32 : MAX_32;
+  }
+
+  return L_var_out;
+}
+
+static inline Word32
+g729_L_sub (Word32 L_var1, Word32 L_var2)
+{
+  int32_t L_var_out;
+
+  if (__builtin_sub_overflow ((int32_t) L_var1, (int32_t) L_var2, &L_var_out)) {
+    Overflow = 1;
+    return L_var1 < 0 ? MIN_32 : MAX_32;
+  }
+
+  return L_var_out;
+}
+
+static inline Word16
+g729_round (Word32 L_var1)
+{
+  return g729_extract_h (g729_L_add (L_var1, 0x00008000L));
+}
+
+static inline Word32
+g729_L_mac (Word32 L_var3, Word16 var1, Word16 var2)
+{
+  return g729_L_add (L_var3, g729_L_mult (var1, var2));
+}
+
+static inline Word32
+g729_L_msu (Word32 L_var3, Word16 var1, Word16 var2)
+{
+  return g729_L_sub (L_var3, g729_L_mult (var1, var2));
+}
+
+static inline Word32
+g729_L_negate (Word32 L_var1)
+{
+  return L_var1 == MIN_32 ? MAX_32 : -L_var1;
+}
+
+static inline Word16
+g729_mult_r (Word16 var1, Word16 var2)
+{
+  return g729_sature (((Word32) var1 * var2 + 0x00004000L) >> 15);
+}
+
+static inline Word32 g729_L_shr (Word32 L_var1, Word16 var2);
+
+static inline Word32
+g729_L_shl (Word32 L_var1, Word16 var2)
+{
+  if (var2 <= 0)
+    return g729_L_shr (L_var1, -var2);
+
+  /* The reference doubles one bit at a time and saturates as soon as the
+   * value leaves the 31 bit range, so this is a saturating shift */
+  if (var2 > 31) {
+    if (L_var1 == 0)
+      return 0;
+    Overflow = 1;
+    return L_var1 > 0 ? MAX_32 : MIN_32;
+  }
+
+  if (L_var1 > (MAX_32 >> var2)) {
+    Overflow = 1;
+    return MAX_32;
+  }
+
+  if (L_var1 < (MIN_32 >> var2)) {
+    Overflow = 1;
+    return MIN_32;
+  }
+
+  return (Word32) ((uint32_t) L_var1 << var2);
+}
+
+static inline Word32
+g729_L_shr (Word32 L_var1, Word16 var2)
+{
+  if (var2 < 0)
+    return g729_L_shl (L_var1, -var2);
+
+  if (var2 >= 31)
+    return L_var1 < 0 ? -1 : 0;
+
+  return L_var1 >> var2;
+}
+
+static inline Word16
+g729_shr_r (Word16 var1, Word16 var2)
+{
+  Word16 var_out;
+
+  if (var2 > 15)
+    return 0;
+
+  var_out = g729_shr (var1, var2);
+  if (var2 > 0 && (var1 & ((Word16) 1 << (var2 - 1))) != 0)
+    var_out++;
+
+  return var_out;
+}
+
+static inline Word16
+g729_mac_r (Word32 L_var3, Word16 var1, Word16 var2)
+{
+  return g729_round (g729_L_mac (L_var3, var1, var2));
+}
+
+static inline Word16
+g729_msu_r (Word32 L_var3, Word16 var1, Word16 var2)
+{
+  return g729_round (g729_L_msu (L_var3, var1, var2));
+}
+
+static inline Word32
+g729_L_deposit_h (Word16 var1)
+{
+  return (Word32) ((uint32_t) (Word32) var1 << 16);
+}
+
+static inline Word32
+g729_L_deposit_l (Word16 var1)
+{
+  return (Word32) var1;
+}
+
+static inline Word32
+g729_L_shr_r (Word32 L_var1, Word16 var2)
+{
+  Word32 L_var_out;
+
+  if (var2 > 31)
+    return 0;
+
+  L_var_out = g729_L_shr (L_var1, var2);
+  if (var2 > 0 && (L_var1 & ((Word32) 1 << (var2 - 1))) != 0)
+    L_var_out++;
+
+  return L_var_out;
+}
+
+static inline Word32
+g729_L_abs (Word32 L_var1)
+{
+  if (L_var1 == MIN_32)
+    return MAX_32;
+
+  return L_var1 < 0 ? -L_var1 : L_var1;
+}
+
+static inline Word16
+g729_norm_s (Word16 var1)
+{
+  if (var1 == 0)
+    return 0;
+
+  if (var1 == -1)
+    return 15;
+
+  if (var1 < 0)
+    var1 = ~var1;
+
+  return __builtin_clz ((uint32_t) var1) - 17;
+}
+
+static inline Word16
+g729_norm_l (Word32 L_var1)
+{
+  if (L_var1 == 0)
+    return 0;
+
+  if (L_var1 == -1)
+    return 31;
+
+  if (L_var1 < 0)
+    L_var1 = ~L_var1;
+
+  return __builtin_clz ((uint32_t) L_var1) - 1;
+}
+
+/* L_var1 + L_var2 + Carry, wrapping; the flags as in basic_op.c */
+static inline Word32
+g729_L_add_c (Word32 L_var1, Word32 L_var2)
+{
+  Word32 L_var_out, L_test;
+  Flag carry_int;
+
+  L_var_out = (Word32) ((uint32_t) L_var1 + (uint32_t) L_var2 +
+      (uint32_t) Carry);
+  L_test = (Word32) ((uint32_t) L_var1 + (uint32_t) L_var2);
+
+  if (L_var1 > 0 && L_var2 > 0 && L_test < 0) {
+    Overflow = 1;
+    carry_int = 0;
+  } else if (L_var1 < 0 && L_var2 < 0 && L_test > 0) {
+    Overflow = 1;
+    carry_int = 1;
+  } else if ((L_var1 ^ L_var2) < 0 && L_test > 0) {
+    Overflow = 0;
+    carry_int = 1;
+  } else {
+    Overflow = 0;
+    carry_int = 0;
+  }
+
+  if (Carry) {
+    if (L_test == MAX_32) {
+      Overflow = 1;
+      Carry = carry_int;
+    } else if (L_test == (Word32) 0xffffffffL) {
+      Carry = 1;
+    } else {
+      Carry = carry_int;
+    }
+  } else {
+    Carry = carry_int;
+  }
+
+  return L_var_out;
+}
+
+static inline Word32
+g729_L_sub_c (Word32 L_var1, Word32 L_var2)
+{
+  Word32 L_var_out, L_test;
+  Flag carry_int = 0;
+
+  if (Carry) {
+    Carry = 0;
+    if (L_var2 != MIN_32)
+      return g729_L_add_c (L_var1, -L_var2);
+
+    L_var_out = (Word32) ((uint32_t) L_var1 - (uint32_t) L_var2);
+    if (L_var1 > 0) {
+      Overflow = 1;
+      Carry = 0;
+    }
+    return L_var_out;
+  }
+
+  L_var_out = (Word32) ((uint32_t) L_var1 - (uint32_t) L_var2 - 1u);
+  L_test = (Word32) ((uint32_t) L_var1 - (uint32_t) L_var2);
+
+  if (L_test < 0 && L_var1 > 0 && L_var2 < 0) {
+    Overflow = 1;
+    carry_int = 0;
+  } else if (L_test > 0 && L_var1 < 0 && L_var2 > 0) {
+    Overflow = 1;
+    carry_int = 1;
+  } else if (L_test > 0 && (L_var1 ^ L_var2) > 0) {
+    Overflow = 0;
+    carry_int = 1;
+  }
+
+  if (L_test == MIN_32)
+    Overflow = 1;
+  Carry = carry_int;
+
+  return L_var_out;
+}
+
+static inline Word32
+g729_L_macNs (Word32 L_var3, Word16 var1, Word16 var2)
+{
+  return g729_L_add_c (L_var3, g729_L_mult (var1, var2));
+}
+
+static inline Word32
+g729_L_msuNs (Word32 L_var3, Word16 var1, Word16 var2)
+{
+  return g729_L_sub_c (L_var3, g729_L_mult (var1, var2));
+}
+
+static inline Word32
+g729_L_sat (Word32 L_var1)
+{
+  if (!Overflow)
+    return L_var1;
+
+  L_var1 = Carry ? MIN_32 : MAX_32;
+  Carry = 0;
+  Overflow = 0;
+
+  return L_var1;
+}
+
+/* var1 / var2 in Q15, for 0 <= var1 <= var2, var2 > 0. The reference
+ * prints a message and exits on anything else; here it aborts. */
+static inline Word16
+g729_div_s (Word16 var1, Word16 var2)
+{
+  Word16 var_out = 0;
+  Word32 L_num, L_denom;
+  int iteration;
+
+  if (var1 > var2 || var1 < 0 || var2 <= 0)
+    abort ();
+
+  if (var1 == 0)
+    return 0;
+  if (var1 == var2)
+    return MAX_16;
+
+  L_num = var1;
+  L_denom = var2;
+  for (iteration = 0; iteration < 15; iteration++) {
+    var_out <<= 1;
+    L_num <<= 1;
+    if (L_num >= L_denom) {
+      L_num = g729_L_sub (L_num, L_denom);
+      var_out = g729_add (var_out, 1);
+    }
+  }
+
+  return var_out;
+}
+
+#define sature(a)       g729_sature (a)
+#define add(a, b)       g729_add (a, b)
+#define sub(a, b)       g729_sub (a, b)
+#define abs_s(a)        g729_abs_s (a)
+#define shl(a, b)       g729_shl (a, b)
+#define shr(a, b)       g729_shr (a, b)
+#define mult(a, b)      g729_mult (a, b)
+#define L_mult(a, b)    g729_L_mult (a, b)
+#define negate(a)       g729_negate (a)
+#define extract_h(a)    g729_extract_h (a)
+#define extract_l(a)    g729_extract_l (a)
+#define round(a)        g729_round (a)
+#define L_mac(c, a, b)  g729_L_mac (c, a, b)
+#define L_msu(c, a, b)  g729_L_msu (c, a, b)
+#define L_add(a, b)     g729_L_add (a, b)
+#define L_sub(a, b)     g729_L_sub (a, b)
+#define L_negate(a)     g729_L_negate (a)
+#define mult_r(a, b)    g729_mult_r (a, b)
+#define L_shl(a, b)     g729_L_shl (a, b)
+#define L_shr(a, b)     g729_L_shr (a, b)
+#define shr_r(a, b)     g729_shr_r (a, b)
+#define mac_r(c, a, b)  g729_mac_r (c, a, b)
+#define msu_r(c, a, b)  g729_msu_r (c, a, b)
+#define L_deposit_h(a)  g729_L_deposit_h (a)
+#define L_deposit_l(a)  g729_L_deposit_l (a)
+#define L_shr_r(a, b)   g729_L_shr_r (a, b)
+#define L_abs(a)        g729_L_abs (a)
+#define norm_s(a)       g729_norm_s (a)
+#define norm_l(a)       g729_norm_l (a)
+#define L_add_c(a, b)   g729_L_add_c (a, b)
+#define L_sub_c(a, b)   g729_L_sub_c (a, b)
+#define L_macNs(c, a, b) g729_L_macNs (c, a, b)
+#define L_msuNs(c, a, b) g729_L_msuNs (c, a, b)
+#define L_sat(a)        g729_L_sat (a)
+#define div_s(a, b)     g729_div_s (a, b)
+
+#endif /* __G729_FAST_BASIC_OP_H__ */
@@ -0,0 +1,382 @@
+/* GladSToNe g729 codec library
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "g729.h"
+#include "g729state.h"
+#include "g729bits.h"
+#include "g729probe.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct _G729Encoder {
+  G729EncState *state;
+
+  Word16 vad;
+  Word16 frameno;
+  int complexity;
+};
+
+struct _G729Decoder {
+  G729DecState *state;
+
+  int postfilter;
+  int skipped;                  /* output stages skipped since last frame */
+};
+
+#ifdef G729_PROBES
+G729StageHook g729_stage_hook;
+void *g729_stage_hook_data;
+#endif
+
+int
+g729_stage_set_hook (G729StageHook hook, void *user_data)
+{
+#ifdef G729_PROBES
+  /* the data goes first, so that a new hook never sees the old data */
+  __atomic_store_n (&g729_stage_hook, NULL, __ATOMIC_RELEASE);
+  g729_stage_hook_data = user_data;
+  __atomic_store_n (&g729_stage_hook, hook, __ATOMIC_RELEASE);
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+G729Encoder *
+g729_encoder_new (int vad)
+{
+  G729Encoder *encoder;
+
+  encoder = calloc (1, sizeof (G729Encoder));
+  if (!encoder)
+    return NULL;
+
+  encoder->state = g729_enc_state_new ();
+  if (!encoder->state) {
+    free (encoder);
+    return NULL;
+  }
+
+  encoder->vad = vad ? 1 : 0;
+  encoder->complexity = G729_COMPLEXITY_MAX;
+
+  return encoder;
+}
+
+void
+g729_encoder_set_vad (G729Encoder * encoder, int vad)
+{
+  encoder->vad = vad ? 1 : 0;
+}
+
+void
+g729_encoder_set_complexity (G729Encoder * encoder, int complexity)
+{
+  if (complexity < G729_COMPLEXITY_MIN)
+    complexity = G729_COMPLEXITY_MIN;
+  else if (complexity > G729_COMPLEXITY_MAX)
+    complexity = G729_COMPLEXITY_MAX;
+
+  encoder->complexity = complexity;
+}
+
+void
+g729_encoder_reset (G729Encoder * encoder)
+{
+  g729_enc_state_reset (encoder->state);
+  encoder->frameno = 0;
+}
+
+static void
+g729_encoder_count_frame (G729Encoder * encoder)
+{
+  /* g729_coder_frame() only needs to know whether this is the first frame;
+   * the reference encoder wraps its counter the same way */
+  if (encoder->frameno == 32767){
+    encoder->frameno = 256;
+  } else {
+    encoder->frameno++;
+  }
+}
+
+static void
+g729_encoder_analyse (G729Encoder * encoder, const int16_t * pcm)
+{
+  G729EncState *state = encoder->state;
+
+  g729_encoder_count_frame (encoder);
+
+  /* new_speech sits in the encoder's history buffer, behind the previous
+   * frames and the look-ahead, so one copy is needed */
+  memcpy(state->new_speech,pcm,RAW_FRAME_BYTES);
+
+  G729_STAGE_BEGIN (encoder, G729_STAGE_ENC_PRE_PROCESS, enc_pre_process);
+  g729_pre_process(&state->pre_process, state->new_speech, L_FRAME);
+  G729_STAGE_END (encoder, G729_STAGE_ENC_PRE_PROCESS, enc_pre_process);
+
+  G729_STAGE_BEGIN (encoder, G729_STAGE_ENC_CODER, enc_coder);
+  g729_coder_frame(state, state->parameters, encoder->frameno, encoder->vad,
+      encoder->complexity);
+  G729_STAGE_END (encoder, G729_STAGE_ENC_CODER, enc_coder);
+}
+
+static int
+g729_encoder_pack (G729Encoder * encoder, uint8_t * out)
+{
+  int size;
+
+  G729_STAGE_BEGIN (encoder, G729_STAGE_ENC_PACK, enc_pack);
+  size = g729_bits_pack (encoder->state->parameters, out);
+  G729_STAGE_END (encoder, G729_STAGE_ENC_PACK, enc_pack);
+
+  return size;
+}
+
+int
+g729_encoder_encode (G729Encoder * encoder, const int16_t * pcm, uint8_t * out)
+{
+  g729_encoder_analyse (encoder, pcm);
+
+  return g729_encoder_pack (encoder, out);
+}
+
+/* The encoders go by groups of G729_BATCH, whose data independent
+ * filters run across the group (g729lanes.c): the pre-processing, which
+ * also picks the interleaved input apart, and the filters between the LPC
+ * analysis and the searches of the active frames. The stage boundaries of
+ * a group are those of its first encoder. */
+#define G729_BATCH 32
+
+void
+g729_encoder_encode_interleaved (G729Encoder ** encoders, unsigned int n,
+    const int16_t * pcm, unsigned int stride, uint8_t * out, int * sizes)
+{
+  G729EncState *states[G729_BATCH];
+  G729EncState *active_states[G729_BATCH];
+  G729CoderFrame frames[G729_BATCH];
+  G729CoderFrame *active[G729_BATCH];
+  unsigned int base, m, i, n_active;
+
+  for (base = 0; base < n; base += G729_BATCH) {
+    m = n - base < G729_BATCH ? n - base : G729_BATCH;
+
+    for (i = 0; i < m; i++) {
+      states[i] = encoders[base + i]->state;
+      g729_encoder_count_frame (encoders[base + i]);
+    }
+
+    G729_STAGE_BEGIN (encoders[base], G729_STAGE_ENC_PRE_PROCESS,
+        enc_pre_process);
+    g729_lanes_pre_process (states, m, pcm + base, stride);
+    G729_STAGE_END (encoders[base], G729_STAGE_ENC_PRE_PROCESS,
+        enc_pre_process);
+
+    G729_STAGE_BEGIN (encoders[base], G729_STAGE_ENC_CODER, enc_coder);
+    n_active = 0;
+    for (i = 0; i < m; i++) {
+      G729Encoder *encoder = encoders[base + i];
+
+      if (g729_coder_frame_lpc (states[i], &frames[i],
+              states[i]->parameters, encoder->frameno, encoder->vad)) {
+        active_states[n_active] = states[i];
+        active[n_active++] = &frames[i];
+      }
+    }
+
+    g729_lanes_coder_filters (active_states, active, n_active);
+
+    for (i = 0; i < n_active; i++) {
+      G729Encoder *encoder = encoders[base + (active[i] - frames)];
+
+      g729_coder_frame_search (active_states[i], active[i],
+          encoder->complexity);
+    }
+    G729_STAGE_END (encoders[base], G729_STAGE_ENC_CODER, enc_coder);
+
+    for (i = 0; i < m; i++)
+      sizes[base + i] = g729_encoder_pack (encoders[base + i],
+          out + (base + i) * G729_FRAME_BYTES);
+  }
+}
+
+void
+g729_encoder_free (G729Encoder * encoder)
+{
+  if (!encoder)
+    return;
+
+  g729_enc_state_free (encoder->state);
+  free (encoder);
+}
+
+G729Decoder *
+g729_decoder_new (void)
+{
+  G729Decoder *decoder;
+
+  decoder = calloc (1, sizeof (G729Decoder));
+  if (!decoder)
+    return NULL;
+
+  decoder->state = g729_dec_state_new ();
+  if (!decoder->state) {
+    free (decoder);
+    return NULL;
+  }
+
+  decoder->postfilter = 1;
+
+  return decoder;
+}
+
+void
+g729_decoder_set_postfilter (G729Decoder * decoder, int postfilter)
+{
+  decoder->postfilter = postfilter ? 1 : 0;
+}
+
+void
+g729_decoder_reset (G729Decoder * decoder)
+{
+  g729_dec_state_reset (decoder->state);
+  decoder->skipped = 0;
+}
+
+/* Runs the decoder on state->parameters; without pcm only the decoder
+ * state is updated, the post-processing and output are skipped, and
+ * started over on the next frame with pcm */
+static void
+g729_decoder_synthesise (G729Decoder * decoder, int16_t * pcm)
+{
+  G729DecState *state = decoder->state;
+
+  G729_STAGE_BEGIN (decoder, G729_STAGE_DEC_DECODER, dec_decoder);
+  g729_decod_frame(state,
+      state->parameters, state->synth, state->decoded_az, state->pitch_lag, &state->vad);
+  G729_STAGE_END (decoder, G729_STAGE_DEC_DECODER, dec_decoder);
+
+  if (!pcm) {
+    Copy(&state->synth[L_FRAME-M], &state->synth[-M], M);
+    decoder->skipped = 1;
+    return;
+  }
+
+  /* the filter memories are those of the speech before the skipped
+   * frames, which the caller didn't play */
+  if (decoder->skipped) {
+    g729_dec_state_reset_output (state);
+    decoder->skipped = 0;
+  }
+
+  if (decoder->postfilter) {
+    G729_STAGE_BEGIN (decoder, G729_STAGE_DEC_POST_FILTER, dec_post_filter);
+    g729_post_filter(state,
+        state->synth, state->decoded_az, state->pitch_lag, state->vad);
+    G729_STAGE_END (decoder, G729_STAGE_DEC_POST_FILTER, dec_post_filter);
+  } else {
+    /* the synthesis history the post-filter would have kept, in case it's
+     * enabled again */
+    Copy(&state->synth[L_FRAME-M], &state->synth[-M], M);
+  }
+
+  G729_STAGE_BEGIN (decoder, G729_STAGE_DEC_POST_PROCESS, dec_post_process);
+  /* straight into the caller's buffer: the synthesis history is already
+   * saved */
+  g729_post_process(&state->post_process, state->synth, pcm, L_FRAME);
+  G729_STAGE_END (decoder, G729_STAGE_DEC_POST_PROCESS, dec_post_process);
+}
+
+int
+g729_decoder_decode (G729Decoder * decoder, const uint8_t * data,
+    unsigned int size, int16_t * pcm)
+{
+  G729DecState *state = decoder->state;
+
+  G729_STAGE_BEGIN (decoder, G729_STAGE_DEC_UNPACK, dec_unpack);
+
+  if (g729_bits_unpack (data, size, &state->parameters[1]) < 0) {
+    G729_STAGE_END (decoder, G729_STAGE_DEC_UNPACK, dec_unpack);
+    return -1;
+  }
+
+  state->parameters[0] = 0;           /* No frame erasure */
+
+  if(state->parameters[1] == G729_SPEECH_FRAME) {
+    /* put 1 in state->parameters[5] if parity error */
+    state->parameters[5] = !g729_bits_parity_ok (
+        state->parameters[4], state->parameters[5]);
+  }
+
+  G729_STAGE_END (decoder, G729_STAGE_DEC_UNPACK, dec_unpack);
+
+  g729_decoder_synthesise (decoder, pcm);
+
+  return pcm ? RAW_FRAME_SAMPLES : 0;
+}
+
+int
+g729_decoder_conceal (G729Decoder * decoder, int16_t * pcm)
+{
+  G729DecState *state = decoder->state;
+
+  /* g729_decod_frame() picks the frame type from the last good frame and draws
+   * random codebook indices; the rest is ignored */
+  memset (state->parameters, 0, sizeof (state->parameters));
+  state->parameters[0] = 1;           /* Frame erasure */
+  state->parameters[1] = G729_SPEECH_FRAME;
+
+  g729_decoder_synthesise (decoder, pcm);
+
+  return RAW_FRAME_SAMPLES;
+}
+
+void
+g729_decoder_free (G729Decoder * decoder)
+{
+  if (!decoder)
+    return;
+
+  g729_dec_state_free (decoder->state);
+  free (decoder);
+}
@@ -0,0 +1,162 @@
+/* GladSToNe g729 codec library
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef __G729_H__
+#define __G729_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 10 ms of 8 kHz mono audio per frame */
+#define G729_FRAME_SAMPLES 80
+
+/* Encoded frame sizes: speech, SID (Annex B) and untransmitted frames */
+#define G729_SPEECH_FRAME_SIZE 10
+#define G729_SID_FRAME_SIZE 2
+#define G729_UNTRANSMITTED_FRAME_SIZE 0
+
+typedef struct _G729Encoder G729Encoder;
+typedef struct _G729Decoder G729Decoder;
+
+/*
+ * Encoder and decoder handles are independent of each other and may be
+ * used from different threads; a single handle must not be used by two
+ * threads at once. No memory is allocated after _new().
+ */
+
+/* Returns NULL on allocation failure. vad enables Annex B VAD/DTX. */
+G729Encoder *g729_encoder_new (int vad);
+void g729_encoder_set_vad (G729Encoder *encoder, int vad);
+
+/* Search effort of the encoder. G729_COMPLEXITY_MAX, the default, runs the
+ * reference Annex A searches; 1 prunes the fixed codebook search to the
+ * most promising pulse positions, 0 also halves the open-loop pitch
+ * candidates. Every level produces a standard bitstream. */
+#define G729_COMPLEXITY_MIN 0
+#define G729_COMPLEXITY_MAX 2
+
+void g729_encoder_set_complexity (G729Encoder *encoder, int complexity);
+void g729_encoder_reset (G729Encoder *encoder);
+
+/* Encodes G729_FRAME_SAMPLES samples of pcm into out, which must have
+ * room for G729_SPEECH_FRAME_SIZE bytes. Returns the size of the encoded
+ * frame: G729_SPEECH_FRAME_SIZE, G729_SID_FRAME_SIZE or
+ * G729_UNTRANSMITTED_FRAME_SIZE. */
+int g729_encoder_encode (G729Encoder *encoder, const int16_t *pcm,
+    uint8_t *out);
+
+/* Encodes one frame for each of the n encoders, which must be distinct,
+ * straight from interleaved input. pcm holds G729_FRAME_SAMPLES samples
+ * of stride >= n channels, encoders[i] encoding channel i. out holds n
+ * blocks of G729_SPEECH_FRAME_SIZE bytes, one per encoder in the same
+ * order; the size of each encoded frame is stored in sizes. The output is
+ * that of n calls to g729_encoder_encode(), but the filters that don't
+ * depend on the signal (the input high-pass, the LPC residual, the
+ * weighting filter and the impulse responses) run across the encoders
+ * on channel-major buffers, several channels per vector; only the LPC
+ * analysis and the searches run encoder by encoder. */
+void g729_encoder_encode_interleaved (G729Encoder **encoders, unsigned int n,
+    const int16_t *pcm, unsigned int stride, uint8_t *out, int *sizes);
+void g729_encoder_free (G729Encoder *encoder);
+
+/* Returns NULL on allocation failure. */
+G729Decoder *g729_decoder_new (void);
+
+/* The post-filter (enabled by default) only improves perceived quality;
+ * disabling it saves a good share of the decoding time when the output
+ * isn't meant for human ears. */
+void g729_decoder_set_postfilter (G729Decoder *decoder, int postfilter);
+void g729_decoder_reset (G729Decoder *decoder);
+
+/* Decodes one frame of size bytes (one of the frame sizes above) into
+ * G729_FRAME_SAMPLES samples of pcm. Returns the number of samples
+ * written, or -1 if size isn't a valid frame size.
+ *
+ * With pcm NULL the frame only updates the decoder state, so that the
+ * frames after it decode as usual, and the post-filter, post-processing
+ * and output are skipped; 0 is returned. This is for callers that replace
+ * DTX periods with silence of their own: the first frame decoded with pcm
+ * after such a period starts the post-filter and post-processing over, as
+ * after g729_decoder_reset(), rather than from the memories of the speech
+ * before the silence. */
+int g729_decoder_decode (G729Decoder *decoder, const uint8_t *data,
+    unsigned int size, int16_t *pcm);
+
+/* Synthesises G729_FRAME_SAMPLES samples of pcm in place of a lost frame,
+ * through the reference frame erasure concealment. Returns the number of
+ * samples written. */
+int g729_decoder_conceal (G729Decoder *decoder, int16_t *pcm);
+void g729_decoder_free (G729Decoder *decoder);
+
+/* Processing stages of a frame, for profiling */
+typedef enum {
+  G729_STAGE_ENC_PRE_PROCESS,   /* high-pass filter and scaling */
+  G729_STAGE_ENC_CODER,         /* analysis (Coder_ld8a) */
+  G729_STAGE_ENC_PACK,          /* parameters to bitstream */
+  G729_STAGE_DEC_UNPACK,        /* bitstream to parameters, parity check */
+  G729_STAGE_DEC_DECODER,       /* synthesis (Decod_ld8a) */
+  G729_STAGE_DEC_POST_FILTER,   /* perceptual post-filter */
+  G729_STAGE_DEC_POST_PROCESS,  /* high-pass filter and up-scaling */
+  G729_N_STAGES
+} G729Stage;
+
+/* Called at the start (end = 0) and at the end (end = 1) of every stage,
+ * with the encoder or decoder handle it runs for, from the thread running
+ * it. It's on the path of every frame, so it must be quick. */
+typedef void (*G729StageHook) (const void *codec, G729Stage stage, int end,
+    void *user_data);
+
+/* Installs the stage hook for the whole process, or removes it if hook is
+ * NULL. The stage boundaries are only there in libraries configured with
+ * --enable-probes, which also carry sys/sdt.h static probes at the same
+ * places; returns 0 (and does nothing) otherwise. */
+int g729_stage_set_hook (G729StageHook hook, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __G729_H__ */
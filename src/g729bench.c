@@ -0,0 +1,597 @@
+/* GladSToNe g729 benchmark
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/*
+ * Micro benchmarks of the codec building blocks. Results are printed as
+ * a JSON object on stdout.
+ *
+ * Build with "make g729bench" in src/. The encoder complexity levels are
+ * rated on G729_BENCH_CORPUS (raw 8 kHz mono native endian samples) when
+ * it's set, on synthetic input otherwise.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "g729.h"
+#include "g729benchutil.h"
+#include "g729common.h"
+#include "g729bits.h"
+
+/* ref code includes: */
+#include "typedef.h"
+#include "basic_op.h"
+#include "ld8a.h"
+
+#define BENCH_FRAMES 1000000
+
+/* multichannel encoding: BENCH_TICKS frames of BENCH_CHANNELS channels */
+#define BENCH_CHANNELS 64
+#define BENCH_TICKS 200
+
+/* decoding: BENCH_DECODE_FRAMES frames of a single channel */
+#define BENCH_DECODE_FRAMES 5000
+
+/* whole codec runs: 32 s, eight talk spurt cycles of the silence-heavy
+ * signal */
+#define BENCH_CODEC_FRAMES 3200
+
+typedef struct {
+  double encode_ns;             /* per frame */
+  double decode_ns;
+  double encode_allocs;
+  double decode_allocs;
+  double speech_ratio;          /* frames sent as speech */
+} BenchCodec;
+
+/* A speech and a SID frame's worth of random parameters */
+static void
+bench_random_parameters (Word16 prm[2][PRM_SIZE+1])
+{
+  static const int widths[PRM_SIZE] = { 8, 10, 8, 1, 13, 4, 7, 5, 13, 4, 7 };
+  int i;
+
+  prm[0][0] = G729_SPEECH_FRAME;
+  for (i = 0; i < PRM_SIZE; i++)
+    prm[0][i+1] = rand () & ((1 << widths[i]) - 1);
+
+  prm[1][0] = G729_SID_FRAME;
+  for (i = 0; i < 4; i++)
+    prm[1][i+1] = rand () & 0xf;
+}
+
+/* Framing as done before g729bits: through the ITU serial format, one
+ * 16 bit word per bit */
+static void
+bench_framing_serial (Word16 prm[2][PRM_SIZE+1], double *pack_ns,
+    double *unpack_ns)
+{
+  Word16 serial[SERIAL_SIZE];
+  Word16 out_prm[PRM_SIZE+2];
+  uint8_t out[G729_FRAME_BYTES];
+  volatile uint8_t sink = 0;
+  double start;
+  int n, i, j;
+
+  start = bench_now ();
+  for (n = 0; n < BENCH_FRAMES; n++) {
+    prm2bits_ld8k (prm[n & 1], serial);
+
+    memset (out, 0x0, G729_FRAME_BYTES);
+    for (i = 0; i < 10; i++) {
+      for (j = 0; j < 8; j++)
+        out[i] |= serial[2+(i*8)+j] == BIT_1 ? (1<<(7-j)) : 0;
+    }
+    sink ^= out[n % G729_FRAME_BYTES];
+  }
+  *pack_ns = (bench_now () - start) / BENCH_FRAMES;
+
+  prm2bits_ld8k (prm[0], serial);
+  for (i = 0; i < 10; i++) {
+    out[i] = 0;
+    for (j = 0; j < 8; j++)
+      out[i] |= serial[2+(i*8)+j] == BIT_1 ? (1<<(7-j)) : 0;
+  }
+
+  start = bench_now ();
+  for (n = 0; n < BENCH_FRAMES; n++) {
+    serial[1] = RATE_8000;
+    for (i = 0; i < serial[1]; i++)
+      serial[2+i] = (out[i/8] & (1<<(7-i%8))) != 0 ? BIT_1 : BIT_0;
+
+    bits2prm_ld8k (&serial[1], out_prm);
+    sink ^= out_prm[2 + n % PRM_SIZE];
+  }
+  *unpack_ns = (bench_now () - start) / BENCH_FRAMES;
+}
+
+static void
+bench_framing_packed (Word16 prm[2][PRM_SIZE+1], double *pack_ns,
+    double *unpack_ns)
+{
+  Word16 out_prm[PRM_SIZE+1];
+  uint8_t out[G729_FRAME_BYTES];
+  volatile uint8_t sink = 0;
+  double start;
+  int n;
+
+  start = bench_now ();
+  for (n = 0; n < BENCH_FRAMES; n++) {
+    g729_bits_pack (prm[n & 1], out);
+    sink ^= out[n % G729_SID_BYTES];
+  }
+  *pack_ns = (bench_now () - start) / BENCH_FRAMES;
+
+  g729_bits_pack (prm[0], out);
+
+  start = bench_now ();
+  for (n = 0; n < BENCH_FRAMES; n++) {
+    g729_bits_unpack (out, G729_FRAME_BYTES, out_prm);
+    sink ^= out_prm[1 + n % PRM_SIZE];
+  }
+  *unpack_ns = (bench_now () - start) / BENCH_FRAMES;
+}
+
+/* Encodes the same interleaved input once frame by frame and once with
+ * g729_encoder_encode_interleaved(), whose filters run across the
+ * channels, returning the time per channel and frame */
+static int
+bench_interleaved (double *single_ns, double *interleaved_ns)
+{
+  G729Encoder *encoders[BENCH_CHANNELS];
+  int sizes[BENCH_CHANNELS];
+  int16_t *pcm, frame[RAW_FRAME_SAMPLES];
+  uint8_t out[BENCH_CHANNELS * G729_FRAME_BYTES];
+  double elapsed;
+  int n, c, i;
+
+  pcm = malloc (BENCH_TICKS * BENCH_CHANNELS * RAW_FRAME_BYTES);
+  if (!pcm)
+    return -1;
+
+  /* one block of BENCH_CHANNELS frames per tick, interleaved as the
+   * elements get it */
+  for (n = 0; n < BENCH_TICKS; n++)
+    for (c = 0; c < BENCH_CHANNELS; c++)
+      bench_signal (BENCH_SIGNAL_SPEECH, c, n * RAW_FRAME_SAMPLES,
+          RAW_FRAME_SAMPLES, pcm + n * BENCH_CHANNELS * RAW_FRAME_SAMPLES + c,
+          BENCH_CHANNELS);
+
+  for (c = 0; c < BENCH_CHANNELS; c++) {
+    encoders[c] = g729_encoder_new (1);
+    if (!encoders[c])
+      return -1;
+  }
+
+  elapsed = bench_now ();
+  for (n = 0; n < BENCH_TICKS; n++) {
+    for (c = 0; c < BENCH_CHANNELS; c++) {
+      for (i = 0; i < RAW_FRAME_SAMPLES; i++)
+        frame[i] = pcm[(n * RAW_FRAME_SAMPLES + i) * BENCH_CHANNELS + c];
+      g729_encoder_encode (encoders[c], frame, out + c * G729_FRAME_BYTES);
+    }
+  }
+  elapsed = bench_now () - elapsed;
+  *single_ns = elapsed / (BENCH_TICKS * BENCH_CHANNELS);
+
+  for (c = 0; c < BENCH_CHANNELS; c++)
+    g729_encoder_reset (encoders[c]);
+
+  elapsed = bench_now ();
+  for (n = 0; n < BENCH_TICKS; n++)
+    g729_encoder_encode_interleaved (encoders, BENCH_CHANNELS,
+        pcm + n * BENCH_CHANNELS * RAW_FRAME_SAMPLES, BENCH_CHANNELS, out,
+        sizes);
+  elapsed = bench_now () - elapsed;
+  *interleaved_ns = elapsed / (BENCH_TICKS * BENCH_CHANNELS);
+
+  for (c = 0; c < BENCH_CHANNELS; c++)
+    g729_encoder_free (encoders[c]);
+  free (pcm);
+
+  return 0;
+}
+
+static double
+bench_decode (G729Decoder * decoder, const uint8_t * frames, const int *sizes,
+    int postfilter)
+{
+  int16_t pcm[RAW_FRAME_SAMPLES];
+  double elapsed;
+  int n;
+
+  g729_decoder_reset (decoder);
+  g729_decoder_set_postfilter (decoder, postfilter);
+
+  elapsed = bench_now ();
+  for (n = 0; n < BENCH_DECODE_FRAMES; n++)
+    g729_decoder_decode (decoder, frames + n * G729_FRAME_BYTES, sizes[n], pcm);
+  elapsed = bench_now () - elapsed;
+
+  return elapsed / BENCH_DECODE_FRAMES;
+}
+
+/* Decodes the same encoded stream with and without the post-filter,
+ * returning the time per frame */
+static int
+bench_decoder (double *postfilter_ns, double *plain_ns)
+{
+  G729Encoder *encoder;
+  G729Decoder *decoder;
+  int16_t frame[RAW_FRAME_SAMPLES];
+  uint8_t *frames;
+  int *sizes;
+  int n;
+
+  frames = malloc (BENCH_DECODE_FRAMES * G729_FRAME_BYTES);
+  sizes = malloc (BENCH_DECODE_FRAMES * sizeof (int));
+  encoder = g729_encoder_new (0);
+  decoder = g729_decoder_new ();
+  if (!frames || !sizes || !encoder || !decoder)
+    return -1;
+
+  for (n = 0; n < BENCH_DECODE_FRAMES; n++) {
+    bench_signal (BENCH_SIGNAL_SPEECH, 0, n * RAW_FRAME_SAMPLES,
+        RAW_FRAME_SAMPLES, frame, 1);
+    sizes[n] = g729_encoder_encode (encoder, frame,
+        frames + n * G729_FRAME_BYTES);
+  }
+
+  *postfilter_ns = bench_decode (decoder, frames, sizes, 1);
+  *plain_ns = bench_decode (decoder, frames, sizes, 0);
+
+  g729_decoder_free (decoder);
+  g729_encoder_free (encoder);
+  free (sizes);
+  free (frames);
+
+  return 0;
+}
+
+/* Encodes and decodes BENCH_CODEC_FRAMES frames of signal through the
+ * public API, as a single channel */
+static int
+bench_codec (BenchSignal signal, int vad, BenchCodec * result)
+{
+  G729Encoder *encoder;
+  G729Decoder *decoder;
+  int16_t *pcm, out[RAW_FRAME_SAMPLES];
+  uint8_t *frames;
+  int *sizes;
+  int n, speech = 0;
+  double elapsed;
+
+  pcm = malloc (BENCH_CODEC_FRAMES * RAW_FRAME_BYTES);
+  frames = malloc (BENCH_CODEC_FRAMES * G729_FRAME_BYTES);
+  sizes = malloc (BENCH_CODEC_FRAMES * sizeof (int));
+  encoder = g729_encoder_new (vad);
+  decoder = g729_decoder_new ();
+  if (!pcm || !frames || !sizes || !encoder || !decoder)
+    return -1;
+
+  bench_signal (signal, 0, 0, BENCH_CODEC_FRAMES * RAW_FRAME_SAMPLES, pcm, 1);
+
+  bench_allocs_start ();
+  elapsed = bench_now ();
+  for (n = 0; n < BENCH_CODEC_FRAMES; n++)
+    sizes[n] = g729_encoder_encode (encoder, pcm + n * RAW_FRAME_SAMPLES,
+        frames + n * G729_FRAME_BYTES);
+  elapsed = bench_now () - elapsed;
+  result->encode_allocs = (double) bench_allocs_stop () / BENCH_CODEC_FRAMES;
+  result->encode_ns = elapsed / BENCH_CODEC_FRAMES;
+
+  bench_allocs_start ();
+  elapsed = bench_now ();
+  for (n = 0; n < BENCH_CODEC_FRAMES; n++)
+    g729_decoder_decode (decoder, frames + n * G729_FRAME_BYTES, sizes[n], out);
+  elapsed = bench_now () - elapsed;
+  result->decode_allocs = (double) bench_allocs_stop () / BENCH_CODEC_FRAMES;
+  result->decode_ns = elapsed / BENCH_CODEC_FRAMES;
+
+  for (n = 0; n < BENCH_CODEC_FRAMES; n++)
+    speech += sizes[n] == G729_FRAME_BYTES;
+  result->speech_ratio = (double) speech / BENCH_CODEC_FRAMES;
+
+  g729_decoder_free (decoder);
+  g729_encoder_free (encoder);
+  free (sizes);
+  free (frames);
+  free (pcm);
+
+  return 0;
+}
+
+/* Frames per second and channels kept at real time by one core follow
+ * from the time per frame, 10 ms of audio */
+static void
+bench_print_codec (const char *name, const BenchCodec * r, int last)
+{
+  printf ("    \"%s\": {\n", name);
+  printf ("      \"encode_ns_per_frame\": %.1f,\n", r->encode_ns);
+  printf ("      \"encode_frames_per_s\": %.0f,\n", 1e9 / r->encode_ns);
+  printf ("      \"encode_channels_per_core\": %.0f,\n", 1e7 / r->encode_ns);
+  printf ("      \"encode_allocs_per_frame\": %.2f,\n", r->encode_allocs);
+  printf ("      \"decode_ns_per_frame\": %.1f,\n", r->decode_ns);
+  printf ("      \"decode_frames_per_s\": %.0f,\n", 1e9 / r->decode_ns);
+  printf ("      \"decode_channels_per_core\": %.0f,\n", 1e7 / r->decode_ns);
+  printf ("      \"decode_allocs_per_frame\": %.2f,\n", r->decode_allocs);
+  printf ("      \"speech_frame_ratio\": %.3f\n", r->speech_ratio);
+  printf ("    }%s\n", last ? "" : ",");
+}
+
+/* Loads the corpus named by G729_BENCH_CORPUS, or synthesises one */
+static int16_t *
+bench_corpus (int *n_frames)
+{
+  const char *path = getenv ("G729_BENCH_CORPUS");
+  int16_t *pcm;
+  FILE *file;
+  long size;
+
+  if (!path) {
+    pcm = malloc (BENCH_DECODE_FRAMES * RAW_FRAME_BYTES);
+    if (!pcm)
+      return NULL;
+    bench_signal (BENCH_SIGNAL_SPEECH, 0, 0,
+        BENCH_DECODE_FRAMES * RAW_FRAME_SAMPLES, pcm, 1);
+    *n_frames = BENCH_DECODE_FRAMES;
+    return pcm;
+  }
+
+  file = fopen (path, "rb");
+  if (!file)
+    return NULL;
+  fseek (file, 0, SEEK_END);
+  size = ftell (file);
+  fseek (file, 0, SEEK_SET);
+
+  *n_frames = size / RAW_FRAME_BYTES;
+  pcm = malloc (*n_frames * RAW_FRAME_BYTES + 1);
+  if (pcm && fread (pcm, RAW_FRAME_BYTES, *n_frames, file) != *n_frames) {
+    free (pcm);
+    pcm = NULL;
+  }
+  fclose (file);
+
+  return pcm;
+}
+
+/* Segmental SNR of out against ref delayed by delay samples, over the
+ * frames that aren't silent, each one clamped to [-10, 35] dB */
+static double
+bench_segsnr (const int16_t * ref, const int16_t * out, int n_frames,
+    int delay)
+{
+  double signal, noise, diff, sum = 0.0, snr;
+  int n, i, counted = 0;
+
+  for (n = 0; n < n_frames; n++) {
+    if ((n + 1) * RAW_FRAME_SAMPLES + delay > n_frames * RAW_FRAME_SAMPLES)
+      break;
+
+    signal = noise = 0.0;
+    for (i = n * RAW_FRAME_SAMPLES; i < (n + 1) * RAW_FRAME_SAMPLES; i++) {
+      diff = ref[i] - out[i + delay];
+      signal += (double) ref[i] * ref[i];
+      noise += diff * diff;
+    }
+    if (signal < RAW_FRAME_SAMPLES * 100.0)
+      continue;
+
+    snr = 10.0 * log10 (signal / (noise + 1.0));
+    sum += snr < -10.0 ? -10.0 : snr > 35.0 ? 35.0 : snr;
+    counted++;
+  }
+
+  return counted ? sum / counted : 0.0;
+}
+
+/* Encodes the corpus at every complexity level, returning the encoding
+ * time per frame and the segmental SNR of the decoded result */
+static int
+bench_complexity (double *ns, double *segsnr, int *frames)
+{
+  G729Encoder *encoder;
+  G729Decoder *decoder;
+  int16_t *pcm, *out;
+  uint8_t *coded;
+  int *sizes;
+  int n_frames, level, n, delay, best_delay = 0;
+  double elapsed, snr;
+
+  pcm = bench_corpus (&n_frames);
+  if (!pcm)
+    return -1;
+
+  out = malloc (n_frames * RAW_FRAME_BYTES);
+  coded = malloc (n_frames * G729_FRAME_BYTES);
+  sizes = malloc (n_frames * sizeof (int));
+  encoder = g729_encoder_new (0);
+  decoder = g729_decoder_new ();
+  if (!out || !coded || !sizes || !encoder || !decoder)
+    return -1;
+
+  for (level = G729_COMPLEXITY_MAX; level >= G729_COMPLEXITY_MIN; level--) {
+    g729_encoder_reset (encoder);
+    g729_encoder_set_complexity (encoder, level);
+
+    elapsed = bench_now ();
+    for (n = 0; n < n_frames; n++)
+      sizes[n] = g729_encoder_encode (encoder, pcm + n * RAW_FRAME_SAMPLES,
+          coded + n * G729_FRAME_BYTES);
+    elapsed = bench_now () - elapsed;
+    ns[level] = elapsed / n_frames;
+
+    g729_decoder_reset (decoder);
+    for (n = 0; n < n_frames; n++)
+      g729_decoder_decode (decoder, coded + n * G729_FRAME_BYTES, sizes[n],
+          out + n * RAW_FRAME_SAMPLES);
+
+    /* the codec delay, measured once on the reference searches */
+    if (level == G729_COMPLEXITY_MAX) {
+      segsnr[level] = -100.0;
+      for (delay = 0; delay <= 2 * RAW_FRAME_SAMPLES; delay++) {
+        snr = bench_segsnr (pcm, out, n_frames, delay);
+        if (snr > segsnr[level]) {
+          segsnr[level] = snr;
+          best_delay = delay;
+        }
+      }
+    } else {
+      segsnr[level] = bench_segsnr (pcm, out, n_frames, best_delay);
+    }
+  }
+
+  *frames = n_frames;
+
+  g729_decoder_free (decoder);
+  g729_encoder_free (encoder);
+  free (sizes);
+  free (coded);
+  free (out);
+  free (pcm);
+
+  return 0;
+}
+
+int
+main (int argc, char **argv)
+{
+  Word16 prm[2][PRM_SIZE+1];
+  double serial_pack, serial_unpack, packed_pack, packed_unpack;
+  double single_ns, interleaved_ns;
+  double postfilter_ns, plain_ns;
+  double complexity_ns[G729_COMPLEXITY_MAX + 1];
+  double complexity_snr[G729_COMPLEXITY_MAX + 1];
+  int complexity_frames, level;
+  BenchCodec speech, speech_vad, silence_vad;
+
+  srand (1);
+  bench_random_parameters (prm);
+
+  if (bench_codec (BENCH_SIGNAL_SPEECH, 0, &speech) < 0 ||
+      bench_codec (BENCH_SIGNAL_SPEECH, 1, &speech_vad) < 0 ||
+      bench_codec (BENCH_SIGNAL_SILENCE_HEAVY, 1, &silence_vad) < 0) {
+    fprintf (stderr, "failed to allocate the codec\n");
+    return 1;
+  }
+
+  bench_framing_serial (prm, &serial_pack, &serial_unpack);
+  bench_framing_packed (prm, &packed_pack, &packed_unpack);
+
+  if (bench_interleaved (&single_ns, &interleaved_ns) < 0) {
+    fprintf (stderr, "failed to allocate encoders\n");
+    return 1;
+  }
+
+  if (bench_decoder (&postfilter_ns, &plain_ns) < 0) {
+    fprintf (stderr, "failed to allocate the codec\n");
+    return 1;
+  }
+
+  if (bench_complexity (complexity_ns, complexity_snr, &complexity_frames) < 0) {
+    fprintf (stderr, "failed to load the corpus\n");
+    return 1;
+  }
+
+  printf ("{\n");
+  /* what this build is made of, to tell runs apart */
+  printf ("  \"build\": {\n");
+#ifdef G729_SIMD_KERNELS
+  printf ("    \"simd_kernels\": true,\n");
+#else
+  printf ("    \"simd_kernels\": false,\n");
+#endif
+  printf ("    \"dsp\": \"%s\"\n",
+      getenv ("G729_DSP") ? getenv ("G729_DSP") : "auto");
+  printf ("  },\n");
+  printf ("  \"codec\": {\n");
+  bench_print_codec ("speech", &speech, 0);
+  bench_print_codec ("speech_vad", &speech_vad, 0);
+  bench_print_codec ("silence_heavy_vad", &silence_vad, 1);
+  printf ("  },\n");
+  printf ("  \"framing\": {\n");
+  printf ("    \"serial_pack_ns_per_frame\": %.1f,\n", serial_pack);
+  printf ("    \"serial_unpack_ns_per_frame\": %.1f,\n", serial_unpack);
+  printf ("    \"packed_pack_ns_per_frame\": %.1f,\n", packed_pack);
+  printf ("    \"packed_unpack_ns_per_frame\": %.1f\n", packed_unpack);
+  printf ("  },\n");
+  /* a core keeps up with real time as long as a frame takes less
+   * than its 10 ms duration */
+  printf ("  \"multichannel\": {\n");
+  printf ("    \"channels\": %d,\n", BENCH_CHANNELS);
+  printf ("    \"single_ns_per_frame\": %.1f,\n", single_ns);
+  printf ("    \"interleaved_ns_per_frame\": %.1f,\n", interleaved_ns);
+  printf ("    \"single_channels_per_core\": %.0f,\n", 1e7 / single_ns);
+  printf ("    \"interleaved_channels_per_core\": %.0f\n",
+      1e7 / interleaved_ns);
+  printf ("  },\n");
+
+  /* decoding cost with and without the post-filter */
+  printf ("  \"decoder\": {\n");
+  printf ("    \"postfilter_ns_per_frame\": %.1f,\n", postfilter_ns);
+  printf ("    \"no_postfilter_ns_per_frame\": %.1f,\n", plain_ns);
+  printf ("    \"postfilter_saving_ns_per_frame\": %.1f\n",
+      postfilter_ns - plain_ns);
+  printf ("  },\n");
+
+  /* quality against encoding cost of the complexity levels */
+  printf ("  \"complexity\": {\n");
+  printf ("    \"corpus\": \"%s\",\n",
+      getenv ("G729_BENCH_CORPUS") ? "file" : "synthetic");
+  printf ("    \"frames\": %d,\n", complexity_frames);
+  printf ("    \"levels\": [\n");
+  for (level = G729_COMPLEXITY_MIN; level <= G729_COMPLEXITY_MAX; level++) {
+    printf ("      { \"complexity\": %d, \"encode_ns_per_frame\": %.1f, "
+        "\"segsnr_db\": %.2f }%s\n", level, complexity_ns[level],
+        complexity_snr[level], level < G729_COMPLEXITY_MAX ? "," : "");
+  }
+  printf ("    ]\n");
+  printf ("  }\n");
+  printf ("}\n");
+
+  return 0;
+}
@@ -0,0 +1,194 @@
+/* GladSToNe g729 benchmark helpers
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+#include "g729benchutil.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+
+double
+bench_now (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Deterministic noise in [-range/2, range/2), from the sample position */
+static int
+bench_noise (int channel, long t, int range)
+{
+  uint32_t x = (uint32_t) t * 2654435761u + (uint32_t) channel * 40503u;
+
+  x ^= x >> 15;
+  x *= 2246822519u;
+  x ^= x >> 13;
+
+  return (int) (x % range) - range / 2;
+}
+
+static int
+bench_speech_sample (int channel, long t)
+{
+  return ((t * (37 + channel)) % 400 - 200) * 20 +
+      ((t * (113 + 3 * channel)) % 160 - 80) * 30 +
+      bench_noise (channel, t, 1000);
+}
+
+void
+bench_signal (BenchSignal kind, int channel, long start, int n_samples,
+    int16_t * pcm, int stride)
+{
+  long t, phase;
+  int i;
+
+  for (i = 0; i < n_samples; i++) {
+    t = start + i;
+
+    switch (kind) {
+      case BENCH_SIGNAL_SPEECH:
+        pcm[i * stride] = bench_speech_sample (channel, t);
+        break;
+      case BENCH_SIGNAL_SILENCE_HEAVY:
+        /* 8000 samples of speech out of every 32000, shifted per
+         * channel so that talkers overlap */
+        phase = (t + channel * 5000) % 32000;
+        if (phase < 8000)
+          pcm[i * stride] = bench_speech_sample (channel, t);
+        else
+          pcm[i * stride] = bench_noise (channel, t, 16);
+        break;
+    }
+  }
+}
+
+/*
+ * Allocation counting, by interposing the glibc allocator: the program's
+ * definitions take precedence over the C library ones for every shared
+ * object, GStreamer and GLib included.
+ */
+#ifdef __GLIBC__
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void *__libc_memalign (size_t alignment, size_t size);
+
+static int counting;
+static long allocs;
+
+static inline void
+bench_allocs_count (void)
+{
+  if (__atomic_load_n (&counting, __ATOMIC_RELAXED))
+    __atomic_fetch_add (&allocs, 1, __ATOMIC_RELAXED);
+}
+
+void *
+malloc (size_t size)
+{
+  bench_allocs_count ();
+  return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+  bench_allocs_count ();
+  return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+  bench_allocs_count ();
+  return __libc_realloc (ptr, size);
+}
+
+void *
+memalign (size_t alignment, size_t size)
+{
+  bench_allocs_count ();
+  return __libc_memalign (alignment, size);
+}
+
+int
+posix_memalign (void **ptr, size_t alignment, size_t size)
+{
+  bench_allocs_count ();
+  *ptr = __libc_memalign (alignment, size);
+  return *ptr ? 0 : ENOMEM;
+}
+
+void
+bench_allocs_start (void)
+{
+  __atomic_store_n (&allocs, 0, __ATOMIC_RELAXED);
+  __atomic_store_n (&counting, 1, __ATOMIC_SEQ_CST);
+}
+
+long
+bench_allocs_stop (void)
+{
+  __atomic_store_n (&counting, 0, __ATOMIC_SEQ_CST);
+  return __atomic_load_n (&allocs, __ATOMIC_RELAXED);
+}
+
+#else
+
+void
+bench_allocs_start (void)
+{
+}
+
+long
+bench_allocs_stop (void)
+{
+  return -1;
+}
+
+#endif
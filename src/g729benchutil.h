@@ -0,0 +1,70 @@
+/* GladSToNe g729 benchmark helpers
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+#ifndef __G729_BENCH_UTIL_H__
+#define __G729_BENCH_UTIL_H__
+
+#include <stdint.h>
+
+/* Monotonic time in ns */
+double bench_now (void);
+
+typedef enum {
+  BENCH_SIGNAL_SPEECH,          /* drifting harmonics plus noise */
+  BENCH_SIGNAL_SILENCE_HEAVY    /* 1 s talk spurts every 4 s, quiet noise */
+} BenchSignal;
+
+/* Writes n_samples of the signal of channel, starting at sample position
+ * start, to pcm[i * stride]. The signals only depend on their arguments,
+ * so every run and every program gets the same corpus. */
+void bench_signal (BenchSignal kind, int channel, long start, int n_samples,
+    int16_t *pcm, int stride);
+
+/* Counting of the malloc family calls made by the whole process between
+ * bench_allocs_start() and bench_allocs_stop(). bench_allocs_stop()
+ * returns -1 where the C library can't be interposed. */
+void bench_allocs_start (void);
+long bench_allocs_stop (void);
+
+#endif /* __G729_BENCH_UTIL_H__ */
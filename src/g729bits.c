@@ -0,0 +1,147 @@
+/* GladSToNe g729 bitstream packing
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "g729bits.h"
+#include "g729common.h"
+
+/* Field widths in transmission order, MSB first, as bitsno/bitsno2 in the
+ * reference code's bits.c */
+static const uint8_t speech_bits[G729_BITS_SPEECH_PARAMS] = {
+  8, 10, 8, 1, 13, 4, 7, 5, 13, 4, 7
+};
+
+static const uint8_t sid_bits[G729_BITS_SID_PARAMS] = {
+  1, 5, 4, 5
+};
+
+/* The accumulator never holds more than 7 pending bits plus one field, so
+ * 32 bits are plenty */
+static inline void
+g729_bits_pack_fields (const int16_t * prm, const uint8_t * widths, int n,
+    uint8_t * out)
+{
+  uint32_t acc = 0;
+  int fill = 0;
+  int i;
+
+  for (i = 0; i < n; i++) {
+    acc = (acc << widths[i]) | ((uint16_t) prm[i] & ((1u << widths[i]) - 1));
+    fill += widths[i];
+
+    while (fill >= 8) {
+      fill -= 8;
+      *out++ = acc >> fill;
+    }
+  }
+
+  if (fill)
+    *out = acc << (8 - fill);
+}
+
+static inline void
+g729_bits_unpack_fields (const uint8_t * in, const uint8_t * widths, int n,
+    int16_t * prm)
+{
+  uint32_t acc = 0;
+  int fill = 0;
+  int i;
+
+  for (i = 0; i < n; i++) {
+    while (fill < widths[i]) {
+      acc = (acc << 8) | *in++;
+      fill += 8;
+    }
+
+    fill -= widths[i];
+    prm[i] = (acc >> fill) & ((1u << widths[i]) - 1);
+  }
+}
+
+int
+g729_bits_pack (const int16_t * prm, uint8_t * out)
+{
+  switch (prm[0]) {
+    case G729_SPEECH_FRAME:
+      g729_bits_pack_fields (&prm[1], speech_bits, G729_BITS_SPEECH_PARAMS,
+          out);
+      return G729_FRAME_BYTES;
+    case G729_SID_FRAME:
+      g729_bits_pack_fields (&prm[1], sid_bits, G729_BITS_SID_PARAMS, out);
+      return G729_SID_BYTES;
+    default:
+      return G729_SILENCE_BYTES;
+  }
+}
+
+int
+g729_bits_unpack (const uint8_t * in, unsigned int size, int16_t * prm)
+{
+  switch (size) {
+    case G729_FRAME_BYTES:
+      prm[0] = G729_SPEECH_FRAME;
+      g729_bits_unpack_fields (in, speech_bits, G729_BITS_SPEECH_PARAMS,
+          &prm[1]);
+      return 0;
+    case G729_SID_BYTES:
+      prm[0] = G729_SID_FRAME;
+      g729_bits_unpack_fields (in, sid_bits, G729_BITS_SID_PARAMS, &prm[1]);
+      return 0;
+    case G729_SILENCE_BYTES:
+      prm[0] = G729_SILENCE_FRAME;
+      return 0;
+    default:
+      return -1;
+  }
+}
+
+int
+g729_bits_parity_ok (int pitch_index, int parity)
+{
+  int sum = 1 + parity;
+  int i;
+
+  for (i = 2; i < 8; i++)
+    sum += (pitch_index >> i) & 1;
+
+  return (sum & 1) == 0;
+}
@@ -0,0 +1,73 @@
+/* GladSToNe g729 bitstream packing
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef __G729_BITS_H__
+#define __G729_BITS_H__
+
+#include <stdint.h>
+
+/* Number of analysis parameters of a speech frame, as in the reference
+ * code's PRM_SIZE */
+#define G729_BITS_SPEECH_PARAMS 11
+#define G729_BITS_SID_PARAMS 4
+
+/*
+ * Conversion between reference code analysis parameters and the RFC 3551
+ * packed payload, without going through the ITU serial format.
+ *
+ * prm[0] is the frame type (frame_modes_param) and prm[1..] are the
+ * parameters in bits2prm_ld8k()/prm2bits_ld8k() order.
+ */
+
+/* Packs prm into out (room for 10 bytes), returns the frame size */
+int g729_bits_pack (const int16_t *prm, uint8_t *out);
+
+/* Unpacks a frame of size bytes into prm (room for 1 + 11 words), returns
+ * -1 if size isn't a valid frame size */
+int g729_bits_unpack (const uint8_t *in, unsigned int size, int16_t *prm);
+
+/* Whether the parity bit of a speech frame matches the 6 most significant
+ * bits of the first pitch delay index, as Check_Parity_Pitch() */
+int g729_bits_parity_ok (int pitch_index, int parity);
+
+#endif /* __G729_BITS_H__ */
@@ -0,0 +1,763 @@
+/* GladSToNe g729 comfort noise
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+/*
+ * Annex B discontinuous transmission: SID frame coding (dtx.c), decoding
+ * (dec_sid.c) and the comfort noise excitation (calcexc.c), operating on
+ * the codec states instead of file scope variables.
+ */
+
+#include "g729state.h"
+
+#include <stddef.h>
+
+/* ref code includes: */
+#include "basic_op.h"
+#include "oper_32b.h"
+#include "tab_ld8a.h"
+#include "sid.h"
+#include "tab_dtx.h"
+
+/* calcexc.c */
+#define FRAC1 19043
+#define K0 24576
+#define G_MAX 5000
+
+void
+g729_cng_init (G729CngEncState * state)
+{
+  Word16 i;
+
+  for(i=0; i<SIZ_SUMACF; i++) state->sumAcf[i] = 0;
+  for(i=0; i<NB_SUMACF; i++) state->sh_sumAcf[i] = 40;
+
+  for(i=0; i<SIZ_ACF; i++) state->Acf[i] = 0;
+  for(i=0; i<NB_CURACF; i++) state->sh_Acf[i] = 40;
+
+  for(i=0; i<NB_GAIN; i++) state->sh_ener[i] = 40;
+  for(i=0; i<NB_GAIN; i++) state->ener[i] = 0;
+
+  state->cur_gain = 0;
+  state->fr_cur = 0;
+  state->flag_chang = 0;
+}
+
+/* Sum of nb autocorrelations with different scalings */
+static void
+g729_cng_sum_acf (
+  Word16 *acf,
+  Word16 *sh_acf,
+  Word16 *sum,
+  Word16 *sh_sum,
+  Word16 nb
+)
+{
+  Word16 *ptr1;
+  Word32 L_temp, L_tab[MP1];
+  Word16 sh0, temp;
+  Word16 i, j;
+
+  /* Compute sum = sum of nb acfs */
+  /* Search sh_acf_min */
+  sh0 = sh_acf[0];
+  for(i=1; i<nb; i++) {
+    if(sub(sh_acf[i], sh0) < 0) sh0 = sh_acf[i];
+  }
+  sh0 = add(sh0, 14);           /* 2 bits of margin */
+
+  for(j=0; j<MP1; j++) {
+    L_tab[j] = 0L;
+  }
+  ptr1 = acf;
+  for(i=0; i<nb; i++) {
+    temp = sub(sh0, sh_acf[i]);
+    for(j=0; j<MP1; j++) {
+      L_temp = L_deposit_l(*ptr1++);
+      L_temp = L_shl(L_temp, temp); /* shift right if temp<0 */
+      L_tab[j] = L_add(L_tab[j], L_temp);
+    }
+  }
+  temp = norm_l(L_tab[0]);
+  for(i=0; i<=M; i++) {
+    sum[i] = extract_h(L_shl(L_tab[i], temp));
+  }
+  temp = sub(temp, 16);
+  *sh_sum = add(sh0, temp);
+}
+
+static void
+g729_cng_update_sum_acf (G729CngEncState * state)
+{
+  Word16 *ptr1, *ptr2;
+  Word16 i;
+
+  /*** Move sumAcf ***/
+  ptr1 = state->sumAcf + SIZ_SUMACF - 1;
+  ptr2 = ptr1 - MP1;
+  for(i=0; i<(SIZ_SUMACF-MP1); i++) {
+    *ptr1-- = *ptr2--;
+  }
+  for(i=NB_SUMACF-1; i>=1; i--) {
+    state->sh_sumAcf[i] = state->sh_sumAcf[i-1];
+  }
+
+  /* Compute new sumAcf */
+  g729_cng_sum_acf(state->Acf, state->sh_Acf, state->sumAcf,
+      state->sh_sumAcf, NB_CURACF);
+}
+
+void
+g729_cng_update (
+  G729CngEncState *state,
+  Word16 *r_h,      /* (i) :   MSB of frame autocorrelation        */
+  Word16 exp_r,     /* (i) :   scaling factor associated           */
+  Word16 Vad        /* (i) :   current Vad decision                */
+)
+{
+  Word16 i;
+  Word16 *ptr1, *ptr2;
+
+  /* Update Acf and shAcf */
+  ptr1 = state->Acf + SIZ_ACF - 1;
+  ptr2 = ptr1 - MP1;
+  for(i=0; i<(SIZ_ACF-MP1); i++) {
+    *ptr1-- = *ptr2--;
+  }
+  for(i=NB_CURACF-1; i>=1; i--) {
+    state->sh_Acf[i] = state->sh_Acf[i-1];
+  }
+
+  /* Save current Acf */
+  state->sh_Acf[0] = negate(add(16, exp_r));
+  for(i=0; i<MP1; i++) {
+    state->Acf[i] = r_h[i];
+  }
+
+  state->fr_cur = add(state->fr_cur, 1);
+  if(sub(state->fr_cur, NB_CURACF) == 0) {
+    state->fr_cur = 0;
+    if(Vad != 0) {
+      g729_cng_update_sum_acf(state);
+    }
+  }
+}
+
+/* Past average filter */
+static void
+g729_cng_past_filt (G729EncState * enc, Word16 * Coeff)
+{
+  G729CngEncState *state = &enc->cng;
+  Word16 i;
+  Word16 s_sumAcf[MP1];
+  Word16 bid[M], zero[MP1];
+  Word16 temp;
+
+  g729_cng_sum_acf(state->sumAcf, state->sh_sumAcf, s_sumAcf, &temp,
+      NB_SUMACF);
+
+  if(s_sumAcf[0] == 0L) {
+    Coeff[0] = 4096;
+    for(i=1; i<=M; i++) Coeff[i] = 0;
+    return;
+  }
+
+  Set_zero(zero, MP1);
+  g729_levinson(enc->old_A, enc->old_rc, s_sumAcf, zero, Coeff, bid, &temp);
+}
+
+/* Autocorrelation of the filter coefficients */
+static void
+g729_cng_rcoeff (Word16 * Coeff, Word16 * RCoeff, Word16 * sh_RCoeff)
+{
+  Word16 i, j;
+  Word16 sh1;
+  Word32 L_acc;
+
+  /* RCoeff[0] = SUM(j=0->M) Coeff[j] ** 2 */
+  L_acc = 0L;
+  for(j=0; j <= M; j++) {
+    L_acc = L_mac(L_acc, Coeff[j], Coeff[j]);
+  }
+
+  /* Compute exponent RCoeff */
+  sh1 = norm_l(L_acc);
+  L_acc = L_shl(L_acc, sh1);
+  RCoeff[0] = round(L_acc);
+
+  /* RCoeff[i] = SUM(j=0->M-i) Coeff[j] * Coeff[j+i] */
+  for(i=1; i<=M; i++) {
+    L_acc = 0L;
+    for(j=0; j<=M-i; j++) {
+      L_acc = L_mac(L_acc, Coeff[j], Coeff[j+i]);
+    }
+    L_acc = L_shl(L_acc, sh1);
+    RCoeff[i] = round(L_acc);
+  }
+  *sh_RCoeff = sh1;
+}
+
+/* Itakura distance between the reference filter and the current frame
+ * compared to a threshold, 1 if above */
+static Word16
+g729_cng_cmp_filt (Word16 * RCoeff, Word16 sh_RCoeff, Word16 * acf,
+    Word16 alpha, Word16 FracThresh)
+{
+  Word32 L_temp0, L_temp1;
+  Word16 temp1, temp2, sh[2], ind;
+  Word16 i;
+  Word16 diff, flag;
+
+  sh[0] = 0;
+  sh[1] = 0;
+  ind = 1;
+  flag = 0;
+  do {
+    Overflow = 0;
+    temp1 = shr(RCoeff[0], sh[0]);
+    temp2 = shr(acf[0], sh[1]);
+    L_temp0 = L_shr(L_mult(temp1, temp2),1);
+    for(i=1; i <= M; i++) {
+      temp1 = shr(RCoeff[i], sh[0]);
+      temp2 = shr(acf[i], sh[1]);
+      L_temp0 = L_mac(L_temp0, temp1, temp2);
+    }
+    if(Overflow != 0) {
+      sh[(int)ind] = add(sh[(int)ind], 1);
+      ind = sub(1, ind);
+    }
+    else flag = 1;
+  } while (flag == 0);
+
+
+  temp1 = mult_r(alpha, FracThresh);
+  L_temp1 = L_add(L_deposit_l(temp1), L_deposit_l(alpha));
+  temp1 = add(sh_RCoeff, 9);  /* 9 = Lpc_justif. * 2 - 16 + 1 */
+  temp2 = add(sh[0], sh[1]);
+  temp1 = sub(temp1, temp2);
+  L_temp1 = L_shl(L_temp1, temp1);
+
+  L_temp0 = L_sub(L_temp0, L_temp1);
+  if(L_temp0 > 0L) diff = 1;
+  else diff = 0;
+
+  return(diff);
+}
+
+/* dtx.c: Cod_cng() */
+void
+g729_cng_encode (
+  G729EncState *enc,
+  Word16 *exc,          /* (i/o) : excitation array                     */
+  Word16 pastVad,       /* (i)   : previous VAD decision                */
+  Word16 *Aq,           /* (o)   : set of interpolated LPC coefficients */
+  Word16 *ana           /* (o)   : coded SID parameters                 */
+)
+{
+  G729CngEncState *state = &enc->cng;
+  Word16 i;
+
+  Word16 curAcf[MP1];
+  Word16 bid[M], zero[MP1];
+  Word16 curCoeff[MP1];
+  Word16 lsp_new[M];
+  Word16 *lpcCoeff;
+  Word16 cur_igain;
+  Word16 energyq, temp;
+
+  /* Update Ener and sh_ener */
+  for(i = NB_GAIN-1; i>=1; i--) {
+    state->ener[i] = state->ener[i-1];
+    state->sh_ener[i] = state->sh_ener[i-1];
+  }
+
+  /* Compute current Acfs */
+  g729_cng_sum_acf(state->Acf, state->sh_Acf, curAcf, &state->sh_ener[0],
+      NB_CURACF);
+
+  /* Compute LPC coefficients and residual energy */
+  if(curAcf[0] == 0) {
+    state->ener[0] = 0;                /* should not happen */
+  }
+  else {
+    Set_zero(zero, MP1);
+    g729_levinson(enc->old_A, enc->old_rc, curAcf, zero, curCoeff, bid,
+        &state->ener[0]);
+  }
+
+  /* if first frame of silence => SID frame */
+  if(pastVad != 0) {
+    ana[0] = 2;
+    state->count_fr0 = 0;
+    state->nb_ener = 1;
+    Qua_Sidgain(state->ener, state->sh_ener, state->nb_ener, &energyq,
+        &cur_igain);
+
+  }
+  else {
+    state->nb_ener = add(state->nb_ener, 1);
+    if(sub(state->nb_ener, NB_GAIN) > 0) state->nb_ener = NB_GAIN;
+    Qua_Sidgain(state->ener, state->sh_ener, state->nb_ener, &energyq,
+        &cur_igain);
+
+    /* Compute stationarity of current filter   */
+    /* versus reference filter                  */
+    if(g729_cng_cmp_filt(state->RCoeff, state->sh_RCoeff, curAcf,
+        state->ener[0], FRAC_THRESH1) != 0) {
+      state->flag_chang = 1;
+    }
+
+    /* compare energy difference between current frame and last frame */
+    temp = abs_s(sub(state->prev_energy, energyq));
+    temp = sub(temp, 2);
+    if (temp > 0) state->flag_chang = 1;
+
+    state->count_fr0 = add(state->count_fr0, 1);
+    if(sub(state->count_fr0, FR_SID_MIN) < 0) {
+      ana[0] = 0;               /* no transmission */
+    }
+    else {
+      if(state->flag_chang != 0) {
+        ana[0] = 2;             /* transmit SID frame */
+      }
+      else{
+        ana[0] = 0;
+      }
+
+      state->count_fr0 = FR_SID_MIN;   /* to avoid overflow */
+    }
+  }
+
+
+  if(sub(ana[0], 2) == 0) {
+
+    /* Reset frame count and change flag */
+    state->count_fr0 = 0;
+    state->flag_chang = 0;
+
+    /* Compute past average filter */
+    g729_cng_past_filt(enc, state->pastCoeff);
+    g729_cng_rcoeff(state->pastCoeff, state->RCoeff, &state->sh_RCoeff);
+
+    /* Compute stationarity of current filter   */
+    /* versus past average filter               */
+
+
+    /* if stationary */
+    /* transmit average filter => new ref. filter */
+    if(g729_cng_cmp_filt(state->RCoeff, state->sh_RCoeff, curAcf,
+        state->ener[0], FRAC_THRESH2) == 0) {
+      lpcCoeff = state->pastCoeff;
+    }
+
+    /* else */
+    /* transmit current filter => new ref. filter */
+    else {
+      lpcCoeff = curCoeff;
+      g729_cng_rcoeff(curCoeff, state->RCoeff, &state->sh_RCoeff);
+    }
+
+    /* Compute SID frame codes */
+
+    Az_lsp(lpcCoeff, lsp_new, enc->lsp_old_q); /* From A(z) to lsp */
+
+    /* LSP quantization */
+    lsfq_noise(lsp_new, state->lspSid_q, enc->freq_prev, &ana[1]);
+
+    state->prev_energy = energyq;
+    ana[4] = cur_igain;
+    state->sid_gain = tab_Sidgain[cur_igain];
+
+
+  } /* end of SID frame case */
+
+  /* Compute new excitation */
+  if(pastVad != 0) {
+    state->cur_gain = state->sid_gain;
+  }
+  else {
+    state->cur_gain = mult_r(state->cur_gain, A_GAIN0);
+    state->cur_gain = add(state->cur_gain, mult_r(state->sid_gain, A_GAIN1));
+  }
+
+  g729_cng_excitation(state->cur_gain, exc, &enc->seed, enc->L_exc_err);
+
+  Int_qlpc(enc->lsp_old_q, state->lspSid_q, Aq);
+  for(i=0; i<M; i++) {
+    enc->lsp_old_q[i]   = state->lspSid_q[i];
+  }
+
+  /* Update sumAcf if fr_cur = 0 */
+  if(state->fr_cur == 0) {
+    g729_cng_update_sum_acf(state);
+  }
+}
+
+/* dec_sid.c: Dec_cng() */
+void
+g729_cng_decode (
+  G729DecState *state,
+  Word16 past_ftyp,     /* (i)   : past frame type                      */
+  Word16 sid_sav,       /* (i)   : energy to recover SID gain           */
+  Word16 sh_sid_sav,    /* (i)   : corresponding scaling factor         */
+  Word16 *parm,         /* (i)   : coded SID parameters                 */
+  Word16 *exc,          /* (i/o) : excitation array                     */
+  Word16 *A_t           /* (o)   : set of interpolated LPC coefficients */
+)
+{
+  Word16 temp, ind;
+  Word16 dif;
+
+  dif = sub(past_ftyp, 1);
+
+  /* SID Frame */
+  /*************/
+  if(parm[0] != 0) {
+
+    state->sid_gain = tab_Sidgain[(int)parm[4]];
+
+    /* Inverse quantization of the LSP */
+    sid_lsfq_decode(&parm[1], state->lspSid, state->freq_prev);
+
+  }
+
+  /* non SID Frame */
+  /*****************/
+  else {
+
+    /* Case of 1st SID frame erased : quantize-decode   */
+    /* energy estimate stored in sid_gain         */
+    if(dif == 0) {
+      Qua_Sidgain(&sid_sav, &sh_sid_sav, 0, &temp, &ind);
+      state->sid_gain = tab_Sidgain[(int)ind];
+    }
+
+  }
+
+  if(dif == 0) {
+    state->cur_gain = state->sid_gain;
+  }
+  else {
+    state->cur_gain = mult_r(state->cur_gain, A_GAIN0);
+    state->cur_gain = add(state->cur_gain, mult_r(state->sid_gain, A_GAIN1));
+  }
+
+  g729_cng_excitation(state->cur_gain, exc, &state->seed, NULL);
+
+  /* Interpolate the Lsp vectors */
+  Int_qlpc(state->lsp_old, state->lspSid, A_t);
+  Copy(state->lspSid, state->lsp_old, M);
+}
+
+/* calcexc.c: gaussian generator */
+static Word16
+g729_cng_gauss (Word16 * seed)
+{
+  /* Generate 12 random numbers, sum them, normalize */
+  Word16 i;
+  Word16 temp;
+  Word32 L_acc;
+
+  L_acc = 0L;
+  for(i=0; i<12; i++) {
+    L_acc = L_add(L_acc, L_deposit_l(Random(seed)));
+  }
+  L_acc = L_shr(L_acc, 7);
+  temp = extract_l(L_acc);
+  return(temp);
+}
+
+/* calcexc.c: square root of Num, for Num in [0, 2^31) */
+static Word16
+g729_cng_sqrt (Word32 Num)
+{
+  Word16 i  ;
+
+  Word16 Rez = (Word16) 0 ;
+  Word16 Exp = (Word16) 0x4000 ;
+
+  Word32 Acc, L_temp;
+
+  for ( i = 0 ; i < 14 ; i ++ ) {
+    Acc = L_mult(add(Rez, Exp), add(Rez, Exp) );
+    L_temp = L_sub(Num, Acc);
+    if(L_temp >= 0L) Rez = add( Rez, Exp);
+    Exp = shr( Exp, (Word16) 1 ) ;
+  }
+  return Rez ;
+}
+
+/* calcexc.c: Calc_exc_rand() */
+void
+g729_cng_excitation (
+  Word16 cur_gain,      /* (i)   :   target sample gain                 */
+  Word16 *exc,          /* (i/o) :   excitation array                   */
+  Word16 *seed,         /* (i)   :   current Vad decision               */
+  Word32 *L_exc_err     /* (i/o) :   encoder taming state, or NULL      */
+)
+{
+  Word16 i, j, i_subfr;
+  Word16 temp1, temp2;
+  Word16 pos[4];
+  Word16 sign[4];
+  Word16 t0, frac;
+  Word16 *cur_exc;
+  Word16 g, Gp, Gp2;
+  Word16 excg[L_SUBFR], excs[L_SUBFR];
+  Word32 L_acc, L_ener, L_k;
+  Word16 max, hi, lo, inter_exc;
+  Word16 sh;
+  Word16 x1, x2;
+
+  if(cur_gain == 0) {
+
+    for(i=0; i<L_FRAME; i++) {
+      exc[i] = 0;
+    }
+    Gp = 0;
+    t0 = add(L_SUBFR,1);
+    for (i_subfr = 0;  i_subfr < L_FRAME; i_subfr += L_SUBFR) {
+      if (L_exc_err) g729_taming_update(L_exc_err, Gp, t0);
+    }
+
+    return;
+  }
+
+
+
+  cur_exc = exc;
+
+  for (i_subfr = 0;  i_subfr < L_FRAME; i_subfr += L_SUBFR) {
+
+    /* generate random adaptive codebook & fixed codebook parameters */
+    /*****************************************************************/
+    temp1 = Random(seed);
+    frac = sub((temp1 & (Word16)0x0003), 1);
+    if(sub(frac, 2) == 0) frac = 0;
+    temp1 = shr(temp1, 2);
+    t0 = add((temp1 & (Word16)0x003F), 40);
+    temp1 = shr(temp1, 6);
+    temp2 = temp1 & (Word16)0x0007;
+    pos[0] = add(shl(temp2, 2), temp2); /* 5 * temp2 */
+    temp1 = shr(temp1, 3);
+    sign[0] = temp1 & (Word16)0x0001;
+    temp1 = shr(temp1, 1);
+    temp2 = temp1 & (Word16)0x0007;
+    temp2 = add(shl(temp2, 2), temp2);
+    pos[1] = add(temp2, 1);     /* 5 * x + 1 */
+    temp1 = shr(temp1, 3);
+    sign[1] = temp1 & (Word16)0x0001;
+    temp1 = Random(seed);
+    temp2 = temp1 & (Word16)0x0007;
+    temp2 = add(shl(temp2, 2), temp2);
+    pos[2] = add(temp2, 2);     /* 5 * x + 2 */
+    temp1 = shr(temp1, 3);
+    sign[2] = temp1 & (Word16)0x0001;
+    temp1 = shr(temp1, 1);
+    temp2 = temp1 & (Word16)0x000F;
+    pos[3] = add((temp2 & (Word16)1), 3); /* j+3*/
+    temp2 = (shr(temp2, 1)) & (Word16)7;
+    temp2 = add(shl(temp2, 2), temp2); /* 5i */
+    pos[3] = add(pos[3], temp2);
+    temp1 = shr(temp1, 4);
+    sign[3] = temp1 & (Word16)0x0001;
+    Gp = Random(seed) & (Word16)0x1FFF; /* < 0.5 Q14 */
+    Gp2 = shl(Gp, 1);           /* Q15 */
+
+
+    /* Generate gaussian excitation */
+    /********************************/
+    L_acc = 0L;
+    for(i=0; i<L_SUBFR; i++) {
+      temp1 = g729_cng_gauss(seed);
+      L_acc = L_mac(L_acc, temp1, temp1);
+      excg[i] = temp1;
+    }
+
+/*
+    Compute fact = alpha x cur_gain * sqrt(L_SUBFR / Eg)
+    with Eg = SUM(i=0->39) excg[i]^2
+    and alpha = 0.5
+    alpha x sqrt(L_SUBFR)/2 = 1 + FRAC1
+*/
+    L_acc = Inv_sqrt(L_shr(L_acc,1));  /* Q30 */
+    L_Extract(L_acc, &hi, &lo);
+    /* cur_gain = cur_gainR << 3 */
+    temp1 = mult_r(cur_gain, FRAC1);
+    temp1 = add(cur_gain, temp1);
+    /* <=> alpha x cur_gainR x 2^2 x sqrt(L_SUBFR) */
+
+    L_acc = Mpy_32_16(hi, lo, temp1);   /* fact << 17 */
+    sh = norm_l(L_acc);
+    temp1 = extract_h(L_shl(L_acc, sh));  /* fact << (sh+1) */
+
+    sh = sub(sh, 14);
+    for(i=0; i<L_SUBFR; i++) {
+      temp2 = mult_r(excg[i], temp1);
+      temp2 = shr_r(temp2, sh);   /* shl if sh < 0 */
+      excg[i] = temp2;
+    }
+
+    /* generate random  adaptive excitation */
+    /****************************************/
+    Pred_lt_3(cur_exc, t0, frac, L_SUBFR);
+
+
+    /* compute adaptive + gaussian exc -> cur_exc */
+    /**********************************************/
+    max = 0;
+    for(i=0; i<L_SUBFR; i++) {
+      temp1 = mult_r(cur_exc[i], Gp2);
+      temp1 = add(temp1, excg[i]); /* may overflow => exc[i] = 0 */
+      cur_exc[i] = temp1;
+      temp1 = abs_s(temp1);
+      if(sub(temp1,max) > 0) max = temp1;
+    }
+
+    /* rescale cur_exc -> excs */
+    if(max == 0) sh = 0;
+    else {
+      sh = sub(3, norm_s(max));
+      if(sh <= 0) sh = 0;
+    }
+    for(i=0; i<L_SUBFR; i++) {
+      excs[i] = shr(cur_exc[i], sh);
+    }
+
+    /* Compute fixed code gain */
+    /***************************/
+
+    /**********************************************************/
+    /*** Solve EQ(X) = 4 X**2 + 2 b X + c                     */
+    /**********************************************************/
+
+    L_ener = 0L;
+    for(i=0; i<L_SUBFR; i++) {
+      L_ener = L_mac(L_ener, excs[i], excs[i]);
+    } /* ener x 2^(-2sh + 1) */
+
+    /* inter_exc = b >> sh */
+    inter_exc = 0;
+    for(i=0; i<4; i++) {
+      j = pos[i];
+      if(sign[i] == 0) {
+        inter_exc = sub(inter_exc, excs[j]);
+      }
+      else {
+        inter_exc = add(inter_exc, excs[j]);
+      }
+    }
+
+    /* Compute k = cur_gainR x cur_gainR x L_SUBFR */
+    L_acc = L_mult(cur_gain, L_SUBFR);
+    L_acc = L_shr(L_acc, 6);
+    temp1 = extract_l(L_acc);   /* cur_gainR x L_SUBFR x 2^(-2) */
+    L_k   = L_mult(cur_gain, temp1); /* k << 2 */
+    temp1 = add(1, shl(sh,1));
+    L_acc = L_shr(L_k, temp1);  /* k x 2^(-2sh+1) */
+
+    /* Compute delta = b^2 - 4 c */
+    L_acc = L_sub(L_acc, L_ener); /* - 4 c x 2^(-2sh-1) */
+    inter_exc = shr(inter_exc, 1);
+    L_acc = L_mac(L_acc, inter_exc, inter_exc); /* 2^(-2sh-1) */
+    sh = add(sh, 1);
+    /* inter_exc = b x 2^(-sh) */
+    /* L_acc = delta x 2^(-2sh+1) */
+
+    if(L_acc < 0L) {
+
+      /* adaptive excitation = 0 */
+      Copy(excg, cur_exc, L_SUBFR);
+      temp1 = abs_s(excg[(int)pos[0]]) | abs_s(excg[(int)pos[1]]);
+      temp2 = abs_s(excg[(int)pos[2]]) | abs_s(excg[(int)pos[3]]);
+      temp1 = temp1 | temp2;
+      sh = ((temp1 & (Word16)0x4000) == 0) ? (Word16)1 : (Word16)2;
+      inter_exc = 0;
+      for(i=0; i<4; i++) {
+        temp1 = shr(excg[(int)pos[i]], sh);
+        if(sign[i] == 0) {
+          inter_exc = sub(inter_exc, temp1);
+        }
+        else {
+          inter_exc = add(inter_exc, temp1);
+        }
+      } /* inter_exc = b >> sh */
+      L_Extract(L_k, &hi, &lo);
+      L_acc = Mpy_32_16(hi, lo, K0); /* k x (1- alpha^2) << 2 */
+      temp1 = sub(shl(sh, 1), 1); /* temp1 > 0 */
+      L_acc = L_shr(L_acc, temp1); /* 4k x (1 - alpha^2) << (-2sh+1) */
+      L_acc = L_mac(L_acc, inter_exc, inter_exc); /* delta << (-2sh+1) */
+      Gp = 0;
+    }
+
+    temp2 = g729_cng_sqrt(L_acc);        /* >> sh */
+    x1 = sub(temp2, inter_exc);
+    x2 = negate(add(inter_exc, temp2)); /* x 2^(-sh+2) */
+    if(sub(abs_s(x2),abs_s(x1)) < 0) x1 = x2;
+    temp1 = sub(2, sh);
+    g = shr_r(x1, temp1);       /* shl if temp1 < 0 */
+    if(g >= 0) {
+      if(sub(g, G_MAX) > 0) g = G_MAX;
+    }
+    else {
+      if(add(g, G_MAX) < 0) g = negate(G_MAX);
+    }
+
+    /* Update cur_exc with ACELP excitation */
+    for(i=0; i<4; i++) {
+      j = pos[i];
+      if(sign[i] != 0) {
+        cur_exc[j] = add(cur_exc[j], g);
+      }
+      else {
+        cur_exc[j] = sub(cur_exc[j], g);
+      }
+    }
+
+    if (L_exc_err) g729_taming_update(L_exc_err, Gp, t0);
+
+    cur_exc += L_SUBFR;
+
+
+  } /* end of loop on subframes */
+}
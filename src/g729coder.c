@@ -0,0 +1,1116 @@
+/* GladSToNe g729 encoder
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/*
+ * The stateful part of the reference encoder (pre_proc.c, cod_ld8a.c,
+ * the Levinson recursion of lpc.c, qua_lsp.c, qua_gain.c and taming.c),
+ * operating on a G729EncState instead of file scope variables. The code
+ * follows the reference line by line, so that the output stays bit-exact.
+ */
+
+#include "g729state.h"
+#include "g729search.h"
+#include "g729kernels.h"
+
+/* ref code includes: */
+#include "basic_op.h"
+#include "oper_32b.h"
+#include "tab_ld8a.h"
+
+/* pre_proc.c */
+void
+g729_pre_process (
+  G729HighPassState *state,
+  Word16 signal[],    /* input/output signal */
+  Word16 lg           /* length of signal    */
+)
+{
+  Word16 i, x2;
+  Word32 L_tmp;
+
+  for(i=0; i<lg; i++)
+  {
+     x2 = state->x1;
+     state->x1 = state->x0;
+     state->x0 = signal[i];
+
+     /*  y[i] = b[0]*x[i]/2 + b[1]*x[i-1]/2 + b140[2]*x[i-2]/2  */
+     /*                     + a[1]*y[i-1] + a[2] * y[i-2];      */
+
+     L_tmp     = Mpy_32_16(state->y1_hi, state->y1_lo, a140[1]);
+     L_tmp     = L_add(L_tmp, Mpy_32_16(state->y2_hi, state->y2_lo, a140[2]));
+     L_tmp     = L_mac(L_tmp, state->x0, b140[0]);
+     L_tmp     = L_mac(L_tmp, state->x1, b140[1]);
+     L_tmp     = L_mac(L_tmp, x2, b140[2]);
+     L_tmp     = L_shl(L_tmp, 3);      /* Q28 --> Q31 (Q12 --> Q15) */
+     signal[i] = round(L_tmp);
+
+     state->y2_hi = state->y1_hi;
+     state->y2_lo = state->y1_lo;
+     L_Extract(L_tmp, &state->y1_hi, &state->y1_lo);
+  }
+}
+
+/* lpc.c */
+void
+g729_levinson (
+  Word16 old_A[],   /* (i/o)   : last stable filter                      */
+  Word16 old_rc[],  /* (i/o)   : its first two reflection coefficients   */
+  Word16 Rh[],      /* (i)     : Rh[M+1] Vector of autocorrelations (msb) */
+  Word16 Rl[],      /* (i)     : Rl[M+1] Vector of autocorrelations (lsb) */
+  Word16 A[],       /* (o) Q12 : A[M]    LPC coefficients  (m = 10)       */
+  Word16 rc[],      /* (o) Q15 : rc[M]   Reflection coefficients.         */
+  Word16 *Err       /* (o)     : Residual energy                          */
+)
+{
+ Word16 i, j;
+ Word16 hi, lo;
+ Word16 Kh, Kl;                /* reflection coefficient; hi and lo           */
+ Word16 alp_h, alp_l, alp_exp; /* Prediction gain; hi lo and exponent         */
+ Word16 Ah[M+1], Al[M+1];      /* LPC coef. in double prec.                   */
+ Word16 Anh[M+1], Anl[M+1];    /* LPC coef.for next iteration in double prec. */
+ Word32 t0, t1, t2;            /* temporary variable                          */
+
+/* K = A[1] = -R[1] / R[0] */
+
+  t1  = L_Comp(Rh[1], Rl[1]);           /* R[1] in Q31      */
+  t2  = L_abs(t1);                      /* abs R[1]         */
+  t0  = Div_32(t2, Rh[0], Rl[0]);       /* R[1]/R[0] in Q31 */
+  if(t1 > 0) t0= L_negate(t0);          /* -R[1]/R[0]       */
+  L_Extract(t0, &Kh, &Kl);              /* K in DPF         */
+  rc[0] = Kh;
+  t0 = L_shr(t0,4);                     /* A[1] in Q27      */
+  L_Extract(t0, &Ah[1], &Al[1]);        /* A[1] in DPF      */
+
+/*  Alpha = R[0] * (1-K**2) */
+
+  t0 = Mpy_32(Kh ,Kl, Kh, Kl);          /* K*K      in Q31 */
+  t0 = L_abs(t0);                       /* Some case <0 !! */
+  t0 = L_sub( (Word32)0x7fffffffL, t0 ); /* 1 - K*K  in Q31 */
+  L_Extract(t0, &hi, &lo);              /* DPF format      */
+  t0 = Mpy_32(Rh[0] ,Rl[0], hi, lo);    /* Alpha in Q31    */
+
+/* Normalize Alpha */
+
+  alp_exp = norm_l(t0);
+  t0 = L_shl(t0, alp_exp);
+  L_Extract(t0, &alp_h, &alp_l);         /* DPF format    */
+
+/*--------------------------------------*
+ * ITERATIONS  I=2 to M                 *
+ *--------------------------------------*/
+
+  for(i= 2; i<=M; i++)
+  {
+
+    /* t0 = SUM ( R[j]*A[i-j] ,j=1,i-1 ) +  R[i] */
+
+    t0 = 0;
+    for(j=1; j<i; j++)
+      t0 = L_add(t0, Mpy_32(Rh[j], Rl[j], Ah[i-j], Al[i-j]));
+
+    t0 = L_shl(t0,4);                  /* result in Q27 -> convert to Q31 */
+                                       /* No overflow possible            */
+    t1 = L_Comp(Rh[i],Rl[i]);
+    t0 = L_add(t0, t1);                /* add R[i] in Q31                 */
+
+    /* K = -t0 / Alpha */
+
+    t1 = L_abs(t0);
+    t2 = Div_32(t1, alp_h, alp_l);     /* abs(t0)/Alpha                   */
+    if(t0 > 0) t2= L_negate(t2);       /* K =-t0/Alpha                    */
+    t2 = L_shl(t2, alp_exp);           /* denormalize; compare to Alpha   */
+    L_Extract(t2, &Kh, &Kl);           /* K in DPF                        */
+    rc[i-1] = Kh;
+
+    /* Test for unstable filter. If unstable keep old A(z) */
+
+    if (sub(abs_s(Kh), 32750) > 0)
+    {
+      for(j=0; j<=M; j++)
+      {
+        A[j] = old_A[j];
+      }
+      rc[0] = old_rc[0];        /* only two rc coefficients are needed */
+      rc[1] = old_rc[1];
+      return;
+    }
+
+    /*------------------------------------------*
+     *  Compute new LPC coeff. -> An[i]         *
+     *  An[j]= A[j] + K*A[i-j]     , j=1 to i-1 *
+     *  An[i]= K                                *
+     *------------------------------------------*/
+
+    for(j=1; j<i; j++)
+    {
+      t0 = Mpy_32(Kh, Kl, Ah[i-j], Al[i-j]);
+      t0 = L_add(t0, L_Comp(Ah[j], Al[j]));
+      L_Extract(t0, &Anh[j], &Anl[j]);
+    }
+    t2 = L_shr(t2, 4);                  /* t2 = K in Q31 ->convert to Q27  */
+    L_Extract(t2, &Anh[i], &Anl[i]);    /* An[i] in Q27                    */
+
+    /*  Alpha = Alpha * (1-K**2) */
+
+    t0 = Mpy_32(Kh ,Kl, Kh, Kl);          /* K*K      in Q31 */
+    t0 = L_abs(t0);                       /* Some case <0 !! */
+    t0 = L_sub( (Word32)0x7fffffffL, t0 ); /* 1 - K*K  in Q31 */
+    L_Extract(t0, &hi, &lo);              /* DPF format      */
+    t0 = Mpy_32(alp_h , alp_l, hi, lo);   /* Alpha in Q31    */
+
+    /* Normalize Alpha */
+
+    j = norm_l(t0);
+    t0 = L_shl(t0, j);
+    L_Extract(t0, &alp_h, &alp_l);         /* DPF format    */
+    alp_exp = add(alp_exp, j);             /* Add normalization to alp_exp */
+
+    /* A[j] = An[j] */
+
+    for(j=1; j<=i; j++)
+    {
+      Ah[j] =Anh[j];
+      Al[j] =Anl[j];
+    }
+  }
+
+  *Err = shr(alp_h, alp_exp);
+
+  /* Truncate A[i] in Q27 to Q12 with rounding */
+
+  A[0] = 4096;
+  for(i=1; i<=M; i++)
+  {
+    t0   = L_Comp(Ah[i], Al[i]);
+    old_A[i] = A[i] = round(L_shl(t0, 1));
+  }
+  old_rc[0] = rc[0];
+  old_rc[1] = rc[1];
+}
+
+/* qua_lsp.c */
+static void
+g729_qua_lsp (
+  G729EncState *state,
+  Word16 lsp[],       /* (i) Q15 : Unquantized LSP            */
+  Word16 lsp_q[],     /* (o) Q15 : Quantized LSP              */
+  Word16 ana[]        /* (o)     : indexes                    */
+)
+{
+  Word16 lsf[M], lsf_q[M];  /* domain 0.0<= lsf <PI in Q13 */
+  Word16 wegt[M];           /* Q11->normalized : weighting coefficients */
+
+  /* Convert LSPs to LSFs */
+  Lsp_lsf2(lsp, lsf, M);
+
+  /* Lsp_qua_cs() */
+  Get_wegt( lsf, wegt );
+
+  Relspwed( lsf, wegt, lsf_q, lspcb1, lspcb2, fg,
+    state->freq_prev, fg_sum, fg_sum_inv, ana);
+
+  /* Convert LSFs to LSPs */
+  Lsf_lsp2(lsf_q, lsp_q, M);
+}
+
+/* qua_gain.c */
+static void
+g729_gbk_presel (
+   Word16 best_gain[],     /* (i) [0] Q9 : unquantized pitch gain     */
+                           /* (i) [1] Q2 : unquantized code gain      */
+   Word16 *cand1,          /* (o)    : index of best 1st stage vector */
+   Word16 *cand2,          /* (o)    : index of best 2nd stage vector */
+   Word16 gcode0           /* (i) Q4 : presearch for gain codebook    */
+)
+{
+   Word16    acc_h;
+   Word16    sft_x,sft_y;
+   Word32    L_acc,L_preg,L_cfbg,L_tmp,L_tmp_x,L_tmp_y;
+   Word32 L_temp;
+
+ /*--------------------------------------------------------------------------*
+   x = (best_gain[1]-(coef[0][0]*best_gain[0]+coef[1][1])*gcode0) * inv_coef;
+  *--------------------------------------------------------------------------*/
+   L_cfbg = L_mult( coef[0][0], best_gain[0] );        /* L_cfbg:Q20 -> !!y */
+   L_acc = L_shr( L_coef[1][1], 15 );                  /* L_acc:Q20     */
+   L_acc = L_add( L_cfbg , L_acc );
+   acc_h = extract_h( L_acc );                         /* acc_h:Q4      */
+   L_preg = L_mult( acc_h, gcode0 );                   /* L_preg:Q9     */
+   L_acc = L_shl( L_deposit_l( best_gain[1] ), 7 );    /* L_acc:Q9      */
+   L_acc = L_sub( L_acc, L_preg );
+   acc_h = extract_h( L_shl( L_acc,2 ) );              /* L_acc_h:Q[-5] */
+   L_tmp_x = L_mult( acc_h, INV_COEF );                /* L_tmp_x:Q15   */
+
+ /*--------------------------------------------------------------------------*
+   y = (coef[1][0]*(-coef[0][1]+best_gain[0]*coef[0][0])*gcode0
+                                      -coef[0][0]*best_gain[1]) * inv_coef;
+  *--------------------------------------------------------------------------*/
+   L_acc = L_shr( L_coef[0][1], 10 );                  /* L_acc:Q20   */
+   L_acc = L_sub( L_cfbg, L_acc );                     /* !!x -> L_cfbg:Q20 */
+   acc_h = extract_h( L_acc );                         /* acc_h:Q4    */
+   acc_h = mult( acc_h, gcode0 );                      /* acc_h:Q[-7] */
+   L_tmp = L_mult( acc_h, coef[1][0] );                /* L_tmp:Q10   */
+
+   L_preg = L_mult( coef[0][0], best_gain[1] );        /* L_preg:Q13  */
+   L_acc = L_sub( L_tmp, L_shr(L_preg,3) );            /* L_acc:Q10   */
+
+   acc_h = extract_h( L_shl( L_acc,2 ) );              /* acc_h:Q[-4] */
+   L_tmp_y = L_mult( acc_h, INV_COEF );                /* L_tmp_y:Q16 */
+
+   sft_y = (14+4+1)-16;         /* (Q[thr1]+Q[gcode0]+1)-Q[L_tmp_y] */
+   sft_x = (15+4+1)-15;         /* (Q[thr2]+Q[gcode0]+1)-Q[L_tmp_x] */
+
+   if(gcode0>0){
+      /*-- pre select codebook #1 --*/
+      *cand1 = 0 ;
+      do{
+         L_temp = L_sub( L_tmp_y, L_shr(L_mult(thr1[*cand1],gcode0),sft_y));
+         if(L_temp >0L  ){
+           (*cand1) =add(*cand1,1);
+         }
+         else               break ;
+      } while(sub((*cand1),(NCODE1-NCAN1))<0) ;
+      /*-- pre select codebook #2 --*/
+      *cand2 = 0 ;
+      do{
+         L_temp = L_sub( L_tmp_x , L_shr(L_mult(thr2[*cand2],gcode0),sft_x));
+         if( L_temp >0L) {
+           (*cand2) =add(*cand2,1);
+         }
+         else               break ;
+      } while(sub((*cand2),(NCODE2-NCAN2))<0) ;
+   }
+   else{
+      /*-- pre select codebook #1 --*/
+      *cand1 = 0 ;
+      do{
+         L_temp = L_sub(L_tmp_y ,L_shr(L_mult(thr1[*cand1],gcode0),sft_y));
+         if( L_temp <0L){
+           (*cand1) =add(*cand1,1);
+         }
+         else               break ;
+      } while(sub((*cand1),(NCODE1-NCAN1))) ;
+      /*-- pre select codebook #2 --*/
+      *cand2 = 0 ;
+      do{
+         L_temp =L_sub(L_tmp_x ,L_shr(L_mult(thr2[*cand2],gcode0),sft_x));
+         if( L_temp <0L){
+           (*cand2) =add(*cand2,1);
+         }
+         else               break ;
+      } while(sub( (*cand2),(NCODE2-NCAN2))) ;
+   }
+}
+
+/* qua_gain.c */
+static Word16
+g729_qua_gain (
+   Word16 past_qua_en[],/* (i/o) Q10 :Past quantized energies      */
+   Word16 code[],       /* (i) Q13 :Innovative vector.             */
+   Word16 g_coeff[],    /* (i)     :Correlations <xn y1> -2<y1 y1> */
+                        /*            <y2,y2>, -2<xn,y2>, 2<y1,y2> */
+   Word16 exp_coeff[],  /* (i)     :Q-Format g_coeff[]             */
+   Word16 L_subfr,      /* (i)     :Subframe length.               */
+   Word16 *gain_pit,    /* (o) Q14 :Pitch gain.                    */
+   Word16 *gain_cod,    /* (o) Q1  :Code gain.                     */
+   Word16 tameflag      /* (i)     : set to 1 if taming is needed  */
+)
+{
+   Word16  i, j, index1, index2;
+   Word16  cand1, cand2;
+   Word16  exp, gcode0, exp_gcode0, gcode0_org, e_min ;
+   Word16  nume, denom, inv_denom;
+   Word16  exp1,exp2,exp_nume,exp_denom,exp_inv_denom,sft,tmp;
+   Word16  g_pitch, g2_pitch, g_code, g2_code, g_pit_cod;
+   Word16  coeff[5], coeff_lsf[5];
+   Word16  exp_min[5];
+   Word32  L_gbk12;
+   Word32  L_tmp, L_dist_min, L_temp, L_tmp1, L_tmp2, L_acc, L_accb;
+   Word16  best_gain[2];
+
+ /*---------------------------------------------------*
+  *-  energy due to innovation                       -*
+  *-  predicted energy                               -*
+  *-  predicted codebook gain => gcode0[exp_gcode0]  -*
+  *---------------------------------------------------*/
+
+   Gain_predict( past_qua_en, code, L_subfr, &gcode0, &exp_gcode0 );
+
+  /*-----------------------------------------------------------------*
+   *  pre-selection                                                  *
+   *-----------------------------------------------------------------*/
+  /*-----------------------------------------------------------------*
+   *  calculate best gain                                            *
+   *                                                                 *
+   *  tmp = -1./(4.*coeff[0]*coeff[2]-coeff[4]*coeff[4]) ;           *
+   *  best_gain[0] = (2.*coeff[2]*coeff[1]-coeff[3]*coeff[4])*tmp ;  *
+   *  best_gain[1] = (2.*coeff[0]*coeff[3]-coeff[1]*coeff[4])*tmp ;  *
+   *  gbk_presel(best_gain,&cand1,&cand2,gcode0) ;                   *
+   *                                                                 *
+   *-----------------------------------------------------------------*/
+
+  /*-----------------------------------------------------------------*
+   *  tmp = -1./(4.*coeff[0]*coeff[2]-coeff[4]*coeff[4]) ;           *
+   *-----------------------------------------------------------------*/
+   L_tmp1 = L_mult( g_coeff[0], g_coeff[2] );
+   exp1   = add( add( exp_coeff[0], exp_coeff[2] ), 1-2 );
+   L_tmp2 = L_mult( g_coeff[4], g_coeff[4] );
+   exp2   = add( add( exp_coeff[4], exp_coeff[4] ), 1 );
+
+   if( sub(exp1, exp2)>0 ){
+      L_tmp = L_sub( L_shr( L_tmp1, sub(exp1,exp2) ), L_tmp2 );
+      exp = exp2;
+   }
+   else{
+      L_tmp = L_sub( L_tmp1, L_shr( L_tmp2, sub(exp2,exp1) ) );
+      exp = exp1;
+   }
+   sft = norm_l( L_tmp );
+   denom = extract_h( L_shl(L_tmp, sft) );
+   exp_denom = sub( add( exp, sft ), 16 );
+
+   inv_denom = div_s(16384,denom);
+   inv_denom = negate( inv_denom );
+   exp_inv_denom = sub( 14+15, exp_denom );
+
+  /*-----------------------------------------------------------------*
+   *  best_gain[0] = (2.*coeff[2]*coeff[1]-coeff[3]*coeff[4])*tmp ;  *
+   *-----------------------------------------------------------------*/
+   L_tmp1 = L_mult( g_coeff[2], g_coeff[1] );
+   exp1   = add( exp_coeff[2], exp_coeff[1] );
+   L_tmp2 = L_mult( g_coeff[3], g_coeff[4] );
+   exp2   = add( add( exp_coeff[3], exp_coeff[4] ), 1 );
+
+   if( sub(exp1, exp2)>0 ){
+      L_tmp = L_sub( L_shr( L_tmp1, add(sub(exp1,exp2),1 )), L_shr( L_tmp2,1 ) );
+      exp = sub(exp2,1);
+   }
+   else{
+      L_tmp = L_sub( L_shr( L_tmp1,1 ), L_shr( L_tmp2, add(sub(exp2,exp1),1 )) );
+      exp = sub(exp1,1);
+   }
+   sft = norm_l( L_tmp );
+   nume = extract_h( L_shl(L_tmp, sft) );
+   exp_nume = sub( add( exp, sft ), 16 );
+
+   sft = sub( add( exp_nume, exp_inv_denom ), (9+16-1) );
+   L_acc = L_shr( L_mult( nume,inv_denom ), sft );
+   best_gain[0] = extract_h( L_acc );             /*-- best_gain[0]:Q9 --*/
+
+   if (tameflag == 1){
+     if(sub(best_gain[0], GPCLIP2) > 0) best_gain[0] = GPCLIP2;
+   }
+
+  /*-----------------------------------------------------------------*
+   *  best_gain[1] = (2.*coeff[0]*coeff[3]-coeff[1]*coeff[4])*tmp ;  *
+   *-----------------------------------------------------------------*/
+   L_tmp1 = L_mult( g_coeff[0], g_coeff[3] );
+   exp1   = add( exp_coeff[0], exp_coeff[3] ) ;
+   L_tmp2 = L_mult( g_coeff[1], g_coeff[4] );
+   exp2   = add( add( exp_coeff[1], exp_coeff[4] ), 1 );
+
+   if( sub(exp1, exp2)>0 ){
+      L_tmp = L_sub( L_shr( L_tmp1, add(sub(exp1,exp2),1) ), L_shr( L_tmp2,1 ) );
+      exp = sub(exp2,1);
+   }
+   else{
+      L_tmp = L_sub( L_shr( L_tmp1,1 ), L_shr( L_tmp2, add(sub(exp2,exp1),1) ) );
+      exp = sub(exp1,1);
+   }
+   sft = norm_l( L_tmp );
+   nume = extract_h( L_shl(L_tmp, sft) );
+   exp_nume = sub( add( exp, sft ), 16 );
+
+   sft = sub( add( exp_nume, exp_inv_denom ), (2+16-1) );
+   L_acc = L_shr( L_mult( nume,inv_denom ), sft );
+   best_gain[1] = extract_h( L_acc );             /*-- best_gain[1]:Q2 --*/
+
+   /*--- Change Q-format of gcode0 ( Q[exp_gcode0] -> Q4 ) ---*/
+   if( sub(exp_gcode0,4) >= 0 ){
+      gcode0_org = shr( gcode0, sub(exp_gcode0,4) );
+   }
+   else{
+      L_acc = L_deposit_l( gcode0 );
+      L_acc = L_shl( L_acc, sub( (4+16), exp_gcode0 ) );
+      gcode0_org = extract_h( L_acc );              /*-- gcode0_org:Q4 --*/
+   }
+
+  /*----------------------------------------------*
+   *   - presearch for gain codebook -            *
+   *----------------------------------------------*/
+
+   g729_gbk_presel(best_gain, &cand1, &cand2, gcode0_org );
+
+/*---------------------------------------------------------------------------*
+ *                                                                           *
+ * Find the best quantizer.                                                  *
+ *                                                                           *
+ * term 0: g_pitch*g_pitch*coeff[0] ;exp_min0 = 13             +exp_coeff[0] *
+ * term 1: g_pitch        *coeff[1] ;exp_min1 = 14             +exp_coeff[1] *
+ * term 2: g_code*g_code  *coeff[2] ;exp_min2 = 2*exp_gcode0-21+exp_coeff[2] *
+ * term 3: g_code         *coeff[3] ;exp_min3 = exp_gcode0  - 3+exp_coeff[3] *
+ * term 4: g_pitch*g_code *coeff[4] ;exp_min4 = exp_gcode0  - 4+exp_coeff[4] *
+ *                                                                           *
+ *---------------------------------------------------------------------------*/
+
+   exp_min[0] = add( exp_coeff[0], 13 );
+   exp_min[1] = add( exp_coeff[1], 14 );
+   exp_min[2] = add( exp_coeff[2], sub( shl( exp_gcode0, 1 ), 21 ) );
+   exp_min[3] = add( exp_coeff[3], sub( exp_gcode0, 3 ) );
+   exp_min[4] = add( exp_coeff[4], sub( exp_gcode0, 4 ) );
+
+   e_min = exp_min[0];
+   for(i=1; i<5; i++){
+      if( sub(exp_min[i], e_min) < 0 ){
+         e_min = exp_min[i];
+      }
+   }
+
+   /* align coeff[] and save in special 32 bit double precision */
+
+   for(i=0; i<5; i++){
+     j = sub( exp_min[i], e_min );
+     L_tmp = L_deposit_h( g_coeff[i] );
+     L_tmp = L_shr( L_tmp, j );          /* L_tmp:Q[exp_g_coeff[i]+16-j] */
+     L_Extract( L_tmp, &coeff[i], &coeff_lsf[i] );          /* DPF */
+   }
+
+   /* Codebook search */
+
+   L_dist_min = MAX_32;
+
+   index1 = cand1;
+   index2 = cand2;
+
+   for(i=0; i<NCAN1; i++){
+      for(j=0; j<NCAN2; j++){
+         g_pitch = add( gbk1[cand1+i][0], gbk2[cand2+j][0] );     /* Q14 */
+         if(tameflag == 1 && g_pitch >= GP0999)
+           continue;
+
+         L_acc = L_deposit_l( gbk1[cand1+i][1] );
+         L_accb = L_deposit_l( gbk2[cand2+j][1] );                /* Q13 */
+         L_tmp = L_add( L_acc,L_accb );
+         tmp = extract_l( L_shr( L_tmp,1 ) );                    /* Q12 */
+
+         g_code   = mult( gcode0, tmp );         /*  Q[exp_gcode0+12-15] */
+         g2_pitch = mult(g_pitch, g_pitch);                     /* Q13 */
+         g2_code  = mult(g_code, g_code);         /* Q[2*exp_gcode0-6-15] */
+         g_pit_cod= mult(g_code, g_pitch);         /* Q[exp_gcode0-3+14-15] */
+
+         L_tmp = Mpy_32_16(coeff[0], coeff_lsf[0], g2_pitch);
+         L_tmp = L_add(L_tmp, Mpy_32_16(coeff[1], coeff_lsf[1], g_pitch));
+         L_tmp = L_add(L_tmp, Mpy_32_16(coeff[2], coeff_lsf[2], g2_code));
+         L_tmp = L_add(L_tmp, Mpy_32_16(coeff[3], coeff_lsf[3], g_code));
+         L_tmp = L_add(L_tmp, Mpy_32_16(coeff[4], coeff_lsf[4], g_pit_cod));
+
+         L_temp = L_sub(L_tmp, L_dist_min);
+
+         if( L_temp < 0L ){
+           L_dist_min = L_tmp;
+           index1 = add(cand1,i);
+           index2 = add(cand2,j);
+         }
+      }
+   }
+
+   /* Read the quantized gain */
+
+  /*-----------------------------------------------------------------*
+   * *gain_pit = gbk1[indice1][0] + gbk2[indice2][0];                *
+   *-----------------------------------------------------------------*/
+   *gain_pit = add( gbk1[index1][0], gbk2[index2][0] );      /* Q14 */
+
+  /*-----------------------------------------------------------------*
+   * *gain_code = (gbk1[indice1][1]+gbk2[indice2][1]) * gcode0;      *
+   *-----------------------------------------------------------------*/
+   L_acc = L_deposit_l( gbk1[index1][1] );
+   L_accb = L_deposit_l( gbk2[index2][1] );
+   L_gbk12 = L_add( L_acc, L_accb );                          /* Q13 */
+   tmp = extract_l( L_shr( L_gbk12,1 ) );                     /* Q12 */
+   L_acc = L_mult(tmp, gcode0);                /* Q[exp_gcode0+12+1] */
+
+   L_acc = L_shl(L_acc, add( negate(exp_gcode0),(-12-1+1+16) ));
+   *gain_cod = extract_h( L_acc );                          /* Q1 */
+
+  /*----------------------------------------------*
+   * update table of past quantized energies      *
+   *----------------------------------------------*/
+   Gain_update( past_qua_en, L_gbk12 );
+
+   return( add( map1[index1]*(Word16)16, map2[index2] ) );
+}
+
+/* taming.c */
+Word16
+g729_taming_test (  /* (o) flag set to 1 if taming is necessary  */
+ const Word32 L_exc_err[],
+ Word16 T0,       /* (i) integer part of pitch delay           */
+ Word16 T0_frac   /* (i) fractional part of pitch delay        */
+)
+{
+    Word16 i, t1, zone1, zone2, flag;
+    Word32 L_maxloc, L_acc;
+
+    if(T0_frac > 0) {
+        t1 = add(T0, 1);
+    }
+    else {
+        t1 = T0;
+    }
+
+    i = sub(t1, (L_SUBFR+L_INTER10));
+    if(i < 0) {
+        i = 0;
+    }
+    zone1 = tab_zone[i];
+
+    i = add(t1, (L_INTER10 - 2));
+    zone2 = tab_zone[i];
+
+    L_maxloc = -1L;
+    flag = 0 ;
+    for(i=zone2; i>=zone1; i--) {
+        L_acc = L_sub(L_exc_err[i], L_maxloc);
+        if(L_acc > 0L) {
+                L_maxloc = L_exc_err[i];
+        }
+    }
+    L_acc = L_sub(L_maxloc, L_THRESH_ERR);
+    if(L_acc > 0L) {
+        flag = 1;
+    }
+
+    return(flag);
+}
+
+/* taming.c: update_exc_err() */
+void
+g729_taming_update (
+ Word32 L_exc_err[],
+ Word16 gain_pit,      /* (i) pitch gain */
+ Word16 T0             /* (i) integer part of pitch delay */
+)
+{
+    Word16 i, zone1, zone2, n;
+    Word32 L_worst, L_temp, L_acc;
+    Word16 hi, lo;
+
+    L_worst = -1L;
+    n = sub(T0, L_SUBFR);
+
+    if(n < 0) {
+        L_Extract(L_exc_err[0], &hi, &lo);
+        L_temp = Mpy_32_16(hi, lo, gain_pit);
+        L_temp = L_shl(L_temp, 1);
+        L_temp = L_add(0x00004000L, L_temp);
+        L_acc = L_sub(L_temp, L_worst);
+        if(L_acc > 0L) {
+                L_worst = L_temp;
+        }
+        L_Extract(L_temp, &hi, &lo);
+        L_temp = Mpy_32_16(hi, lo, gain_pit);
+        L_temp = L_shl(L_temp, 1);
+        L_temp = L_add(0x00004000L, L_temp);
+        L_acc = L_sub(L_temp, L_worst);
+        if(L_acc > 0L) {
+                L_worst = L_temp;
+        }
+    }
+
+    else {
+
+        zone1 = tab_zone[n];
+
+        i = sub(T0, 1);
+        zone2 = tab_zone[i];
+
+        for(i = zone1; i <= zone2; i++) {
+                L_Extract(L_exc_err[i], &hi, &lo);
+                L_temp = Mpy_32_16(hi, lo, gain_pit);
+                L_temp = L_shl(L_temp, 1);
+                L_temp = L_add(0x00004000L, L_temp);
+                L_acc = L_sub(L_temp, L_worst);
+                if(L_acc > 0L) L_worst = L_temp;
+        }
+    }
+
+    for(i=3; i>=1; i--) {
+        L_exc_err[i] = L_exc_err[i-1];
+    }
+    L_exc_err[0] = L_worst;
+}
+
+/* cod_ld8a.c: Coder_ld8a(), up to the LPC coefficients of the frame */
+int
+g729_coder_frame_lpc (
+     G729EncState *state,
+     G729CoderFrame *f,
+     Word16 ana[],       /* output  : Analysis parameters */
+     Word16 frame,       /* input   : frame counter       */
+     Word16 vad_enable   /* input   : VAD enable flag     */
+)
+{
+  Word16 *speech = state->speech;
+  Word16 *wsp = state->wsp;
+  Word16 *exc = state->exc;
+
+  /* LPC analysis */
+  Word16 r_l[NP+1], r_h[NP+1];     /* Autocorrelations low and hi          */
+  Word16 rc[M];                    /* Reflection coefficients.             */
+  Word16 lsp_new[M], lsp_new_q[M]; /* LSPs at 2th subframe                 */
+
+  /* For G.729B */
+  Word16 rh_nbe[MP1];
+  Word16 lsf_new[M];
+  Word16 exp_R0, Vad;
+
+  /* LPC coefficients */
+  Word16 *Aq_t = f->Aq_t;       /* A(z)   quantized for the 2 subframes */
+  Word16 *Ap_t = f->Ap_t;       /* A(z/gamma)       for the 2 subframes */
+  Word16 *Aq, *Ap;              /* Pointer on Aq_t and Ap_t             */
+
+  Word16 xn[L_SUBFR];            /* Residual of the inactive frames    */
+
+  /* Scalars */
+  Word16 i, i_subfr;
+  Word16 temp;
+
+/*------------------------------------------------------------------------*
+ *  - Perform LPC analysis:                                               *
+ *       * autocorrelation + lag windowing                                *
+ *       * Levinson-durbin algorithm to find a[]                          *
+ *       * convert a[] to lsp[]                                           *
+ *       * quantize and code the LSPs                                     *
+ *       * find the interpolated LSPs and convert to a[] for the 2        *
+ *         subframes (both quantized and unquantized)                     *
+ *------------------------------------------------------------------------*/
+  {
+    /* LP analysis */
+    g729_kernels_autocorr(state->p_window, NP, r_h, r_l, &exp_R0);  /* Autocorrelations */
+    Copy(r_h, rh_nbe, MP1);
+    Lag_window(NP, r_h, r_l);                          /* Lag windowing    */
+    g729_levinson(state->old_A, state->old_rc, r_h, r_l, Ap_t, rc,
+        &temp);                                        /* Levinson Durbin  */
+    Az_lsp(Ap_t, lsp_new, state->lsp_old);            /* From A(z) to lsp */
+
+    /* For G.729B */
+    /* ------ VAD ------- */
+    if (vad_enable == 1) {
+      Lsp_lsf(lsp_new, lsf_new, M);
+      g729_vad_frame(&state->vad, rc[1], lsf_new, r_h, r_l, exp_R0,
+          state->p_window, frame, state->pastVad, state->ppastVad, &Vad);
+    }
+    else
+      Vad = 1;
+
+    g729_cng_update(&state->cng, rh_nbe, exp_R0, Vad);
+
+    /* ---------------------- */
+    /* Case of Inactive frame */
+    /* ---------------------- */
+
+    if ((Vad == 0) && (vad_enable == 1)){
+
+      g729_cng_encode(state, exc, state->pastVad, Aq_t, ana);
+      state->ppastVad = state->pastVad;
+      state->pastVad = Vad;
+
+      /* Update wsp, mem_w and mem_w0 */
+      Aq = Aq_t;
+      for(i_subfr=0; i_subfr < L_FRAME; i_subfr += L_SUBFR) {
+
+        /* Residual signal in xn */
+        Residu(Aq, &speech[i_subfr], xn, L_SUBFR);
+
+        Weight_Az(Aq, GAMMA1, M, Ap_t);
+
+        /* Compute wsp and mem_w */
+        Ap = Ap_t + MP1;
+        Ap[0] = 4096;
+        for(i=1; i<=M; i++)    /* Ap[i] = Ap_t[i] - 0.7 * Ap_t[i-1]; */
+          Ap[i] = sub(Ap_t[i], mult(Ap_t[i-1], 22938));
+        Syn_filt(Ap, xn, &wsp[i_subfr], L_SUBFR, state->mem_w, 1);
+
+        /* Compute mem_w0 */
+        for(i=0; i<L_SUBFR; i++) {
+          xn[i] = sub(xn[i], exc[i_subfr+i]);  /* residu[] - exc[] */
+        }
+        Syn_filt(Ap_t, xn, xn, L_SUBFR, state->mem_w0, 1);
+
+        Aq += MP1;
+      }
+
+      state->sharp = SHARPMIN;
+
+      /* Update memories for next frames */
+      Copy(&state->old_speech[L_FRAME], &state->old_speech[0], L_TOTAL-L_FRAME);
+      Copy(&state->old_wsp[L_FRAME], &state->old_wsp[0], PIT_MAX);
+      Copy(&state->old_exc[L_FRAME], &state->old_exc[0], PIT_MAX+L_INTERPOL);
+
+      return 0;
+    }  /* End of inactive frame case */
+
+    /* -------------------- */
+    /* Case of Active frame */
+    /* -------------------- */
+
+    *ana++ = 1;
+    state->seed = INIT_SEED;
+    state->ppastVad = state->pastVad;
+    state->pastVad = Vad;
+
+    /* LSP quantization */
+    g729_qua_lsp(state, lsp_new, lsp_new_q, ana);
+    ana += 2;                         /* Advance analysis parameters pointer */
+
+    /*--------------------------------------------------------------------*
+     * Find interpolated LPC parameters in all subframes                  *
+     * The interpolated parameters are in array Aq_t[].                   *
+     *--------------------------------------------------------------------*/
+
+    Int_qlpc(state->lsp_old_q, lsp_new_q, Aq_t);
+
+    /* Compute A(z/gamma) */
+
+    Weight_Az(&Aq_t[0],   GAMMA1, M, &Ap_t[0]);
+    Weight_Az(&Aq_t[MP1], GAMMA1, M, &Ap_t[MP1]);
+
+    /* update the LSPs for the next frame */
+
+    Copy(lsp_new,   state->lsp_old,   M);
+    Copy(lsp_new_q, state->lsp_old_q, M);
+  }
+
+  f->ana = ana;
+  f->overflow = Overflow;
+
+  return 1;
+}
+
+/* A(z/gamma) - 0.7 A(z/gamma) z^-1 of the weighting filter of a subframe */
+void
+g729_coder_weight_coeffs (Word16 Ap[], Word16 Ap1[])
+{
+  Word16 i;
+
+  Ap1[0] = 4096;
+  for(i=1; i<=M; i++)    /* Ap1[i] = Ap[i] - 0.7 * Ap[i-1]; */
+     Ap1[i] = sub(Ap[i], mult(Ap[i-1], 22938));
+}
+
+/* cod_ld8a.c: Coder_ld8a(), the filters of an active frame depending only
+ * on its LPC coefficients and on the filter memories */
+void
+g729_coder_frame_filters (
+     G729EncState *state,
+     G729CoderFrame *f
+)
+{
+  Word16 *speech = state->speech;
+  Word16 *wsp = state->wsp;
+  Word16 *exc = state->exc;
+  Word16 Ap1[MP1];
+  Word16 i_subfr;
+
+  Overflow = f->overflow;
+
+  /*----------------------------------------------------------------------*
+   * - Find the weighted input speech w_sp[] for the whole speech frame   *
+   *----------------------------------------------------------------------*/
+
+  Residu(&f->Aq_t[0], &speech[0], &exc[0], L_SUBFR);
+  Residu(&f->Aq_t[MP1], &speech[L_SUBFR], &exc[L_SUBFR], L_SUBFR);
+
+  g729_coder_weight_coeffs(&f->Ap_t[0], Ap1);
+  Syn_filt(Ap1, &exc[0], &wsp[0], L_SUBFR, state->mem_w, 1);
+
+  g729_coder_weight_coeffs(&f->Ap_t[MP1], Ap1);
+  Syn_filt(Ap1, &exc[L_SUBFR], &wsp[L_SUBFR], L_SUBFR, state->mem_w, 1);
+
+  /*---------------------------------------------------------------*
+   * Compute impulse response, h1[], of weighted synthesis filter  *
+   *---------------------------------------------------------------*/
+
+  for (i_subfr = 0; i_subfr < 2; i_subfr++)
+  {
+    Word16 *h1 = f->h1[i_subfr];
+
+    h1[0] = 4096;
+    Set_zero(&h1[1], L_SUBFR-1);
+    Syn_filt(&f->Ap_t[i_subfr*MP1], h1, h1, L_SUBFR, &h1[1], 0);
+  }
+
+  f->overflow = Overflow;
+}
+
+/* cod_ld8a.c: Coder_ld8a(), from the open-loop pitch search on */
+void
+g729_coder_frame_search (
+     G729EncState *state,
+     G729CoderFrame *f,
+     int complexity      /* input   : search complexity   */
+)
+{
+  Word16 *wsp = state->wsp;
+  Word16 *exc = state->exc;
+  Word16 *ana = f->ana;
+
+  Word16 *Aq, *Ap;              /* Pointer on Aq_t and Ap_t             */
+
+  /* Other vectors */
+  Word16 *h1;                    /* Impulse response h1[]              */
+  Word16 xn[L_SUBFR];            /* Target vector for pitch search     */
+  Word16 xn2[L_SUBFR];           /* Target vector for codebook search  */
+  Word16 code[L_SUBFR];          /* Fixed codebook excitation          */
+  Word16 y1[L_SUBFR];            /* Filtered adaptive excitation       */
+  Word16 y2[L_SUBFR];            /* Filtered fixed codebook excitation */
+  Word16 g_coeff[4];             /* Correlations between xn & y1       */
+  Word16 g_coeff_cs[5];
+  Word16 exp_g_coeff_cs[5];
+
+  /* Scalars */
+  Word16 i, j, k, i_subfr;
+  Word16 T_op, T0, T0_min, T0_max, T0_frac;
+  Word16 gain_pit, gain_code, index;
+  Word16 temp, taming;
+  Word32 L_temp;
+
+  Overflow = f->overflow;
+
+  /* Find open loop pitch lag */
+
+  T_op = g729_search_pitch_ol_fast(complexity, wsp, PIT_MAX, L_FRAME);
+
+  /* Range for closed loop pitch search in 1st subframe */
+
+  T0_min = sub(T_op, 3);
+  if (sub(T0_min,PIT_MIN)<0) {
+    T0_min = PIT_MIN;
+  }
+
+  T0_max = add(T0_min, 6);
+  if (sub(T0_max ,PIT_MAX)>0)
+  {
+     T0_max = PIT_MAX;
+     T0_min = sub(T0_max, 6);
+  }
+
+ /*------------------------------------------------------------------------*
+  *          Loop for every subframe in the analysis frame                 *
+  *------------------------------------------------------------------------*
+  *  To find the pitch and innovation parameters. The subframe size is     *
+  *  L_SUBFR and the loop is repeated 2 times.                             *
+  *     - find the weighted LPC coefficients                               *
+  *     - find the LPC residual signal res[]                               *
+  *     - compute the target signal for pitch search                       *
+  *     - compute impulse response of weighted synthesis filter (h1[])     *
+  *     - find the closed-loop pitch parameters                            *
+  *     - encode the pitch delay                                           *
+  *     - find target vector for codebook search                           *
+  *     - codebook search                                                  *
+  *     - VQ of pitch and codebook gains                                   *
+  *     - update states of weighting filter                                *
+  *------------------------------------------------------------------------*/
+
+  Aq = f->Aq_t; /* pointer to interpolated quantized LPC parameters */
+  Ap = f->Ap_t; /* pointer to weighted LPC coefficients             */
+
+  for (i_subfr = 0;  i_subfr < L_FRAME; i_subfr += L_SUBFR)
+  {
+
+    /* impulse response h1[] of the weighted synthesis filter, from
+     * g729_coder_frame_filters() */
+
+    h1 = f->h1[i_subfr / L_SUBFR];
+
+    /*----------------------------------------------------------------------*
+     *  Find the target vector for pitch search:                            *
+     *----------------------------------------------------------------------*/
+
+    Syn_filt(Ap, &exc[i_subfr], xn, L_SUBFR, state->mem_w0, 0);
+
+    /*---------------------------------------------------------------------*
+     *                 Closed-loop fractional pitch search                 *
+     *---------------------------------------------------------------------*/
+
+    T0 = Pitch_fr3_fast(&exc[i_subfr], xn, h1, L_SUBFR, T0_min, T0_max,
+                    i_subfr, &T0_frac);
+
+    index = Enc_lag3(T0, T0_frac, &T0_min, &T0_max,PIT_MIN,PIT_MAX,i_subfr);
+
+    *ana++ = index;
+
+    if (i_subfr == 0) {
+      *ana++ = Parity_Pitch(index);
+    }
+
+   /*-----------------------------------------------------------------*
+    *   - find filtered pitch exc                                     *
+    *   - compute pitch gain and limit between 0 and 1.2              *
+    *   - update target vector for codebook search                    *
+    *-----------------------------------------------------------------*/
+
+    Syn_filt(Ap, &exc[i_subfr], y1, L_SUBFR, state->mem_zero, 0);
+
+    gain_pit = G_pitch(xn, y1, g_coeff, L_SUBFR);
+
+    /* clip pitch gain if taming is necessary */
+
+    taming = g729_taming_test(state->L_exc_err, T0, T0_frac);
+
+    if( taming == 1){
+      if (sub(gain_pit, GPCLIP) > 0) {
+        gain_pit = GPCLIP;
+      }
+    }
+
+    /* xn2[i]   = xn[i] - y1[i] * gain_pit  */
+
+    for (i = 0; i < L_SUBFR; i++)
+    {
+      L_temp = L_mult(y1[i], gain_pit);
+      L_temp = L_shl(L_temp, 1);               /* gain_pit in Q14 */
+      xn2[i] = sub(xn[i], extract_h(L_temp));
+    }
+
+
+   /*-----------------------------------------------------*
+    * - Innovative codebook search.                       *
+    *-----------------------------------------------------*/
+
+    index = g729_search_acelp_code_a(complexity, xn2, h1, T0, state->sharp,
+        code, y2, &i);
+
+    *ana++ = index;        /* Positions index */
+    *ana++ = i;            /* Signs index     */
+
+
+   /*-----------------------------------------------------*
+    * - Quantization of gains.                            *
+    *-----------------------------------------------------*/
+
+    g_coeff_cs[0]     = g_coeff[0];            /* <y1,y1> */
+    exp_g_coeff_cs[0] = negate(g_coeff[1]);    /* Q-Format:XXX -> JPN */
+    g_coeff_cs[1]     = negate(g_coeff[2]);    /* (xn,y1) -> -2<xn,y1> */
+    exp_g_coeff_cs[1] = negate(add(g_coeff[3], 1)); /* Q-Format:XXX -> JPN */
+
+    Corr_xy2( xn, y1, y2, g_coeff_cs, exp_g_coeff_cs );  /* Q0 Q0 Q12 ^Qx ^Q0 */
+                         /* g_coeff_cs[3]:exp_g_coeff_cs[3] = <y2,y2>   */
+                         /* g_coeff_cs[4]:exp_g_coeff_cs[4] = -2<xn,y2> */
+                         /* g_coeff_cs[5]:exp_g_coeff_cs[5] = 2<y1,y2>  */
+
+    *ana++ = g729_qua_gain(state->past_qua_en, code, g_coeff_cs,
+        exp_g_coeff_cs, L_SUBFR, &gain_pit, &gain_code, taming);
+
+
+   /*------------------------------------------------------------*
+    * - Update pitch sharpening "sharp" with quantized gain_pit  *
+    *------------------------------------------------------------*/
+
+    state->sharp = gain_pit;
+    if (sub(state->sharp, SHARPMAX) > 0) { state->sharp = SHARPMAX; }
+    if (sub(state->sharp, SHARPMIN) < 0) { state->sharp = SHARPMIN; }
+
+   /*------------------------------------------------------*
+    * - Find the total excitation                          *
+    * - update filters memories for finding the target     *
+    *   vector in the next subframe                        *
+    *------------------------------------------------------*/
+
+    for (i = 0; i < L_SUBFR;  i++)
+    {
+      /* exc[i] = gain_pit*exc[i] + gain_code*code[i]; */
+      /* exc[i]  in Q0   gain_pit in Q14               */
+      /* code[i] in Q13  gain_cod in Q1                */
+
+      L_temp = L_mult(exc[i+i_subfr], gain_pit);
+      L_temp = L_mac(L_temp, code[i], gain_code);
+      L_temp = L_shl(L_temp, 1);
+      exc[i+i_subfr] = round(L_temp);
+    }
+
+    g729_taming_update(state->L_exc_err, gain_pit, T0);
+
+    for (i = L_SUBFR-M, j = 0; i < L_SUBFR; i++, j++)
+    {
+      temp       = extract_h(L_shl( L_mult(y1[i], gain_pit),  1) );
+      k          = extract_h(L_shl( L_mult(y2[i], gain_code), 2) );
+      state->mem_w0[j]  = sub(xn[i], add(temp, k));
+    }
+
+    Aq += MP1;           /* interpolated LPC parameters for next subframe */
+    Ap += MP1;
+
+  }
+
+  /*--------------------------------------------------*
+   * Update signal for next frame.                    *
+   * -> shift to the left by L_FRAME:                 *
+   *     speech[], wsp[] and  exc[]                   *
+   *--------------------------------------------------*/
+
+  Copy(&state->old_speech[L_FRAME], &state->old_speech[0], L_TOTAL-L_FRAME);
+  Copy(&state->old_wsp[L_FRAME], &state->old_wsp[0], PIT_MAX);
+  Copy(&state->old_exc[L_FRAME], &state->old_exc[0], PIT_MAX+L_INTERPOL);
+}
+
+/* cod_ld8a.c: Coder_ld8a() */
+void
+g729_coder_frame (
+     G729EncState *state,
+     Word16 ana[],       /* output  : Analysis parameters */
+     Word16 frame,       /* input   : frame counter       */
+     Word16 vad_enable,  /* input   : VAD enable flag     */
+     int complexity      /* input   : search complexity   */
+)
+{
+  G729CoderFrame f;
+
+  if (!g729_coder_frame_lpc(state, &f, ana, frame, vad_enable))
+    return;
+
+  g729_coder_frame_filters(state, &f);
+  g729_coder_frame_search(state, &f, complexity);
+}
@@ -7,9 +7,6 @@ typedef enum {
   G729_SID_FRAME
 } frame_modes_param;
 
-#include "typedef.h"
-#include "ld8a.h"
-
 #define SAMPLE_RATE 8000
 #define FRAME_DURATION 10
 #define RAW_FRAME_SAMPLES (SAMPLE_RATE*FRAME_DURATION/1000)
@@ -17,5 +14,24 @@ typedef enum {
 #define G729_SID_BYTES 2
 #define G729_SILENCE_BYTES 0
 #define RAW_FRAME_BYTES (RAW_FRAME_SAMPLES*2)
+/* look-ahead of the encoder analysis (L_NEXT of the reference code) */
+#define LOOKAHEAD_SAMPLES 40
+
+/* Multi-channel streams (channels > 1) carry, for every 10 ms, a table of
+ * one byte per channel holding the size of its frame (10, 2 or 0 bytes),
+ * followed by the frames themselves in channel order. Mono streams are
+ * plain RFC 3551 payloads. That framing is private to these elements, so
+ * their multi-channel audio/G729 caps must have
+ * layout=(string)g729-sized (G729_LAYOUT_SIZED) and mono caps don't;
+ * G729_CAPS is the audio/G729 template of the elements. */
+#define G729_MAX_CHANNELS 64
+#define G729_LAYOUT_SIZED "g729-sized"
+#define G729_CAPS "audio/G729, "                                        \
+    "rate = (int) 8000, "                                               \
+    "channels = (int) 1; "                                              \
+    "audio/G729, "                                                      \
+    "rate = (int) 8000, "                                               \
+    "channels = (int) [ 2, " G_STRINGIFY (G729_MAX_CHANNELS) " ], "     \
+    "layout = (string) " G729_LAYOUT_SIZED
 
 #endif
@@ -0,0 +1,341 @@
+/* GladSToNe g729 conformance harness
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+/*
+ * Runs the ITU-T test vectors through libg729: the encoder output must
+ * match the reference bitstreams bit by bit, the decoder output the
+ * reference PCM sample by sample.
+ *
+ * Annex A vectors (<name>.in, .bit, .pst) are encoded without VAD,
+ * Annex B vectors (tstseq<n>.bin, tstseq<n>a.bit, tstseq<n>a.out) with
+ * it. Their directories default to those of the reference code package
+ * and can be overridden with G729_VECTORS_A and G729_VECTORS_B.
+ *
+ * Exits with 77 (skipped) when no vector is found, or when G729_DSP asks
+ * for a kernel level this build or CPU doesn't have. See
+ * g729conformance.sh, run by "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+
+#include "g729.h"
+#include "g729common.h"
+
+#ifdef G729_SIMD_KERNELS
+#include "g729dsp.h"
+#endif
+
+/* ITU serial bitstream format, as in the reference code's ld8a.h */
+#define SERIAL_SYNC_WORD 0x6b21
+#define SERIAL_BIT_0 0x007f
+#define SERIAL_BIT_1 0x0081
+#define SERIAL_MAX_BITS 80
+
+#define CONFORMANCE_SKIP 77
+
+typedef struct {
+  const char *name;
+  const char *in;       /* encoder input, missing for decoder only vectors */
+  const char *bit;
+  const char *out;
+  int vad;
+} Vector;
+
+static const Vector vectors_a[] = {
+  { "algthm", "algthm.in", "algthm.bit", "algthm.pst", 0 },
+  { "erasure", "erasure.in", "erasure.bit", "erasure.pst", 0 },
+  { "fixed", "fixed.in", "fixed.bit", "fixed.pst", 0 },
+  { "lsp", "lsp.in", "lsp.bit", "lsp.pst", 0 },
+  { "overflow", "overflow.in", "overflow.bit", "overflow.pst", 0 },
+  { "parity", "parity.in", "parity.bit", "parity.pst", 0 },
+  { "pitch", "pitch.in", "pitch.bit", "pitch.pst", 0 },
+  { "speech", "speech.in", "speech.bit", "speech.pst", 0 },
+  { "tame", "tame.in", "tame.bit", "tame.pst", 0 },
+  { "test", "test.in", "test.bit", "test.pst", 0 },
+};
+
+static const Vector vectors_b[] = {
+  { "tstseq1", "tstseq1.bin", "tstseq1a.bit", "tstseq1a.out", 1 },
+  { "tstseq2", "tstseq2.bin", "tstseq2a.bit", "tstseq2a.out", 1 },
+  { "tstseq3", "tstseq3.bin", "tstseq3a.bit", "tstseq3a.out", 1 },
+  { "tstseq4", "tstseq4.bin", "tstseq4a.bit", "tstseq4a.out", 1 },
+  { "tstseq5", "tstseq5.bin", "tstseq5a.bit", "tstseq5a.out", 1 },
+  { "tstseq6", "tstseq6.bin", "tstseq6a.bit", "tstseq6a.out", 1 },
+};
+
+/* Opens dir/name, trying the upper case name too: the reference package
+ * ships either, depending on the release */
+static FILE *
+conformance_open (const char *dir, const char *name)
+{
+  char path[4096], upper[256];
+  FILE *file;
+  size_t i;
+
+  snprintf (path, sizeof (path), "%s/%s", dir, name);
+  file = fopen (path, "rb");
+  if (file)
+    return file;
+
+  for (i = 0; name[i] && i < sizeof (upper) - 1; i++)
+    upper[i] = toupper ((unsigned char) name[i]);
+  upper[i] = '\0';
+
+  snprintf (path, sizeof (path), "%s/%s", dir, upper);
+  return fopen (path, "rb");
+}
+
+/* The vector files are little endian 16 bit words */
+static int
+conformance_read_words (FILE * file, int16_t * words, int n)
+{
+  uint8_t bytes[2 * (SERIAL_MAX_BITS + 2)];
+  int i;
+
+  if (fread (bytes, 2, n, file) != (size_t) n)
+    return -1;
+
+  for (i = 0; i < n; i++)
+    words[i] = (int16_t) (bytes[2 * i] | (bytes[2 * i + 1] << 8));
+
+  return 0;
+}
+
+/* Reads one serial frame, packing its bits MSB first as RFC 3551 does.
+ * Returns the frame size in bytes, -1 at the end of the file; erased is
+ * set if any bit is marked as lost. */
+static int
+conformance_read_frame (FILE * file, uint8_t * frame, int *erased)
+{
+  int16_t header[2], bits[SERIAL_MAX_BITS];
+  int i, n_bits;
+
+  if (conformance_read_words (file, header, 2) < 0)
+    return -1;
+
+  n_bits = header[1];
+  if (n_bits < 0 || n_bits > SERIAL_MAX_BITS)
+    return -1;
+  if (n_bits && conformance_read_words (file, bits, n_bits) < 0)
+    return -1;
+
+  *erased = header[0] != SERIAL_SYNC_WORD;
+  memset (frame, 0, G729_SPEECH_FRAME_SIZE);
+  for (i = 0; i < n_bits; i++) {
+    if (bits[i] == SERIAL_BIT_1)
+      frame[i / 8] |= 0x80 >> (i % 8);
+    else if (bits[i] != SERIAL_BIT_0)
+      *erased = 1;
+  }
+
+  return (n_bits + 7) / 8;
+}
+
+static int
+conformance_encode (const char *dir, const Vector * v)
+{
+  G729Encoder *encoder;
+  FILE *in, *bit;
+  int16_t pcm[G729_FRAME_SAMPLES];
+  uint8_t ours[G729_SPEECH_FRAME_SIZE], ref[G729_SPEECH_FRAME_SIZE];
+  int size, ref_size, erased, frame = 0, ret = 0;
+
+  in = conformance_open (dir, v->in);
+  bit = conformance_open (dir, v->bit);
+  encoder = g729_encoder_new (v->vad);
+  if (!in || !bit || !encoder) {
+    fprintf (stderr, "FAIL %s: can't open the encoder vectors\n", v->name);
+    ret = -1;
+    goto done;
+  }
+
+  while (conformance_read_words (in, pcm, G729_FRAME_SAMPLES) == 0) {
+    size = g729_encoder_encode (encoder, pcm, ours);
+    ref_size = conformance_read_frame (bit, ref, &erased);
+
+    if (size != ref_size || memcmp (ours, ref, size) != 0) {
+      fprintf (stderr, "FAIL %s: encoder differs at frame %d\n", v->name,
+          frame);
+      ret = -1;
+      goto done;
+    }
+    frame++;
+  }
+
+  printf ("PASS %s: encoder, %d frames\n", v->name, frame);
+
+done:
+  if (encoder)
+    g729_encoder_free (encoder);
+  if (bit)
+    fclose (bit);
+  if (in)
+    fclose (in);
+
+  return ret;
+}
+
+static int
+conformance_decode (const char *dir, const Vector * v)
+{
+  G729Decoder *decoder;
+  FILE *bit, *out;
+  int16_t ours[G729_FRAME_SAMPLES], ref[G729_FRAME_SAMPLES];
+  uint8_t data[G729_SPEECH_FRAME_SIZE];
+  int size, erased, i, frame = 0, ret = 0;
+
+  bit = conformance_open (dir, v->bit);
+  out = conformance_open (dir, v->out);
+  decoder = g729_decoder_new ();
+  if (!bit || !out || !decoder) {
+    fprintf (stderr, "FAIL %s: can't open the decoder vectors\n", v->name);
+    ret = -1;
+    goto done;
+  }
+
+  while ((size = conformance_read_frame (bit, data, &erased)) >= 0) {
+    if (erased)
+      g729_decoder_conceal (decoder, ours);
+    else
+      g729_decoder_decode (decoder, data, size, ours);
+
+    if (conformance_read_words (out, ref, G729_FRAME_SAMPLES) < 0) {
+      fprintf (stderr, "FAIL %s: decoder output too long\n", v->name);
+      ret = -1;
+      goto done;
+    }
+
+    for (i = 0; i < G729_FRAME_SAMPLES; i++) {
+      if (ours[i] != ref[i]) {
+        fprintf (stderr, "FAIL %s: decoder differs at frame %d, sample %d\n",
+            v->name, frame, i);
+        ret = -1;
+        goto done;
+      }
+    }
+    frame++;
+  }
+
+  printf ("PASS %s: decoder, %d frames\n", v->name, frame);
+
+done:
+  if (decoder)
+    g729_decoder_free (decoder);
+  if (out)
+    fclose (out);
+  if (bit)
+    fclose (bit);
+
+  return ret;
+}
+
+/* Runs the vectors of dir that are there; returns the number of failures
+ * or -1 if none was found */
+static int
+conformance_run (const char *dir, const Vector * vectors, int n)
+{
+  FILE *file;
+  int i, found = 0, failed = 0;
+
+  for (i = 0; i < n; i++) {
+    file = conformance_open (dir, vectors[i].bit);
+    if (!file)
+      continue;
+    fclose (file);
+    found++;
+
+    file = conformance_open (dir, vectors[i].in);
+    if (file) {
+      fclose (file);
+      if (conformance_encode (dir, &vectors[i]) < 0)
+        failed++;
+    }
+    if (conformance_decode (dir, &vectors[i]) < 0)
+      failed++;
+  }
+
+  return found ? failed : -1;
+}
+
+int
+main (int argc, char **argv)
+{
+  const char *dsp = getenv ("G729_DSP");
+  const char *dir_a, *dir_b;
+  int failed_a, failed_b;
+
+  /* a level this build or CPU lacks would silently test another one */
+  if (dsp) {
+#ifdef G729_SIMD_KERNELS
+    if (strcmp (g729_dsp_get ()->name, dsp) != 0)
+      return CONFORMANCE_SKIP;
+#else
+    if (strcmp (dsp, "c") != 0)
+      return CONFORMANCE_SKIP;
+#endif
+  }
+
+  dir_a = getenv ("G729_VECTORS_A") ? getenv ("G729_VECTORS_A") :
+      G729_VECTORS_A;
+  dir_b = getenv ("G729_VECTORS_B") ? getenv ("G729_VECTORS_B") :
+      G729_VECTORS_B;
+
+  printf ("G729_DSP=%s\n", dsp ? dsp : "default");
+
+  failed_a = conformance_run (dir_a, vectors_a,
+      sizeof (vectors_a) / sizeof (vectors_a[0]));
+  failed_b = conformance_run (dir_b, vectors_b,
+      sizeof (vectors_b) / sizeof (vectors_b[0]));
+
+  if (failed_a < 0 && failed_b < 0) {
+    fprintf (stderr, "no test vectors in %s or %s\n", dir_a, dir_b);
+    return CONFORMANCE_SKIP;
+  }
+
+  return (failed_a > 0 || failed_b > 0) ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+#!/bin/sh
+# Runs the ITU test vectors through every kernel level (G729_DSP) of this
+# build. g729conformance skips (77) the levels the build or the CPU lack.
+# The --enable-simd-kernels build time variant is covered by running
+# "make check" in both configurations.
+
+status=77
+
+for dsp in c sse4.1 avx2 neon; do
+  G729_DSP=$dsp ./g729conformance$EXEEXT
+  case $? in
+    0)
+      if [ $status = 77 ]; then status=0; fi ;;
+    77)
+      echo "G729_DSP=$dsp: skipped" ;;
+    *)
+      status=1 ;;
+  esac
+done
+
+exit $status
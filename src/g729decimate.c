@@ -0,0 +1,245 @@
+/* GladSToNe g729 input decimator
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+#include "g729decimate.h"
+#include "g729common.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* portable vectors: SSE on x86-64, NEON on aarch64 */
+typedef float g729_v4sf __attribute__ ((vector_size (16)));
+
+/* taps per unit of decimation factor for the 3.4-4.6 kHz transition at
+ * about 70 dB of stopband attenuation */
+#define TAPS_PER_FACTOR 30
+#define KAISER_BETA 6.76
+#define MAX_TAPS (TAPS_PER_FACTOR * G729_DECIMATOR_MAX_FACTOR - 1)
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+struct _G729Decimator {
+  unsigned int factor;
+  unsigned int channels;
+  unsigned int taps;        /* of the filter, odd */
+  unsigned int n_coeffs;    /* taps padded to a multiple of 8 */
+  float *coeffs;            /* reversed, oldest sample first */
+  unsigned int length;      /* floats of history per channel */
+  float *history;           /* n_coeffs - 1 past samples, then the block */
+};
+
+static double
+g729_decimator_bessel_i0 (double x)
+{
+  double sum = 1.0, term = 1.0;
+  int k;
+
+  for (k = 1; k < 50; k++) {
+    term *= (x / (2 * k)) * (x / (2 * k));
+    sum += term;
+    if (term < sum * 1e-12)
+      break;
+  }
+
+  return sum;
+}
+
+/* Low-pass at 4 kHz, Kaiser windowed, unity gain at DC. The zero padding
+ * goes to the oldest end, so it doesn't change the delay. */
+static void
+g729_decimator_design (G729Decimator * decimator)
+{
+  double cutoff = 0.5 / decimator->factor;
+  double centre = (decimator->taps - 1) / 2.0;
+  double sum = 0.0, t, w, h[MAX_TAPS];
+  unsigned int k, pad;
+
+  for (k = 0; k < decimator->taps; k++) {
+    t = k - centre;
+    h[k] = t == 0.0 ? 2 * cutoff : sin (2 * M_PI * cutoff * t) / (M_PI * t);
+    if (decimator->taps > 1) {
+      w = 2.0 * k / (decimator->taps - 1) - 1.0;
+      h[k] *= g729_decimator_bessel_i0 (KAISER_BETA * sqrt (1.0 - w * w)) /
+          g729_decimator_bessel_i0 (KAISER_BETA);
+    }
+    sum += h[k];
+  }
+
+  pad = decimator->n_coeffs - decimator->taps;
+  for (k = 0; k < decimator->taps; k++)
+    decimator->coeffs[pad + k] = h[decimator->taps - 1 - k] / sum;
+}
+
+G729Decimator *
+g729_decimator_new (unsigned int factor, unsigned int channels)
+{
+  G729Decimator *decimator;
+
+  if (factor < 1 || factor > G729_DECIMATOR_MAX_FACTOR)
+    return NULL;
+
+  decimator = calloc (1, sizeof (G729Decimator));
+  if (!decimator)
+    return NULL;
+
+  decimator->factor = factor;
+  decimator->channels = channels;
+  decimator->taps = factor > 1 ? TAPS_PER_FACTOR * factor - 1 : 1;
+  decimator->n_coeffs = (decimator->taps + 7) & ~7;
+  decimator->length = decimator->n_coeffs - 1 + RAW_FRAME_SAMPLES * factor;
+
+  decimator->coeffs = calloc (decimator->n_coeffs, sizeof (float));
+  decimator->history = calloc (decimator->length * channels, sizeof (float));
+  if (!decimator->coeffs || !decimator->history) {
+    g729_decimator_free (decimator);
+    return NULL;
+  }
+
+  g729_decimator_design (decimator);
+
+  return decimator;
+}
+
+void
+g729_decimator_reset (G729Decimator * decimator)
+{
+  memset (decimator->history, 0,
+      decimator->length * decimator->channels * sizeof (float));
+}
+
+void
+g729_decimator_free (G729Decimator * decimator)
+{
+  if (!decimator)
+    return;
+
+  free (decimator->coeffs);
+  free (decimator->history);
+  free (decimator);
+}
+
+unsigned int
+g729_decimator_get_delay (const G729Decimator * decimator)
+{
+  return (decimator->taps - 1) / 2;
+}
+
+/* n is a multiple of 8; two accumulators hide the add latency */
+static inline float
+g729_decimator_dot (const float * coeffs, const float * x, unsigned int n)
+{
+  g729_v4sf acc0 = { 0, }, acc1 = { 0, }, c0, c1, x0, x1;
+  unsigned int k;
+
+  for (k = 0; k < n; k += 8) {
+    memcpy (&c0, coeffs + k, sizeof (c0));
+    memcpy (&c1, coeffs + k + 4, sizeof (c1));
+    memcpy (&x0, x + k, sizeof (x0));
+    memcpy (&x1, x + k + 4, sizeof (x1));
+    acc0 += c0 * x0;
+    acc1 += c1 * x1;
+  }
+
+  acc0 += acc1;
+  return acc0[0] + acc0[1] + acc0[2] + acc0[3];
+}
+
+/* Filters the block already in the history of every channel into out,
+ * then keeps the last samples for the next block */
+static void
+g729_decimator_run (G729Decimator * decimator, int16_t * out)
+{
+  unsigned int ch, n;
+  float *x, y;
+
+  for (ch = 0; ch < decimator->channels; ch++) {
+    x = decimator->history + ch * decimator->length;
+
+    for (n = 0; n < RAW_FRAME_SAMPLES; n++) {
+      y = g729_decimator_dot (decimator->coeffs, x + n * decimator->factor,
+          decimator->n_coeffs);
+      y = rintf (y);
+      out[n * decimator->channels + ch] =
+          y > 32767.0f ? 32767 : (y < -32768.0f ? -32768 : (int16_t) y);
+    }
+
+    memmove (x, x + RAW_FRAME_SAMPLES * decimator->factor,
+        (decimator->n_coeffs - 1) * sizeof (float));
+  }
+}
+
+void
+g729_decimator_process_s16 (G729Decimator * decimator, const int16_t * in,
+    int16_t * out)
+{
+  unsigned int ch, i, n = RAW_FRAME_SAMPLES * decimator->factor;
+  float *x;
+
+  for (ch = 0; ch < decimator->channels; ch++) {
+    x = decimator->history + ch * decimator->length + decimator->n_coeffs - 1;
+    for (i = 0; i < n; i++)
+      x[i] = in[i * decimator->channels + ch];
+  }
+
+  g729_decimator_run (decimator, out);
+}
+
+void
+g729_decimator_process_f32 (G729Decimator * decimator, const float * in,
+    int16_t * out)
+{
+  unsigned int ch, i, n = RAW_FRAME_SAMPLES * decimator->factor;
+  float *x;
+
+  for (ch = 0; ch < decimator->channels; ch++) {
+    x = decimator->history + ch * decimator->length + decimator->n_coeffs - 1;
+    for (i = 0; i < n; i++)
+      x[i] = in[i * decimator->channels + ch] * 32768.0f;
+  }
+
+  g729_decimator_run (decimator, out);
+}
@@ -0,0 +1,84 @@
+/* GladSToNe g729 input decimator
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+#ifndef __G729_DECIMATE_H__
+#define __G729_DECIMATE_H__
+
+#include <stdint.h>
+
+/*
+ * Fixed-ratio anti-alias decimation of interleaved 16, 32 or 48 kHz input
+ * (S16 or F32) to the 8 kHz S16 the codec takes, one 10 ms block at a
+ * time. Only the kept output samples are computed, each as one dot
+ * product of the reversed filter with the input history, on 4-wide float
+ * vectors.
+ *
+ * The filter is a Kaiser windowed sinc passing up to 3.4 kHz and stopping
+ * from 4.6 kHz: what it lets alias lands above the telephone band. Each
+ * decimator keeps the history of its own channels. A factor of 1 only
+ * converts F32 input.
+ */
+
+typedef struct _G729Decimator G729Decimator;
+
+/* 48 kHz input */
+#define G729_DECIMATOR_MAX_FACTOR 6
+
+/* Returns NULL on allocation failure, or when factor isn't between 1 and
+ * G729_DECIMATOR_MAX_FACTOR */
+G729Decimator *g729_decimator_new (unsigned int factor, unsigned int channels);
+void g729_decimator_reset (G729Decimator *decimator);
+void g729_decimator_free (G729Decimator *decimator);
+
+/* Group delay, in input samples */
+unsigned int g729_decimator_get_delay (const G729Decimator *decimator);
+
+/* Decimates factor * G729_FRAME_SAMPLES interleaved input frames into
+ * G729_FRAME_SAMPLES interleaved frames of out */
+void g729_decimator_process_s16 (G729Decimator *decimator, const int16_t *in,
+    int16_t *out);
+void g729_decimator_process_f32 (G729Decimator *decimator, const float *in,
+    int16_t *out);
+
+#endif /* __G729_DECIMATE_H__ */
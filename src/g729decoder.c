@@ -0,0 +1,425 @@
+/* GladSToNe g729 decoder
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+/*
+ * The stateful part of the reference decoder (dec_ld8a.c, lspdec.c and
+ * dec_gain.c), operating on a G729DecState instead of file scope
+ * variables. The code follows the reference line by line, so that the
+ * output stays bit-exact.
+ */
+
+#include "g729state.h"
+
+/* ref code includes: */
+#include "basic_op.h"
+#include "tab_ld8a.h"
+
+/* lspdec.c: Lsp_iqua_cs() */
+static void
+g729_lsp_iqua_cs (
+  G729DecState *state,
+  Word16 prm[],          /* (i)     : indexes of the selected LSP */
+  Word16 lsp_q[],        /* (o) Q13 : Quantized LSP parameters    */
+  Word16 erase           /* (i)     : frame erase information     */
+)
+{
+  Word16 mode_index;
+  Word16 code0;
+  Word16 code1;
+  Word16 code2;
+  Word16 buf[M];     /* Q13 */
+
+  if( erase==0 ) {  /* Not frame erasure */
+    mode_index = shr(prm[0] ,NC0_B) & (Word16)1;
+    code0 = prm[0] & (Word16)(NC0 - 1);
+    code1 = shr(prm[1] ,NC1_B) & (Word16)(NC1 - 1);
+    code2 = prm[1] & (Word16)(NC1 - 1);
+
+    /* compose quantized LSP (lsp_q) from indexes */
+
+    Lsp_get_quant(lspcb1, lspcb2, code0, code1, code2,
+      fg[mode_index], state->freq_prev, lsp_q, fg_sum[mode_index]);
+
+    /* save parameters to use in case of the frame erased situation */
+
+    Copy(lsp_q, state->prev_lsp, M);
+    state->prev_ma = mode_index;
+  }
+  else {           /* Frame erased */
+    /* use revious LSP */
+
+    Copy(state->prev_lsp, lsp_q, M);
+
+    /* update freq_prev */
+
+    Lsp_prev_extract(state->prev_lsp, buf,
+      fg[state->prev_ma], state->freq_prev, fg_sum_inv[state->prev_ma]);
+    Lsp_prev_update(buf, state->freq_prev);
+  }
+}
+
+/* lspdec.c: D_lsp() */
+static void
+g729_lsp_decode (
+  G729DecState *state,
+  Word16 prm[],          /* (i)     : indexes of the selected LSP */
+  Word16 lsp_q[],        /* (o) Q15 : Quantized LSP parameters    */
+  Word16 erase           /* (i)     : frame erase information     */
+)
+{
+  Word16 lsf_q[M];       /* domain 0.0<= lsf_q <PI in Q13 */
+
+  g729_lsp_iqua_cs(state, prm, lsf_q, erase);
+
+  /* Convert LSFs to LSPs */
+  Lsf_lsp2(lsf_q, lsp_q, M);
+}
+
+/* dec_gain.c: Dec_gain() */
+static void
+g729_gain_decode (
+   Word16 past_qua_en[],/* (i/o) Q10 :Past quantized energies.     */
+   Word16 index,        /* (i)     :Index of quantization.         */
+   Word16 code[],       /* (i) Q13 :Innovative vector.             */
+   Word16 L_subfr,      /* (i)     :Subframe length.               */
+   Word16 bfi,          /* (i)     :Bad frame indicator            */
+   Word16 *gain_pit,    /* (o) Q14 :Pitch gain.                    */
+   Word16 *gain_cod     /* (o) Q1  :Code gain.                     */
+)
+{
+   Word16  index1, index2, tmp;
+   Word16  gcode0, exp_gcode0;
+   Word32  L_gbk12, L_acc, L_accb;
+
+   /*-------------- Case of erasure. ---------------*/
+
+   if(bfi != 0){
+      *gain_pit = mult( *gain_pit, 29491 );      /* *0.9 in Q15 */
+      if (sub( *gain_pit, 29491) > 0) *gain_pit = 29491;
+      *gain_cod = mult( *gain_cod, 32111 );      /* *0.98 in Q15 */
+
+     /*----------------------------------------------*
+      * update table of past quantized energies      *
+      *                              (frame erasure) *
+      *----------------------------------------------*/
+      Gain_update_erasure(past_qua_en);
+
+      return;
+   }
+
+   /*-------------- Decode pitch gain ---------------*/
+
+   index1 = imap1[ shr(index,NCODE2_B) ] ;
+   index2 = imap2[ index & (NCODE2-1) ] ;
+   *gain_pit = add( gbk1[index1][0], gbk2[index2][0] );
+
+   /*-------------- Decode codebook gain ---------------*/
+
+  /*---------------------------------------------------*
+   *-  energy due to innovation                       -*
+   *-  predicted energy                               -*
+   *-  predicted codebook gain => gcode0[exp_gcode0]  -*
+   *---------------------------------------------------*/
+
+   Gain_predict( past_qua_en, code, L_subfr, &gcode0, &exp_gcode0 );
+
+  /*-----------------------------------------------------------------*
+   * *gain_code = (gbk1[indice1][1]+gbk2[indice2][1]) * gcode0;      *
+   *-----------------------------------------------------------------*/
+
+   L_acc = L_deposit_l( gbk1[index1][1] );
+   L_accb = L_deposit_l( gbk2[index2][1] );
+   L_gbk12 = L_add( L_acc, L_accb );                       /* Q13 */
+   tmp = extract_l( L_shr( L_gbk12,1 ) );                  /* Q12 */
+   L_acc = L_mult(tmp, gcode0);             /* Q[exp_gcode0+12+1] */
+
+   L_acc = L_shl(L_acc, add( negate(exp_gcode0),(-12-1+1+16) ));
+   *gain_cod = extract_h( L_acc );                          /* Q1 */
+
+  /*----------------------------------------------*
+   * update table of past quantized energies      *
+   *----------------------------------------------*/
+   Gain_update( past_qua_en, L_gbk12 );
+}
+
+/* Synthesis of one subframe, scaling the excitation down on overflow */
+static void
+g729_synthesise (G729DecState * state, Word16 * Az, Word16 i_subfr,
+    Word16 synth[])
+{
+  Word16 *exc = state->exc;
+  Word16 i;
+
+  Overflow = 0;
+  Syn_filt(Az, &exc[i_subfr], &synth[i_subfr], L_SUBFR, state->mem_syn, 0);
+  if(Overflow != 0)
+    {
+      /* In case of overflow in the synthesis          */
+      /* -> Scale down vector exc[] and redo synthesis */
+
+      for(i=0; i<PIT_MAX+L_INTERPOL+L_FRAME; i++)
+        state->old_exc[i] = shr(state->old_exc[i], 2);
+
+      Syn_filt(Az, &exc[i_subfr], &synth[i_subfr], L_SUBFR, state->mem_syn,
+          1);
+    }
+  else
+    Copy(&synth[i_subfr+L_SUBFR-M], state->mem_syn, M);
+}
+
+/* dec_ld8a.c: Decod_ld8a() */
+void
+g729_decod_frame (
+  G729DecState *state,
+  Word16  parm[],      /* (i)   : vector of synthesis parameters
+                                  parm[0] = bad frame indicator (bfi)  */
+  Word16  synth[],     /* (o)   : synthesis speech                     */
+  Word16  A_t[],       /* (o)   : decoded LP filter in 2 subframes     */
+  Word16  *T2,         /* (o)   : decoded pitch lag in 2 subframes     */
+  Word16  *Vad         /* (o)   : frame type                           */
+)
+{
+  Word16  *exc = state->exc;
+  Word16  *Az;                  /* Pointer on A_t   */
+  Word16  lsp_new[M];           /* LSPs             */
+  Word16  code[L_SUBFR];        /* ACELP codevector */
+
+  /* Scalars */
+
+  Word16  i, j, i_subfr;
+  Word16  T0, T0_frac, index;
+  Word16  bfi;
+  Word32  L_temp;
+
+  Word16 bad_pitch;             /* bad pitch indicator */
+
+  /* for G.729B */
+  Word16 ftyp;
+
+  /* Test bad frame indicator (bfi) */
+
+  bfi = *parm++;
+  /* for G.729B */
+  ftyp = *parm;
+
+  if(bfi == 1) {
+    if(state->past_ftyp == 1) {
+      ftyp = 1;
+      parm[4] = 1;    /* G.729 maintenance */
+    }
+    else ftyp = 0;
+    *parm = ftyp;  /* modification introduced in version V1.3 */
+  }
+
+  *Vad = ftyp;
+
+  /* Processing non active frames (SID & not transmitted) */
+  if(ftyp != 1) {
+
+    g729_cng_decode(state, state->past_ftyp, state->sid_sav,
+        state->sh_sid_sav, parm, exc, A_t);
+
+    Az = A_t;
+    for (i_subfr = 0; i_subfr < L_FRAME; i_subfr += L_SUBFR) {
+      g729_synthesise(state, Az, i_subfr, synth);
+
+      Az += MP1;
+
+      *T2++ = state->old_T0;
+    }
+    state->sharp = SHARPMIN;
+
+  }
+  /* Processing active frame */
+  else {
+
+    state->seed = INIT_SEED;
+    parm++;
+
+    /* Decode the LSPs; there is no channel protection, so no bad LSF
+     * indication other than the frame erasure */
+
+    g729_lsp_decode(state, parm, lsp_new, bfi);
+    parm += 2;
+
+    /* Interpolation of LPC for the 2 subframes */
+
+    Int_qlpc(state->lsp_old, lsp_new, A_t);
+
+    /* update the LSFs for the next frame */
+
+    Copy(lsp_new, state->lsp_old, M);
+
+/*------------------------------------------------------------------------*
+ *          Loop for every subframe in the analysis frame                 *
+ *------------------------------------------------------------------------*
+ * The subframe size is L_SUBFR and the loop is repeated L_FRAME/L_SUBFR  *
+ *  times                                                                 *
+ *     - decode the pitch delay                                           *
+ *     - decode algebraic code                                            *
+ *     - decode pitch and codebook gains                                  *
+ *     - find the excitation and compute synthesis speech                 *
+ *------------------------------------------------------------------------*/
+
+    Az = A_t;            /* pointer to interpolated LPC parameters */
+
+    for (i_subfr = 0; i_subfr < L_FRAME; i_subfr += L_SUBFR)
+      {
+
+        index = *parm++;        /* pitch index */
+
+        if(i_subfr == 0)
+          {
+            i = *parm++;        /* get parity check result */
+            bad_pitch = add(bfi, i);
+          }
+        else                    /* second subframe */
+          {
+            bad_pitch = bfi;
+          }
+
+        if( bad_pitch == 0)
+          {
+            Dec_lag3(index, PIT_MIN, PIT_MAX, i_subfr, &T0, &T0_frac);
+            state->old_T0 = T0;
+          }
+        else                /* Bad frame, or parity error */
+          {
+            T0  =  state->old_T0;
+            T0_frac = 0;
+            state->old_T0 = add( state->old_T0, 1);
+            if( sub(state->old_T0, PIT_MAX) > 0) {
+              state->old_T0 = PIT_MAX;
+            }
+          }
+        *T2++ = T0;
+
+        /*-------------------------------------------------*
+         * - Find the adaptive codebook vector.            *
+         *-------------------------------------------------*/
+
+        Pred_lt_3(&exc[i_subfr], T0, T0_frac, L_SUBFR);
+
+        /*-------------------------------------------------------*
+         * - Decode innovative codebook.                         *
+         * - Add the fixed-gain pitch contribution to code[].    *
+         *-------------------------------------------------------*/
+
+        if(bfi != 0)        /* Bad frame */
+          {
+
+            parm[0] = Random(&state->seed_fer) & (Word16)0x1fff; /* 13 bits random */
+            parm[1] = Random(&state->seed_fer) & (Word16)0x000f; /*  4 bits random */
+          }
+        Decod_ACELP(parm[1], parm[0], code);
+        parm +=2;
+
+        j = shl(state->sharp, 1);   /* From Q14 to Q15 */
+        if(sub(T0, L_SUBFR) <0 ) {
+          for (i = T0; i < L_SUBFR; i++) {
+            code[i] = add(code[i], mult(code[i-T0], j));
+          }
+        }
+
+        /*-------------------------------------------------*
+         * - Decode pitch and codebook gains.              *
+         *-------------------------------------------------*/
+
+        index = *parm++;      /* index of energy VQ */
+
+        g729_gain_decode(state->past_qua_en, index, code, L_SUBFR, bfi,
+            &state->gain_pitch, &state->gain_code);
+
+        /*-------------------------------------------------------------*
+         * - Update pitch sharpening "sharp" with quantized gain_pitch *
+         *-------------------------------------------------------------*/
+
+        state->sharp = state->gain_pitch;
+        if (sub(state->sharp, SHARPMAX) > 0) { state->sharp = SHARPMAX;  }
+        if (sub(state->sharp, SHARPMIN) < 0) { state->sharp = SHARPMIN;  }
+
+        /*-------------------------------------------------------*
+         * - Find the total excitation.                          *
+         * - Find synthesis speech corresponding to exc[].       *
+         *-------------------------------------------------------*/
+
+        for (i = 0; i < L_SUBFR;  i++)
+          {
+            /* exc[i] = gain_pitch*exc[i] + gain_code*code[i]; */
+            /* exc[i]  in Q0   gain_pitch in Q14               */
+            /* code[i] in Q13  gain_codeode in Q1              */
+
+            L_temp = L_mult(exc[i+i_subfr], state->gain_pitch);
+            L_temp = L_mac(L_temp, code[i], state->gain_code);
+            L_temp = L_shl(L_temp, 1);
+            exc[i+i_subfr] = round(L_temp);
+          }
+
+        g729_synthesise(state, Az, i_subfr, synth);
+
+        Az += MP1;    /* interpolated LPC parameters for next subframe */
+      }
+  }
+
+  /*------------*
+   *  For G729b
+   *-----------*/
+  if(bfi == 0) {
+    L_temp = 0L;
+    for(i=0; i<L_FRAME; i++) {
+      L_temp = L_mac(L_temp, exc[i], exc[i]);
+    } /* may overflow => last level of SID quantizer */
+    state->sh_sid_sav = norm_l(L_temp);
+    state->sid_sav = round(L_shl(L_temp, state->sh_sid_sav));
+    state->sh_sid_sav = sub(16, state->sh_sid_sav);
+  }
+  state->past_ftyp = ftyp;
+
+  /*--------------------------------------------------*
+   * Update signal for next frame.                    *
+   * -> shift to the left by L_FRAME  exc[]           *
+   *--------------------------------------------------*/
+
+  Copy(&state->old_exc[L_FRAME], &state->old_exc[0], PIT_MAX+L_INTERPOL);
+}
@@ -0,0 +1,300 @@
+/* GladSToNe g729 DSP kernels
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "g729dsp.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define G729_DSP_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || (defined(__ARM_NEON) && defined(__arm__))
+#define G729_DSP_ARM_NEON 1
+#include <arm_neon.h>
+#endif
+
+static int64_t
+g729_dsp_dot_c (const int16_t * x, const int16_t * y, int n)
+{
+  int64_t sum = 0;
+  int i;
+
+  for (i = 0; i < n; i++)
+    sum += (int32_t) x[i] * y[i];
+
+  return sum;
+}
+
+static void
+g729_dsp_mac_c (int32_t * acc, int16_t x, const int16_t * y, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    acc[i] = (int32_t) ((uint32_t) acc[i] + (uint32_t) x * (uint32_t) y[i]);
+}
+
+#ifdef G729_DSP_X86
+/* pmaddwd sums two products per 32 bit lane, which is exact but for the
+ * lanes where both pairs are -32768 * -32768: 2^31 wraps to -2^31. Every
+ * exact lane value is in [-2^31 + 2^16, 2^31], so adding 2^31 - 2^16
+ * (modulo 2^32) gives the exact value plus the bias as an unsigned 32 bit
+ * number, which is zero extended and unbiased once at the end. */
+#define G729_DSP_MADD_BIAS 2147418112
+
+__attribute__ ((target ("sse4.1")))
+static int64_t
+g729_dsp_dot_sse41 (const int16_t * x, const int16_t * y, int n)
+{
+  const __m128i bias = _mm_set1_epi32 (G729_DSP_MADD_BIAS);
+  __m128i acc = _mm_setzero_si128 ();
+  int64_t sum;
+  int64_t lanes[2];
+  int i;
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    __m128i p = _mm_madd_epi16 (_mm_loadu_si128 ((const __m128i *) (x + i)),
+        _mm_loadu_si128 ((const __m128i *) (y + i)));
+
+    p = _mm_add_epi32 (p, bias);
+    acc = _mm_add_epi64 (acc, _mm_cvtepu32_epi64 (p));
+    acc = _mm_add_epi64 (acc, _mm_cvtepu32_epi64 (_mm_srli_si128 (p, 8)));
+  }
+
+  _mm_storeu_si128 ((__m128i *) lanes, acc);
+  sum = lanes[0] + lanes[1] - (int64_t) G729_DSP_MADD_BIAS * (i / 2);
+
+  for (; i < n; i++)
+    sum += (int32_t) x[i] * y[i];
+
+  return sum;
+}
+
+__attribute__ ((target ("avx2")))
+static int64_t
+g729_dsp_dot_avx2 (const int16_t * x, const int16_t * y, int n)
+{
+  const __m256i bias = _mm256_set1_epi32 (G729_DSP_MADD_BIAS);
+  __m256i acc = _mm256_setzero_si256 ();
+  int64_t sum;
+  int64_t lanes[4];
+  int i;
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    __m256i p = _mm256_madd_epi16 (
+        _mm256_loadu_si256 ((const __m256i *) (x + i)),
+        _mm256_loadu_si256 ((const __m256i *) (y + i)));
+
+    p = _mm256_add_epi32 (p, bias);
+    acc = _mm256_add_epi64 (acc,
+        _mm256_cvtepu32_epi64 (_mm256_castsi256_si128 (p)));
+    acc = _mm256_add_epi64 (acc,
+        _mm256_cvtepu32_epi64 (_mm256_extracti128_si256 (p, 1)));
+  }
+
+  _mm256_storeu_si256 ((__m256i *) lanes, acc);
+  sum = lanes[0] + lanes[1] + lanes[2] + lanes[3]
+      - (int64_t) G729_DSP_MADD_BIAS * (i / 2);
+
+  for (; i + 8 <= n; i += 8) {
+    __m128i p = _mm_madd_epi16 (_mm_loadu_si128 ((const __m128i *) (x + i)),
+        _mm_loadu_si128 ((const __m128i *) (y + i)));
+    uint32_t pairs[4];
+
+    _mm_storeu_si128 ((__m128i *) pairs,
+        _mm_add_epi32 (p, _mm_set1_epi32 (G729_DSP_MADD_BIAS)));
+    sum += (int64_t) pairs[0] + pairs[1] + pairs[2] + pairs[3]
+        - 4 * (int64_t) G729_DSP_MADD_BIAS;
+  }
+
+  for (; i < n; i++)
+    sum += (int32_t) x[i] * y[i];
+
+  return sum;
+}
+
+__attribute__ ((target ("sse4.1")))
+static void
+g729_dsp_mac_sse41 (int32_t * acc, int16_t x, const int16_t * y, int n)
+{
+  const __m128i xv = _mm_set1_epi32 (x);
+  int i;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    __m128i p = _mm_mullo_epi32 (xv,
+        _mm_cvtepi16_epi32 (_mm_loadl_epi64 ((const __m128i *) (y + i))));
+
+    _mm_storeu_si128 ((__m128i *) (acc + i),
+        _mm_add_epi32 (_mm_loadu_si128 ((const __m128i *) (acc + i)), p));
+  }
+
+  g729_dsp_mac_c (acc + i, x, y + i, n - i);
+}
+
+__attribute__ ((target ("avx2")))
+static void
+g729_dsp_mac_avx2 (int32_t * acc, int16_t x, const int16_t * y, int n)
+{
+  const __m256i xv = _mm256_set1_epi32 (x);
+  int i;
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    __m256i p = _mm256_mullo_epi32 (xv,
+        _mm256_cvtepi16_epi32 (_mm_loadu_si128 ((const __m128i *) (y + i))));
+
+    _mm256_storeu_si256 ((__m256i *) (acc + i),
+        _mm256_add_epi32 (_mm256_loadu_si256 ((const __m256i *) (acc + i)),
+            p));
+  }
+
+  g729_dsp_mac_sse41 (acc + i, x, y + i, n - i);
+}
+#endif
+
+#ifdef G729_DSP_ARM_NEON
+static int64_t
+g729_dsp_dot_neon (const int16_t * x, const int16_t * y, int n)
+{
+  int64x2_t acc = vdupq_n_s64 (0);
+  int64_t sum;
+  int i;
+
+  for (i = 0; i + 4 <= n; i += 4)
+    acc = vpadalq_s32 (acc, vmull_s16 (vld1_s16 (x + i), vld1_s16 (y + i)));
+
+  sum = vgetq_lane_s64 (acc, 0) + vgetq_lane_s64 (acc, 1);
+
+  for (; i < n; i++)
+    sum += (int32_t) x[i] * y[i];
+
+  return sum;
+}
+
+static void
+g729_dsp_mac_neon (int32_t * acc, int16_t x, const int16_t * y, int n)
+{
+  int i;
+
+  for (i = 0; i + 4 <= n; i += 4)
+    vst1q_s32 (acc + i, vmlal_n_s16 (vld1q_s32 (acc + i), vld1_s16 (y + i), x));
+
+  g729_dsp_mac_c (acc + i, x, y + i, n - i);
+}
+#endif
+
+static const G729Dsp dsp_c = { G729_DSP_C, "c", g729_dsp_dot_c,
+  g729_dsp_mac_c
+};
+#ifdef G729_DSP_X86
+static const G729Dsp dsp_sse41 = { G729_DSP_SSE41, "sse4.1",
+  g729_dsp_dot_sse41, g729_dsp_mac_sse41
+};
+static const G729Dsp dsp_avx2 = { G729_DSP_AVX2, "avx2", g729_dsp_dot_avx2,
+  g729_dsp_mac_avx2
+};
+#endif
+#ifdef G729_DSP_ARM_NEON
+static const G729Dsp dsp_neon = { G729_DSP_NEON, "neon", g729_dsp_dot_neon,
+  g729_dsp_mac_neon
+};
+#endif
+
+static const G729Dsp *dsp_default = &dsp_c;
+static pthread_once_t dsp_once = PTHREAD_ONCE_INIT;
+
+const G729Dsp *
+g729_dsp_get_level (G729DspLevel level)
+{
+  switch (level) {
+    case G729_DSP_C:
+      return &dsp_c;
+#ifdef G729_DSP_X86
+    case G729_DSP_SSE41:
+      return __builtin_cpu_supports ("sse4.1") ? &dsp_sse41 : NULL;
+    case G729_DSP_AVX2:
+      return __builtin_cpu_supports ("avx2") ? &dsp_avx2 : NULL;
+#endif
+#ifdef G729_DSP_ARM_NEON
+    case G729_DSP_NEON:
+      return &dsp_neon;
+#endif
+    default:
+      return NULL;
+  }
+}
+
+static void
+g729_dsp_init (void)
+{
+  static const G729DspLevel levels[] = {
+    G729_DSP_AVX2, G729_DSP_SSE41, G729_DSP_NEON, G729_DSP_C
+  };
+  const char *env = getenv ("G729_DSP");
+  const G729Dsp *dsp;
+  unsigned int i;
+
+#ifdef G729_DSP_X86
+  __builtin_cpu_init ();
+#endif
+
+  for (i = 0; i < sizeof (levels) / sizeof (levels[0]); i++) {
+    dsp = g729_dsp_get_level (levels[i]);
+    if (!dsp)
+      continue;
+
+    if (!env || strcmp (env, dsp->name) == 0) {
+      dsp_default = dsp;
+      return;
+    }
+  }
+}
+
+const G729Dsp *
+g729_dsp_get (void)
+{
+  pthread_once (&dsp_once, g729_dsp_init);
+
+  return dsp_default;
+}
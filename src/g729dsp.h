@@ -0,0 +1,84 @@
+/* GladSToNe g729 DSP kernels
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef __G729_DSP_H__
+#define __G729_DSP_H__
+
+#include <stdint.h>
+
+/*
+ * Vectorised building blocks for the reference code hot loops. The
+ * results are exact (64 bit), callers are responsible for proving that
+ * the saturating L_mac() chain they replace can't saturate.
+ */
+
+typedef enum {
+  G729_DSP_C,
+  G729_DSP_SSE41,
+  G729_DSP_AVX2,
+  G729_DSP_NEON
+} G729DspLevel;
+
+/* sum of x[i] * y[i] for 0 <= i < n */
+typedef int64_t (*G729DspDotFunc) (const int16_t *x, const int16_t *y, int n);
+
+/* acc[i] += x * y[i] for 0 <= i < n, modulo 2^32 */
+typedef void (*G729DspMacFunc) (int32_t *acc, int16_t x, const int16_t *y,
+    int n);
+
+typedef struct {
+  G729DspLevel level;
+  const char *name;
+
+  G729DspDotFunc dot;
+  G729DspMacFunc mac;
+} G729Dsp;
+
+/* Best implementation for this CPU, or the one named by the G729_DSP
+ * environment variable (c, sse4.1, avx2, neon) if it's supported */
+const G729Dsp *g729_dsp_get (void);
+
+/* NULL if level isn't supported by this build or CPU */
+const G729Dsp *g729_dsp_get_level (G729DspLevel level);
+
+#endif /* __G729_DSP_H__ */
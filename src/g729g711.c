@@ -0,0 +1,201 @@
+/* GladSToNe g729 G.711 companding
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+#include "g729g711.h"
+
+static int16_t ulaw_expand[256];
+static int16_t alaw_expand[256];
+
+/* indexed by the sample without the bits each law drops */
+static uint8_t ulaw_compress[1 << 14];
+static uint8_t alaw_compress[1 << 13];
+
+static const int16_t ulaw_seg_end[8] = {
+  0x3f, 0x7f, 0xff, 0x1ff, 0x3ff, 0x7ff, 0xfff, 0x1fff
+};
+
+static const int16_t alaw_seg_end[8] = {
+  0x1f, 0x3f, 0x7f, 0xff, 0x1ff, 0x3ff, 0x7ff, 0xfff
+};
+
+static int
+g729_g711_segment (int value, const int16_t * seg_end)
+{
+  int seg;
+
+  for (seg = 0; seg < 8; seg++) {
+    if (value <= seg_end[seg])
+      break;
+  }
+
+  return seg;
+}
+
+/* value is the 14 bit sample */
+static uint8_t
+g729_g711_ulaw_from_linear (int value)
+{
+  int mask, seg;
+
+  if (value < 0) {
+    value = -value;
+    mask = 0x7f;
+  } else {
+    mask = 0xff;
+  }
+  if (value > 8159)
+    value = 8159;
+  value += 0x84 >> 2;
+
+  seg = g729_g711_segment (value, ulaw_seg_end);
+  if (seg >= 8)
+    return 0x7f ^ mask;
+
+  return ((seg << 4) | ((value >> (seg + 1)) & 0xf)) ^ mask;
+}
+
+/* value is the 13 bit sample */
+static uint8_t
+g729_g711_alaw_from_linear (int value)
+{
+  int mask, seg, aval;
+
+  if (value >= 0) {
+    mask = 0xd5;
+  } else {
+    mask = 0x55;
+    value = -value - 1;
+  }
+
+  seg = g729_g711_segment (value, alaw_seg_end);
+  if (seg >= 8)
+    return 0x7f ^ mask;
+
+  aval = seg << 4;
+  if (seg < 2)
+    aval |= (value >> 1) & 0xf;
+  else
+    aval |= (value >> seg) & 0xf;
+
+  return aval ^ mask;
+}
+
+static int16_t
+g729_g711_ulaw_to_linear (uint8_t uval)
+{
+  int t;
+
+  uval = ~uval;
+  t = ((uval & 0xf) << 3) + 0x84;
+  t <<= (uval & 0x70) >> 4;
+
+  return (uval & 0x80) ? (0x84 - t) : (t - 0x84);
+}
+
+static int16_t
+g729_g711_alaw_to_linear (uint8_t aval)
+{
+  int t, seg;
+
+  aval ^= 0x55;
+  t = (aval & 0xf) << 4;
+  seg = (aval & 0x70) >> 4;
+  switch (seg) {
+    case 0:
+      t += 8;
+      break;
+    case 1:
+      t += 0x108;
+      break;
+    default:
+      t += 0x108;
+      t <<= seg - 1;
+      break;
+  }
+
+  return (aval & 0x80) ? t : -t;
+}
+
+void
+g729_g711_init (void)
+{
+  int i;
+
+  for (i = 0; i < 256; i++) {
+    ulaw_expand[i] = g729_g711_ulaw_to_linear (i);
+    alaw_expand[i] = g729_g711_alaw_to_linear (i);
+  }
+
+  /* the index is the unsigned view of the shifted sample */
+  for (i = -(1 << 13); i < (1 << 13); i++)
+    ulaw_compress[i & ((1 << 14) - 1)] = g729_g711_ulaw_from_linear (i);
+  for (i = -(1 << 12); i < (1 << 12); i++)
+    alaw_compress[i & ((1 << 13) - 1)] = g729_g711_alaw_from_linear (i);
+}
+
+void
+g729_g711_expand (G729G711Law law, const uint8_t * in, int16_t * out,
+    unsigned int n)
+{
+  const int16_t *table = law == G729_G711_ULAW ? ulaw_expand : alaw_expand;
+  unsigned int i;
+
+  for (i = 0; i < n; i++)
+    out[i] = table[in[i]];
+}
+
+void
+g729_g711_compress (G729G711Law law, const int16_t * in, uint8_t * out,
+    unsigned int stride, unsigned int n)
+{
+  unsigned int i;
+
+  if (law == G729_G711_ULAW) {
+    for (i = 0; i < n; i++)
+      out[i * stride] = ulaw_compress[(uint16_t) in[i] >> 2];
+  } else {
+    for (i = 0; i < n; i++)
+      out[i * stride] = alaw_compress[(uint16_t) in[i] >> 3];
+  }
+}
@@ -0,0 +1,75 @@
+/* GladSToNe g729 G.711 companding
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+#ifndef __G729_G711_H__
+#define __G729_G711_H__
+
+#include <stdint.h>
+
+/*
+ * G.711 companding through lookup tables, for the elements taking or
+ * producing audio/x-mulaw and audio/x-alaw directly. The tables give the
+ * same results as the ITU-T G.711 reference (and GStreamer's mulaw/alaw
+ * elements): 14 bit µ-law, 13 bit A-law.
+ */
+
+typedef enum {
+  G729_G711_NONE,           /* linear 16 bit */
+  G729_G711_ULAW,
+  G729_G711_ALAW,
+} G729G711Law;
+
+/* Builds the tables; must be called once before anything else */
+void g729_g711_init (void);
+
+/* Expands n samples */
+void g729_g711_expand (G729G711Law law, const uint8_t *in, int16_t *out,
+    unsigned int n);
+
+/* Compresses n samples into every stride-th byte of out, which interleaves
+ * a channel on the way */
+void g729_g711_compress (G729G711Law law, const int16_t *in, uint8_t *out,
+    unsigned int stride, unsigned int n);
+
+#endif /* __G729_G711_H__ */
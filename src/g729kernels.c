@@ -0,0 +1,446 @@
+/* GladSToNe g729 vectorised reference code functions
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/*
+ * Vectorised versions of reference code functions, called by the encoder
+ * in place of the originals (g729kernels.h). Each one reproduces its
+ * reference function bit by bit, including the Overflow flag, and falls
+ * back to it when the exactness of the vector path can't be guaranteed or
+ * when the C level is selected (G729_DSP=c).
+ *
+ * Cor_h() is static in acelp_ca.c, so the algebraic codebook search is
+ * ported in g729search.c, which runs its correlation chains through
+ * g729_kernels_cor_h_diagonals(). The depth-first search itself
+ * (D4i40_17_fast()) has no kernel: it is a sequence of data dependent 16
+ * bit saturating updates over a few candidates at a time, with no long
+ * dot product to share.
+ */
+
+#include "g729kernels.h"
+#include "g729dsp.h"
+
+#include <string.h>
+
+/* ref code includes: */
+#include "typedef.h"
+#include "basic_op.h"
+#include "ld8a.h"
+#include "oper_32b.h"
+#include "tab_ld8a.h"
+
+/* lpc.c */
+void
+g729_kernels_autocorr (
+  Word16 x[],      /* (i)    : Input signal                      */
+  Word16 m,        /* (i)    : LPC order                         */
+  Word16 r_h[],    /* (o)    : Autocorrelations  (msb)           */
+  Word16 r_l[],    /* (o)    : Autocorrelations  (lsb)           */
+  Word16 *exp_R0   /* (o)    : scaling of r[0] (for the VAD)     */
+)
+{
+  const G729Dsp *dsp = g729_dsp_get ();
+  Word16 i, norm;
+  Word16 y[L_WINDOW];
+  Word32 sum;
+  int64_t r0;
+
+  if (dsp->level == G729_DSP_C) {
+    Autocorr (x, m, r_h, r_l, exp_R0);
+    return;
+  }
+
+  /* Windowing of signal; |y[i]| < 32768 so L_mult() never saturates */
+
+  for(i=0; i<L_WINDOW; i++)
+  {
+    y[i] = mult_r(x[i], hamwindow[i]);
+  }
+
+  /* Compute r[0] and test for overflow. All the terms are positive, so
+   * the L_mac() chain saturates exactly when the plain sum exceeds MAX_32 */
+
+  *exp_R0 = 1;
+  for (;;) {
+    r0 = 1 + 2 * dsp->dot (y, y, L_WINDOW);
+    if (r0 <= MAX_32)
+      break;
+
+    /* If overflow divide y[] by 4 */
+
+    for(i=0; i<L_WINDOW; i++)
+    {
+      y[i] = shr(y[i], 2);
+    }
+    *exp_R0 = add((*exp_R0), 4);
+  }
+  Overflow = 0;
+
+  /* Normalization of r[0] */
+
+  sum  = (Word32) r0;
+  norm = norm_l(sum);
+  sum  = L_shl(sum, norm);
+  L_Extract(sum, &r_h[0], &r_l[0]);  /* Put in DPF format (see oper_32b) */
+  *exp_R0 = sub(*exp_R0, norm);
+
+  /* r[1] to r[m], bounded by r[0] (Cauchy-Schwarz): exact as well */
+
+  for (i = 1; i <= m; i++)
+  {
+    sum = (Word32) (2 * dsp->dot (y, &y[i], L_WINDOW-i));
+
+    sum = L_shl(sum, norm);
+    L_Extract(sum, &r_h[i], &r_l[i]);
+  }
+}
+
+/* cor_func.c */
+void
+g729_kernels_cor_h_x (
+     Word16 h[],        /* (i) Q12 :Impulse response of filters      */
+     Word16 X[],        /* (i) Q12 :Target vector                    */
+     Word16 D[]         /* (o)     :Correlations between h[] and D[] */
+                        /*          Normalized to 13 bits            */
+)
+{
+  const G729Dsp *dsp = g729_dsp_get ();
+  Word16 i, j;
+  Word32 s, max, L_temp;
+  Word32 y32[L_SUBFR];
+  double bound;
+
+  if (dsp->level == G729_DSP_C) {
+    Cor_h_X (h, X, D);
+    return;
+  }
+
+  /* Every partial sum of the reference L_mac() chains is 2 * a dot
+   * product of sub-vectors of X[] and h[], so by Cauchy-Schwarz none can
+   * saturate if 2 * |X| * |h| < MAX_32. The margin covers the rounding of
+   * the double precision test. */
+  bound = 4.0 * (double) dsp->dot (X, X, L_SUBFR)
+      * (double) dsp->dot (h, h, L_SUBFR);
+  if (bound >= 0.999 * (double) MAX_32 * (double) MAX_32) {
+    Cor_h_X (h, X, D);
+    return;
+  }
+
+  /* first keep the result on 32 bits and find absolute maximum */
+
+  max = 0;
+
+  for (i = 0; i < L_SUBFR; i++)
+  {
+    s = (Word32) (2 * dsp->dot (&X[i], h, L_SUBFR-i));
+
+    y32[i] = s;
+
+    s = L_abs(s);
+    L_temp =L_sub(s,max);
+    if(L_temp>0L) {
+       max = s;
+    }
+  }
+
+  /* Find the number of right shifts to do on y32[]  */
+  /* so that maximum is on 13 bits                   */
+
+  j = norm_l(max);
+  if( sub(j,16) > 0) {
+   j = 16;
+  }
+
+  j = sub(18, j);
+
+  for(i=0; i<L_SUBFR; i++) {
+    D[i] = extract_l( L_shr(y32[i], j) );
+  }
+}
+
+/* acelp_ca.c: the Cor_h() chains, all the diagonals at once */
+int
+g729_kernels_cor_h_diagonals (
+  const Word16 h[],                /* (i)  :scaled impulse response      */
+  Word16 cor[L_SUBFR][L_SUBFR]     /* (o)  :chains at every term and lag */
+)
+{
+  const G729Dsp *dsp = g729_dsp_get ();
+  int32_t acc[L_SUBFR];
+  int m, d;
+
+  if (dsp->level == G729_DSP_C)
+    return 0;
+
+  /* Every partial sum of the chains is 2 * a dot product of sub-vectors
+   * of h[], so by Cauchy-Schwarz none can saturate if 2 * |h|^2 doesn't */
+  if (2 * dsp->dot (h, h, L_SUBFR) > MAX_32)
+    return 0;
+
+  /* acc[d] follows the chain at lag d, one term of every chain per step */
+  memset (acc, 0, sizeof (acc));
+  for (m = 0; m < L_SUBFR; m++) {
+    dsp->mac (acc, h[m], &h[m], L_SUBFR - m);
+
+    for (d = 0; d < L_SUBFR - m; d++)
+      cor[m][d] = (Word16) (acc[d] >> 15);        /* extract_h (2 * acc) */
+  }
+
+  return 1;
+}
+
+/* Normalised maximum of a pitch_a.c section: max / sqrt(energy) */
+static Word16
+g729_kernels_ol_norm (Word32 max, Word32 energy)
+{
+  Word16 max_h, max_l, ener_h, ener_l;
+  Word32 sum;
+
+  sum = Inv_sqrt(energy);            /* 1/sqrt(energy),    result in Q30 */
+  L_Extract(max, &max_h, &max_l);
+  L_Extract(sum, &ener_h, &ener_l);
+  sum  = Mpy_32(max_h, max_l, ener_h, ener_l);
+
+  return extract_l(sum);
+}
+
+/* scal_sig[-PIT_MAX..L_FRAME-1] of Pitch_ol_fast() split by parity:
+ * scal_sig[2m] is even[OFF+m] (even[0] is unused) and scal_sig[2m+1] is
+ * odd[OFF+m], so that its sums over every other sample become contiguous
+ * dot products */
+#define G729_KERNELS_OL_OFF ((PIT_MAX + 1) / 2)
+#define G729_KERNELS_OL_LEN (G729_KERNELS_OL_OFF + L_FRAME / 2)
+
+typedef struct {
+  const G729Dsp *dsp;
+  Word16 even[G729_KERNELS_OL_LEN];
+  Word16 odd[G729_KERNELS_OL_LEN];
+  int n;                        /* L_frame / 2 */
+} G729KernelsOl;
+
+/* scal_sig[j-t] for the even j from 0 */
+static inline const Word16 *
+g729_kernels_ol_delayed (const G729KernelsOl * ol, int t)
+{
+  if (t & 1)
+    return &ol->odd[G729_KERNELS_OL_OFF - (t + 1) / 2];
+
+  return &ol->even[G729_KERNELS_OL_OFF - t / 2];
+}
+
+/* L_mac() chain of the correlation at lag t */
+static inline Word32
+g729_kernels_ol_corr (const G729KernelsOl * ol, int t)
+{
+  return (Word32) (2 * ol->dsp->dot (&ol->even[G729_KERNELS_OL_OFF],
+          g729_kernels_ol_delayed (ol, t), ol->n));
+}
+
+/* L_mac() chain of the energy at lag t, from 1 */
+static inline Word32
+g729_kernels_ol_energy (const G729KernelsOl * ol, int t)
+{
+  const Word16 *p = g729_kernels_ol_delayed (ol, t);
+
+  return (Word32) (1 + 2 * ol->dsp->dot (p, p, ol->n));
+}
+
+/* pitch_a.c */
+Word16
+g729_kernels_pitch_ol_fast (
+  Word16 signal[],     /* input : signal used to compute the open loop pitch */
+                       /*     signal[-pit_max] to signal[-1] should be known */
+  Word16 pit_max,      /* input : maximum pitch lag                          */
+  Word16 L_frame       /* input : length of frame to compute pitch           */
+)
+{
+  G729KernelsOl ol;
+  Word16  i, j;
+  Word16  max1, max2, max3;
+  Word16  T1, T2, T3;
+  Word32  max, sum, L_temp;
+  Word16  scal;
+  int64_t e;
+
+  ol.dsp = g729_dsp_get ();
+  ol.n = L_frame / 2;
+
+  /* the encoder only calls it on whole frames */
+  if (ol.dsp->level == G729_DSP_C || pit_max != PIT_MAX || L_frame != L_FRAME)
+    return Pitch_ol_fast (signal, pit_max, L_frame);
+
+  /*--------------------------------------------------------*
+   *  Verification for risk of overflow: the terms are      *
+   *  positive, so the L_mac() chain saturates exactly when *
+   *  the plain sum exceeds MAX_32.                         *
+   *--------------------------------------------------------*/
+
+  e = 0;
+  for(i= -pit_max; i< L_frame; i+=2)
+    e += (int32_t) signal[i] * signal[i];
+  e *= 2;
+
+  /*--------------------------------------------------------*
+   * Scaling of input signal, with the reference operators. *
+   *--------------------------------------------------------*/
+
+  for(i=-pit_max; i<L_frame; i++)
+  {
+    if (e > MAX_32)
+      scal = shr(signal[i], 3);
+    else if (e < (Word32)1048576L)  /* if (sum < 2^20) */
+      scal = shl(signal[i], 3);
+    else
+      scal = signal[i];
+
+    if (i & 1)
+      ol.odd[G729_KERNELS_OL_OFF + (i - 1) / 2] = scal;
+    else
+      ol.even[G729_KERNELS_OL_OFF + i / 2] = scal;
+  }
+
+  /* Every sum below, correlations and energies, takes the samples of one
+   * parity on each side, so by Cauchy-Schwarz none of the L_mac() chains
+   * can saturate if the energy of both parities is below MAX_32 / 2.
+   * Otherwise leave it to the reference. */
+  e = ol.dsp->dot (&ol.even[1], &ol.even[1], G729_KERNELS_OL_LEN - 1);
+  if (1 + 2 * e > MAX_32)
+    return Pitch_ol_fast (signal, pit_max, L_frame);
+  e = ol.dsp->dot (ol.odd, ol.odd, G729_KERNELS_OL_LEN);
+  if (1 + 2 * e > MAX_32)
+    return Pitch_ol_fast (signal, pit_max, L_frame);
+
+  /* First section */
+
+  max = MIN_32;
+  T1  = 20;    /* Only to remove warning from some compilers */
+  for (i = 20; i < 40; i++) {
+    sum = g729_kernels_ol_corr (&ol, i);
+    L_temp = L_sub(sum, max);
+    if (L_temp > 0) { max = sum; T1 = i;   }
+  }
+
+  /* max1 = max/sqrt(energy)                  */
+  /* This result will always be on 16 bits !! */
+
+  max1 = g729_kernels_ol_norm (max, g729_kernels_ol_energy (&ol, T1));
+
+  /* Second section */
+
+  max = MIN_32;
+  T2  = 40;    /* Only to remove warning from some compilers */
+  for (i = 40; i < 80; i++) {
+    sum = g729_kernels_ol_corr (&ol, i);
+    L_temp = L_sub(sum, max);
+    if (L_temp > 0) { max = sum; T2 = i;   }
+  }
+
+  max2 = g729_kernels_ol_norm (max, g729_kernels_ol_energy (&ol, T2));
+
+  /* Third section */
+
+  max = MIN_32;
+  T3  = 80;    /* Only to remove warning from some compilers */
+  for (i = 80; i < 143; i+=2) {
+    sum = g729_kernels_ol_corr (&ol, i);
+    L_temp = L_sub(sum, max);
+    if (L_temp > 0) { max = sum; T3 = i;   }
+  }
+
+  /* Test around max3 */
+
+  i = T3;
+  sum = g729_kernels_ol_corr (&ol, i+1);
+  L_temp = L_sub(sum, max);
+  if (L_temp > 0) { max = sum; T3 = i+(Word16)1;   }
+
+  sum = g729_kernels_ol_corr (&ol, i-1);
+  L_temp = L_sub(sum, max);
+  if (L_temp > 0) { max = sum; T3 = i-(Word16)1;   }
+
+  max3 = g729_kernels_ol_norm (max, g729_kernels_ol_energy (&ol, T3));
+
+  /*-----------------------*
+   * Test for multiple.    *
+   *-----------------------*/
+
+  /* if( abs(T2*2 - T3) < 5)  */
+  /*    max2 += max3 * 0.25;  */
+
+  i = sub(shl(T2,1), T3);
+  j = sub(abs_s(i), 5);
+  if(j < 0)
+    max2 = add(max2, shr(max3, 2));
+
+  /* if( abs(T2*3 - T3) < 7)  */
+  /*    max2 += max3 * 0.25;  */
+
+  i = add(i, T2);
+  j = sub(abs_s(i), 7);
+  if(j < 0)
+    max2 = add(max2, shr(max3, 2));
+
+  /* if( abs(T1*2 - T2) < 5)  */
+  /*    max1 += max2 * 0.20;  */
+
+  i = sub(shl(T1,1), T2);
+  j = sub(abs_s(i), 5);
+  if(j < 0)
+    max1 = add(max1, mult(max2, 6554));
+
+  /* if( abs(T1*3 - T2) < 7)  */
+  /*    max1 += max2 * 0.20;  */
+
+  i = add(i, T1);
+  j = sub(abs_s(i), 7);
+  if(j < 0)
+    max1 = add(max1, mult(max2, 6554));
+
+  /*--------------------------------------------------------------------*
+   * Compare the 3 sections maximum.                                    *
+   *--------------------------------------------------------------------*/
+
+  if( sub(max1, max2) < 0 ) {max1 = max2; T1 = T2;  }
+  if( sub(max1, max3) <0 )  {T1 = T3; }
+
+  return T1;
+}
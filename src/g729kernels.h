@@ -0,0 +1,86 @@
+/* GladSToNe g729 SIMD kernels
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef __G729_KERNELS_H__
+#define __G729_KERNELS_H__
+
+/*
+ * Vectorised reference code functions (g729kernels.c), called directly by
+ * the encoder in place of the reference ones. Without the SIMD kernels
+ * they are the reference functions themselves.
+ */
+
+/* ref code includes: */
+#include "typedef.h"
+#include "ld8a.h"
+
+#ifdef G729_SIMD_KERNELS
+
+/* lpc.c: Autocorr() */
+void g729_kernels_autocorr (Word16 x[], Word16 m, Word16 r_h[], Word16 r_l[],
+    Word16 *exp_R0);
+
+/* cor_func.c: Cor_h_X() */
+void g729_kernels_cor_h_x (Word16 h[], Word16 X[], Word16 D[]);
+
+/* pitch_a.c: Pitch_ol_fast() */
+Word16 g729_kernels_pitch_ol_fast (Word16 signal[], Word16 pit_max,
+    Word16 L_frame);
+
+/* acelp_ca.c: the L_mac() chains of Cor_h() along the diagonals of h[]
+ * (see g729search.c): cor[m][d] is extract_h() of the chain at lag d after
+ * its terms 0 to m, for d < L_SUBFR - m. Returns 0 without touching cor if
+ * it can't reproduce the reference chains exactly. */
+int g729_kernels_cor_h_diagonals (const Word16 h[],
+    Word16 cor[L_SUBFR][L_SUBFR]);
+
+#else
+
+#define g729_kernels_autocorr Autocorr
+#define g729_kernels_cor_h_x Cor_h_X
+#define g729_kernels_pitch_ol_fast Pitch_ol_fast
+#define g729_kernels_cor_h_diagonals(h, cor) 0
+
+#endif
+
+#endif /* __G729_KERNELS_H__ */
@@ -0,0 +1,327 @@
+/* GladSToNe g729 lane-parallel encoder filters
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/*
+ * The filter stages of the encoder that only depend on the input and on
+ * the LPC coefficients of the frame, run for several encoders at once by
+ * g729_encoder_encode_interleaved(): the high-pass pre-processing of
+ * pre_proc.c, and the residual, weighting and impulse response filters
+ * of Coder_ld8a() (g729_coder_frame_filters()). The searches that follow
+ * take data dependent branches and run encoder by encoder.
+ *
+ * Encoders go by groups of G729_LANES. Their filter memories and signals
+ * are laid out channel-major, sample by sample with one lane per encoder,
+ * so that the inner loops run across the lanes with no dependency
+ * between them and compile to vector code. The reference operators are
+ * reproduced exactly in 64 bit arithmetic, with the saturations written
+ * as clamps rather than branches. Overflow is set per encoder in
+ * G729CoderFrame when any of its filters saturates; like that of the
+ * pre-processing, it's cleared by the searches before they read it.
+ */
+
+#include "g729state.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/* ref code includes: */
+#include "basic_op.h"
+#include "tab_ld8a.h"
+
+#define G729_LANES 8
+
+/* the reference operators, on one lane */
+
+static inline int64_t
+g729_lanes_sat (int64_t L_var)
+{
+  return L_var > MAX_32 ? MAX_32 : L_var < MIN_32 ? MIN_32 : L_var;
+}
+
+/* L_mult() */
+static inline int64_t
+g729_lanes_mult (int32_t var1, int32_t var2)
+{
+  return g729_lanes_sat (2 * (int64_t) var1 * var2);
+}
+
+/* mult() */
+static inline int32_t
+g729_lanes_mult16 (int32_t var1, int32_t var2)
+{
+  int32_t p = (var1 * var2) >> 15;
+
+  return p > MAX_16 ? MAX_16 : p;
+}
+
+/* round() */
+static inline Word16
+g729_lanes_round (int64_t L_var)
+{
+  return (Word16) (g729_lanes_sat (L_var + 0x8000) >> 16);
+}
+
+/* pre_proc.c: Pre_Process() on new_speech of every encoder */
+void
+g729_lanes_pre_process (G729EncState ** states, unsigned int n,
+    const Word16 * pcm, unsigned int stride)
+{
+  int32_t y1_hi[G729_LANES], y1_lo[G729_LANES];
+  int32_t y2_hi[G729_LANES], y2_lo[G729_LANES];
+  int32_t x0[G729_LANES], x1[G729_LANES], x2;
+  Word16 out[L_FRAME][G729_LANES];
+  int64_t L_tmp;
+  unsigned int base, m, c;
+  int i;
+
+  for (base = 0; base < n; base += G729_LANES) {
+    m = n - base < G729_LANES ? n - base : G729_LANES;
+
+    /* unused lanes filter silence */
+    memset (out, 0, sizeof (out));
+    for (c = 0; c < G729_LANES; c++) {
+      G729HighPassState *st =
+          c < m ? &states[base + c]->pre_process : NULL;
+
+      y1_hi[c] = st ? st->y1_hi : 0;
+      y1_lo[c] = st ? st->y1_lo : 0;
+      y2_hi[c] = st ? st->y2_hi : 0;
+      y2_lo[c] = st ? st->y2_lo : 0;
+      x0[c] = st ? st->x0 : 0;
+      x1[c] = st ? st->x1 : 0;
+    }
+
+    for (i = 0; i < L_FRAME; i++) {
+      for (c = 0; c < m; c++)
+        out[i][c] = pcm[i * stride + base + c];
+
+      for (c = 0; c < G729_LANES; c++) {
+        x2 = x1[c];
+        x1[c] = x0[c];
+        x0[c] = out[i][c];
+
+        /* Mpy_32_16() of y[i-1] and y[i-2], then the L_mac() chain */
+        L_tmp = g729_lanes_sat (g729_lanes_mult (y1_hi[c], a140[1])
+            + 2 * g729_lanes_mult16 (y1_lo[c], a140[1]));
+        L_tmp = g729_lanes_sat (L_tmp
+            + g729_lanes_sat (g729_lanes_mult (y2_hi[c], a140[2])
+                + 2 * g729_lanes_mult16 (y2_lo[c], a140[2])));
+        L_tmp = g729_lanes_sat (L_tmp + g729_lanes_mult (x0[c], b140[0]));
+        L_tmp = g729_lanes_sat (L_tmp + g729_lanes_mult (x1[c], b140[1]));
+        L_tmp = g729_lanes_sat (L_tmp + g729_lanes_mult (x2, b140[2]));
+        L_tmp = g729_lanes_sat (L_tmp * 8);     /* L_shl (L_tmp, 3) */
+        out[i][c] = g729_lanes_round (L_tmp);
+
+        /* L_Extract() */
+        y2_hi[c] = y1_hi[c];
+        y2_lo[c] = y1_lo[c];
+        y1_hi[c] = (int32_t) (L_tmp >> 16);
+        y1_lo[c] = (int32_t) ((L_tmp >> 1) - ((int64_t) y1_hi[c] << 15));
+      }
+    }
+
+    for (c = 0; c < m; c++) {
+      G729EncState *state = states[base + c];
+
+      for (i = 0; i < L_FRAME; i++)
+        state->new_speech[i] = out[i][c];
+
+      state->pre_process.y1_hi = y1_hi[c];
+      state->pre_process.y1_lo = y1_lo[c];
+      state->pre_process.y2_hi = y2_hi[c];
+      state->pre_process.y2_lo = y2_lo[c];
+      state->pre_process.x0 = x0[c];
+      state->pre_process.x1 = x1[c];
+    }
+  }
+}
+
+/* L_add() of a lane, setting its flag on saturation */
+static inline int64_t
+g729_lanes_sat_flag (int64_t L_var, int32_t * overflow)
+{
+  *overflow |= L_var > MAX_32 || L_var < MIN_32;
+
+  return g729_lanes_sat (L_var);
+}
+
+/* filter.c: Residu() of lg samples of every lane; x holds M samples of
+ * history before its first one. A saturation sets the lane's flag. */
+static void
+g729_lanes_residu (Word16 a[MP1][G729_LANES],
+    Word16 x[][G729_LANES], Word16 y[][G729_LANES], int lg,
+    int32_t overflow[G729_LANES])
+{
+  int64_t s[G729_LANES];
+  int i, j, c;
+
+  for (i = 0; i < lg; i++) {
+    for (c = 0; c < G729_LANES; c++)
+      s[c] = g729_lanes_sat_flag (2 * (int64_t) x[M + i][c] * a[0][c],
+          &overflow[c]);
+    for (j = 1; j <= M; j++)
+      for (c = 0; c < G729_LANES; c++)
+        s[c] = g729_lanes_sat_flag (s[c] + g729_lanes_sat_flag (2 * (int64_t)
+                a[j][c] * x[M + i - j][c], &overflow[c]), &overflow[c]);
+    for (c = 0; c < G729_LANES; c++) {
+      s[c] = g729_lanes_sat_flag (s[c] * 8, &overflow[c]);
+      y[i][c] = (Word16) (g729_lanes_sat_flag (s[c] + 0x8000,
+              &overflow[c]) >> 16);
+    }
+  }
+}
+
+/* filter.c: Syn_filt() of lg samples of every lane into y, which holds the
+ * memory in its M first samples. A saturation sets the lane's flag. */
+static void
+g729_lanes_syn_filt (Word16 a[MP1][G729_LANES],
+    Word16 x[][G729_LANES], Word16 y[][G729_LANES], int lg,
+    int32_t overflow[G729_LANES])
+{
+  int64_t s[G729_LANES];
+  int i, j, c;
+
+  for (i = 0; i < lg; i++) {
+    for (c = 0; c < G729_LANES; c++)
+      s[c] = g729_lanes_sat_flag (2 * (int64_t) x[i][c] * a[0][c],
+          &overflow[c]);
+    for (j = 1; j <= M; j++)
+      for (c = 0; c < G729_LANES; c++)
+        s[c] = g729_lanes_sat_flag (s[c] - g729_lanes_sat_flag (2 * (int64_t)
+                a[j][c] * y[M + i - j][c], &overflow[c]), &overflow[c]);
+    for (c = 0; c < G729_LANES; c++) {
+      s[c] = g729_lanes_sat_flag (s[c] * 8, &overflow[c]);
+      y[M + i][c] = (Word16) (g729_lanes_sat_flag (s[c] + 0x8000,
+              &overflow[c]) >> 16);
+    }
+  }
+}
+
+/* g729_coder_frame_filters() of every frame */
+void
+g729_lanes_coder_filters (G729EncState ** states, G729CoderFrame ** f,
+    unsigned int n)
+{
+  Word16 aq[2][MP1][G729_LANES];        /* quantized A(z)               */
+  Word16 ap1[2][MP1][G729_LANES];       /* weighting filters            */
+  Word16 ap[2][MP1][G729_LANES];        /* A(z/gamma)                   */
+  Word16 speech[M + L_FRAME][G729_LANES];
+  Word16 exc[L_FRAME][G729_LANES];      /* residual                     */
+  Word16 wsp[M + L_FRAME][G729_LANES];  /* mem_w, then wsp[]            */
+  Word16 impulse[L_SUBFR][G729_LANES];
+  Word16 h1[2][M + L_SUBFR][G729_LANES];
+  int32_t overflow[G729_LANES];
+  Word16 Ap1[MP1];
+  unsigned int base, m, c;
+  int i, s;
+
+  memset (impulse, 0, sizeof (impulse));
+  for (c = 0; c < G729_LANES; c++)
+    impulse[0][c] = 4096;
+
+  for (base = 0; base < n; base += G729_LANES) {
+    m = n - base < G729_LANES ? n - base : G729_LANES;
+
+    /* unused lanes filter silence through A(z) = 1 */
+    memset (aq, 0, sizeof (aq));
+    memset (ap1, 0, sizeof (ap1));
+    memset (ap, 0, sizeof (ap));
+    memset (speech, 0, sizeof (speech));
+    memset (wsp, 0, sizeof (wsp));
+    memset (h1, 0, sizeof (h1));
+    memset (overflow, 0, sizeof (overflow));
+
+    for (c = 0; c < m; c++) {
+      G729EncState *state = states[base + c];
+      G729CoderFrame *fr = f[base + c];
+
+      for (s = 0; s < 2; s++) {
+        g729_coder_weight_coeffs (&fr->Ap_t[s * MP1], Ap1);
+        for (i = 0; i < MP1; i++) {
+          aq[s][i][c] = fr->Aq_t[s * MP1 + i];
+          ap[s][i][c] = fr->Ap_t[s * MP1 + i];
+          ap1[s][i][c] = Ap1[i];
+        }
+      }
+      for (i = 0; i < M + L_FRAME; i++)
+        speech[i][c] = state->speech[i - M];
+      for (i = 0; i < M; i++)
+        wsp[i][c] = state->mem_w[i];
+    }
+    for (c = m; c < G729_LANES; c++) {
+      aq[0][0][c] = aq[1][0][c] = 4096;
+      ap[0][0][c] = ap[1][0][c] = 4096;
+      ap1[0][0][c] = ap1[1][0][c] = 4096;
+    }
+
+    /* residual, then weighted speech with mem_w carried over from the
+     * first subframe to the second one as wsp[] */
+    for (s = 0; s < 2; s++) {
+      g729_lanes_residu (aq[s], &speech[s * L_SUBFR], &exc[s * L_SUBFR],
+          L_SUBFR, overflow);
+      g729_lanes_syn_filt (ap1[s], &exc[s * L_SUBFR], &wsp[s * L_SUBFR],
+          L_SUBFR, overflow);
+    }
+
+    /* impulse responses, from zero memories */
+    for (s = 0; s < 2; s++)
+      g729_lanes_syn_filt (ap[s], impulse, h1[s], L_SUBFR, overflow);
+
+    for (c = 0; c < m; c++) {
+      G729EncState *state = states[base + c];
+      G729CoderFrame *fr = f[base + c];
+
+      for (i = 0; i < L_FRAME; i++) {
+        state->exc[i] = exc[i][c];
+        state->wsp[i] = wsp[M + i][c];
+      }
+      for (i = 0; i < M; i++)
+        state->mem_w[i] = wsp[L_FRAME + i][c];
+      for (s = 0; s < 2; s++)
+        for (i = 0; i < L_SUBFR; i++)
+          fr->h1[s][i] = h1[s][M + i][c];
+
+      fr->overflow |= overflow[c];
+    }
+  }
+}
@@ -0,0 +1,240 @@
+/* GladSToNe g729 encoder latency measurement
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/*
+ * Pushes real-time paced PCM through "appsrc ! g729enc ! appsink" and
+ * measures, for every 10 ms frame, the wall clock time between the push
+ * of its PCM and the arrival of the buffer carrying its G729 frame. The
+ * distribution is printed as a JSON object on stdout, together with the
+ * latency the pipeline reports.
+ *
+ * Build with "make g729latency" in src/. Usage:
+ *   g729latency [frames-per-buffer [low-latency [buffers]]]
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/audio/audio.h>
+#include <gst/app/gstappsrc.h>
+#include <gst/app/gstappsink.h>
+
+#include "g729common.h"
+
+#define DEFAULT_BUFFERS 500
+
+#define G729_FRAME_DURATION (FRAME_DURATION * GST_MSECOND)
+
+typedef struct {
+  gint64 *pushed;       /* monotonic time each frame was pushed, in us */
+  gint64 *received;     /* monotonic time its encoded frame came out */
+  guint n_frames;
+} Measure;
+
+static GstFlowReturn
+on_new_sample (GstAppSink * sink, gpointer user_data)
+{
+  Measure *m = user_data;
+  GstSample *sample;
+  GstBuffer *buf;
+  GstClockTime pts, duration;
+  gint64 now = g_get_monotonic_time ();
+  guint i, first, last;
+
+  sample = gst_app_sink_pull_sample (sink);
+  if (!sample)
+    return GST_FLOW_EOS;
+
+  buf = gst_sample_get_buffer (sample);
+  pts = GST_BUFFER_PTS (buf);
+  duration = GST_BUFFER_DURATION (buf);
+
+  if (GST_CLOCK_TIME_IS_VALID (pts) && GST_CLOCK_TIME_IS_VALID (duration)) {
+    first = pts / G729_FRAME_DURATION;
+    last = (pts + duration) / G729_FRAME_DURATION;
+    for (i = first; i < last && i < m->n_frames; i++)
+      m->received[i] = now;
+  }
+
+  gst_sample_unref (sample);
+
+  return GST_FLOW_OK;
+}
+
+static int
+compare_gint64 (const void *a, const void *b)
+{
+  gint64 x = *(const gint64 *) a, y = *(const gint64 *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+int
+main (int argc, char **argv)
+{
+  GstElement *pipeline, *src, *sink;
+  GstAppSinkCallbacks callbacks = { NULL, NULL, on_new_sample, };
+  GstMessage *msg;
+  GstQuery *query;
+  GstClockTime min_latency = 0;
+  gboolean live;
+  Measure m;
+  gint64 start, *latencies;
+  guint frames_per_buffer = 1, buffers = DEFAULT_BUFFERS;
+  gboolean low_latency = FALSE;
+  guint i, j, n;
+  gchar *desc;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    frames_per_buffer = atoi (argv[1]);
+  if (argc > 2)
+    low_latency = atoi (argv[2]) != 0;
+  if (argc > 3)
+    buffers = atoi (argv[3]);
+
+  /* the plugin from this build tree */
+  gst_registry_scan_path (gst_registry_get (), G729_PLUGIN_DIR);
+
+  desc = g_strdup_printf ("appsrc name=src is-live=true format=time "
+      "caps=audio/x-raw,format=%s,rate=%d,channels=1,layout=interleaved ! "
+      "g729enc frames-per-buffer=%u low-latency=%s ! "
+      "appsink name=sink sync=false", GST_AUDIO_NE (S16), SAMPLE_RATE,
+      frames_per_buffer, low_latency ? "true" : "false");
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  if (!pipeline) {
+    fprintf (stderr, "failed to create the pipeline\n");
+    return 1;
+  }
+
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+
+  m.n_frames = buffers;
+  m.pushed = g_new0 (gint64, buffers);
+  m.received = g_new0 (gint64, buffers);
+  gst_app_sink_set_callbacks (GST_APP_SINK (sink), &callbacks, &m, NULL);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  /* one 10 ms buffer every 10 ms, as a capture device would */
+  start = g_get_monotonic_time ();
+  for (i = 0; i < buffers; i++) {
+    GstBuffer *buf;
+    GstMapInfo map;
+    gint16 *pcm;
+    gint64 wait;
+
+    buf = gst_buffer_new_allocate (NULL, RAW_FRAME_BYTES, NULL);
+    gst_buffer_map (buf, &map, GST_MAP_WRITE);
+    pcm = (gint16 *) map.data;
+    for (j = 0; j < RAW_FRAME_SAMPLES; j++) {
+      n = i * RAW_FRAME_SAMPLES + j;
+      pcm[j] = ((n * 37) % 400 - 200) * 20 + ((n * 113) % 160 - 80) * 30;
+    }
+    gst_buffer_unmap (buf, &map);
+
+    GST_BUFFER_PTS (buf) = i * G729_FRAME_DURATION;
+    GST_BUFFER_DURATION (buf) = G729_FRAME_DURATION;
+
+    wait = start + i * FRAME_DURATION * 1000 - g_get_monotonic_time ();
+    if (wait > 0)
+      g_usleep (wait);
+
+    m.pushed[i] = g_get_monotonic_time ();
+    gst_app_src_push_buffer (GST_APP_SRC (src), buf);
+  }
+
+  query = gst_query_new_latency ();
+  if (gst_element_query (pipeline, query))
+    gst_query_parse_latency (query, &live, &min_latency, NULL);
+  gst_query_unref (query);
+
+  gst_app_src_end_of_stream (GST_APP_SRC (src));
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  if (msg)
+    gst_message_unref (msg);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  latencies = g_new (gint64, buffers);
+  for (i = 0, n = 0; i < buffers; i++) {
+    if (m.received[i])
+      latencies[n++] = m.received[i] - m.pushed[i];
+  }
+  qsort (latencies, n, sizeof (gint64), compare_gint64);
+
+  printf ("{\n");
+  printf ("  \"latency\": {\n");
+  printf ("    \"frames_per_buffer\": %u,\n", frames_per_buffer);
+  printf ("    \"low_latency\": %s,\n", low_latency ? "true" : "false");
+  printf ("    \"reported_ms\": %.1f,\n", (double) min_latency / GST_MSECOND);
+  printf ("    \"frames\": %u,\n", n);
+  if (n > 0) {
+    printf ("    \"p50_us\": %" G_GINT64_FORMAT ",\n", latencies[n / 2]);
+    printf ("    \"p90_us\": %" G_GINT64_FORMAT ",\n", latencies[n * 9 / 10]);
+    printf ("    \"p99_us\": %" G_GINT64_FORMAT ",\n", latencies[n * 99 / 100]);
+    printf ("    \"max_us\": %" G_GINT64_FORMAT "\n", latencies[n - 1]);
+  } else {
+    printf ("    \"p50_us\": null\n");
+  }
+  printf ("  }\n");
+  printf ("}\n");
+
+  g_free (latencies);
+  g_free (m.pushed);
+  g_free (m.received);
+  gst_object_unref (src);
+  gst_object_unref (sink);
+  gst_object_unref (pipeline);
+
+  return 0;
+}
@@ -0,0 +1,271 @@
+/* GladSToNe g729 encoder caps negotiation test
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/*
+ * Negotiates g729enc between raw input at every rate and format of its
+ * sink template and an audio/G729 downstream, the way a transcoding
+ * pipeline does:
+ *
+ *   appsrc caps=audio/x-raw,rate=<r>,... ! g729enc ! audio/G729 ! fakesink
+ *
+ * Downstream is fixed at 8000 Hz, which must not be proxied upstream as
+ * the only input rate: the decimator takes the others. Also checks that
+ * the downstream channels still are, and that multi-channel audio/G729
+ * needs layout=g729-sized in the templates of the elements taking or
+ * producing it. Run by "make check".
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/audio/audio.h>
+#include <gst/app/gstappsrc.h>
+
+#include "g729common.h"
+
+#define NEGOTIATION_SKIP 77
+
+/* 30 ms at the input rate, through a pipeline ending in audio/G729 with
+ * the given channels; returns whether it reached EOS without error */
+static gboolean
+run_pipeline (const gchar * format, gint rate, gint channels)
+{
+  GstElement *pipeline, *src;
+  GstBuffer *buf;
+  GstMessage *msg;
+  gsize size;
+  gchar *desc;
+  gboolean ok;
+
+  desc = g_strdup_printf ("appsrc name=src format=time "
+      "caps=audio/x-raw,format=%s,rate=%d,channels=%d,layout=interleaved ! "
+      "g729enc ! audio/G729,channels=%d ! fakesink", format, rate, channels,
+      channels);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  if (!pipeline)
+    return FALSE;
+
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  size = 3 * RAW_FRAME_SAMPLES * (rate / SAMPLE_RATE) * channels *
+      (strcmp (format, GST_AUDIO_NE (F32)) == 0 ? 4 : 2);
+  buf = gst_buffer_new_allocate (NULL, size, NULL);
+  gst_buffer_memset (buf, 0, 0, size);
+  GST_BUFFER_PTS (buf) = 0;
+  GST_BUFFER_DURATION (buf) = 3 * FRAME_DURATION * GST_MSECOND;
+  gst_app_src_push_buffer (GST_APP_SRC (src), buf);
+  gst_app_src_end_of_stream (GST_APP_SRC (src));
+
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      10 * GST_SECOND, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  ok = msg && GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS;
+  if (msg && !ok) {
+    GError *err;
+
+    gst_message_parse_error (msg, &err, NULL);
+    fprintf (stderr, "%s\n", err->message);
+    g_error_free (err);
+  }
+  if (msg)
+    gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (src);
+  gst_object_unref (pipeline);
+
+  return ok;
+}
+
+/* The caps g729enc accepts with audio/G729,channels=2 downstream must
+ * keep every input rate, and only 2 channels */
+static gboolean
+check_sink_caps (void)
+{
+  GstElement *pipeline, *enc;
+  GstPad *pad;
+  static const gint rates[] = { 8000, 16000, 32000, 48000 };
+  GstCaps *caps, *expected;
+  gboolean ok = TRUE;
+  guint i;
+
+  pipeline = gst_parse_launch ("g729enc name=enc ! audio/G729,channels=2 ! "
+      "fakesink", NULL);
+  if (!pipeline)
+    return FALSE;
+
+  enc = gst_bin_get_by_name (GST_BIN (pipeline), "enc");
+  pad = gst_element_get_static_pad (enc, "sink");
+  caps = gst_pad_query_caps (pad, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (rates); i++) {
+    expected = gst_caps_new_simple ("audio/x-raw",
+        "rate", G_TYPE_INT, rates[i], "channels", G_TYPE_INT, 2, NULL);
+    if (!gst_caps_can_intersect (caps, expected))
+      ok = FALSE;
+    gst_caps_unref (expected);
+  }
+
+  expected = gst_caps_new_simple ("audio/x-raw",
+      "channels", G_TYPE_INT, 1, NULL);
+  if (gst_caps_can_intersect (caps, expected))
+    ok = FALSE;
+  gst_caps_unref (expected);
+
+  if (!ok) {
+    gchar *str = gst_caps_to_string (caps);
+
+    fprintf (stderr, "unexpected sink caps: %s\n", str);
+    g_free (str);
+  }
+
+  gst_caps_unref (caps);
+  gst_object_unref (pad);
+  gst_object_unref (enc);
+  gst_object_unref (pipeline);
+
+  return ok;
+}
+
+/* Multi-channel audio/G729 must be a subset of the template of the given
+ * pad of the factory with the layout field, and not without it; mono
+ * must be one with no layout */
+static gboolean
+check_layout (const gchar * name, const gchar * pad)
+{
+  GstElementFactory *factory;
+  GstStaticPadTemplate *templ = NULL;
+  GstCaps *caps, *mono, *sized, *plain;
+  const GList *l;
+  gboolean ok;
+
+  factory = gst_element_factory_find (name);
+  if (!factory)
+    return FALSE;
+
+  for (l = gst_element_factory_get_static_pad_templates (factory); l;
+      l = l->next)
+    if (!strcmp (((GstStaticPadTemplate *) l->data)->name_template, pad))
+      templ = l->data;
+
+  if (!templ) {
+    gst_object_unref (factory);
+    return FALSE;
+  }
+
+  caps = gst_static_caps_get (&templ->static_caps);
+  mono = gst_caps_from_string ("audio/G729, rate=8000, channels=1");
+  sized = gst_caps_from_string ("audio/G729, rate=8000, channels=2, "
+      "layout=" G729_LAYOUT_SIZED);
+  plain = gst_caps_from_string ("audio/G729, rate=8000, channels=2");
+
+  ok = gst_caps_is_subset (mono, caps) && gst_caps_is_subset (sized, caps)
+      && !gst_caps_is_subset (plain, caps);
+
+  gst_caps_unref (plain);
+  gst_caps_unref (sized);
+  gst_caps_unref (mono);
+  gst_caps_unref (caps);
+  gst_object_unref (factory);
+
+  return ok;
+}
+
+int
+main (int argc, char **argv)
+{
+  static const gint rates[] = { 8000, 16000, 32000, 48000 };
+  const gchar *formats[] = { GST_AUDIO_NE (S16), GST_AUDIO_NE (F32) };
+  GstElementFactory *factory;
+  guint i, j;
+  int status = 0;
+
+  gst_init (&argc, &argv);
+
+  /* the plugin from this build tree */
+  gst_registry_scan_path (gst_registry_get (), G729_PLUGIN_DIR);
+
+  factory = gst_element_factory_find ("g729enc");
+  if (!factory) {
+    fprintf (stderr, "g729enc not found in %s\n", G729_PLUGIN_DIR);
+    return NEGOTIATION_SKIP;
+  }
+  gst_object_unref (factory);
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    for (j = 0; j < G_N_ELEMENTS (rates); j++) {
+      if (run_pipeline (formats[i], rates[j], 1) &&
+          run_pipeline (formats[i], rates[j], 2)) {
+        printf ("%s %d Hz: ok\n", formats[i], rates[j]);
+      } else {
+        printf ("%s %d Hz: FAILED\n", formats[i], rates[j]);
+        status = 1;
+      }
+    }
+  }
+
+  if (check_sink_caps ()) {
+    printf ("sink caps: ok\n");
+  } else {
+    printf ("sink caps: FAILED\n");
+    status = 1;
+  }
+
+  if (check_layout ("g729enc", "src") && check_layout ("g729dec", "sink") &&
+      check_layout ("g729splice", "sink") &&
+      check_layout ("g729splice", "src") &&
+      check_layout ("g729params", "sink")) {
+    printf ("multi-channel layout: ok\n");
+  } else {
+    printf ("multi-channel layout: FAILED\n");
+    status = 1;
+  }
+
+  return status;
+}
@@ -0,0 +1,242 @@
+/* GladSToNe g729 pipeline benchmark
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+/*
+ * Runs the benchmark signals through "appsrc ! g729enc ! fakesink" and
+ * the encoded result through "appsrc ! g729dec ! fakesink", as fast as
+ * the elements go. The input is queued before the pipeline starts, so
+ * the time and the allocations per frame are those of the elements and
+ * the GStreamer machinery around them. Results are printed as a JSON
+ * object on stdout.
+ *
+ * Build with "make g729pipebench" in src/, or run "make bench".
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <gst/gst.h>
+#include <gst/audio/audio.h>
+#include <gst/app/gstappsrc.h>
+
+#include "g729common.h"
+#include "g729benchutil.h"
+
+/* 32 s, eight talk spurt cycles of the silence-heavy signal */
+#define PIPE_FRAMES 3200
+
+#define G729_FRAME_DURATION (FRAME_DURATION * GST_MSECOND)
+
+typedef struct {
+  double ns;                    /* per frame */
+  double allocs;
+} PipeResult;
+
+static void
+on_handoff (GstElement * sink, GstBuffer * buf, GstPad * pad,
+    gpointer user_data)
+{
+  GPtrArray *out = user_data;
+
+  g_ptr_array_add (out, gst_buffer_ref (buf));
+}
+
+/* Queues buffers into the "src" appsrc of desc, then times the pipeline
+ * until EOS. Buffers reaching the "sink" fakesink are added to out if it
+ * isn't NULL. */
+static gboolean
+pipe_run (const gchar * desc, GPtrArray * in, GPtrArray * out,
+    PipeResult * result)
+{
+  GstElement *pipeline, *src, *sink;
+  GstMessage *msg;
+  gboolean ok;
+  double elapsed;
+  long allocs;
+  guint i;
+
+  pipeline = gst_parse_launch (desc, NULL);
+  if (!pipeline)
+    return FALSE;
+
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  if (out) {
+    g_object_set (sink, "signal-handoffs", TRUE, NULL);
+    g_signal_connect (sink, "handoff", G_CALLBACK (on_handoff), out);
+  }
+
+  for (i = 0; i < in->len; i++)
+    gst_app_src_push_buffer (GST_APP_SRC (src),
+        gst_buffer_ref (g_ptr_array_index (in, i)));
+  gst_app_src_end_of_stream (GST_APP_SRC (src));
+
+  bench_allocs_start ();
+  elapsed = bench_now ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  elapsed = bench_now () - elapsed;
+  allocs = bench_allocs_stop ();
+
+  ok = msg && GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS;
+  if (msg)
+    gst_message_unref (msg);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  result->ns = elapsed / PIPE_FRAMES;
+  result->allocs = allocs < 0 ? -1.0 : (double) allocs / PIPE_FRAMES;
+
+  gst_object_unref (src);
+  gst_object_unref (sink);
+  gst_object_unref (pipeline);
+
+  return ok;
+}
+
+/* One 10 ms buffer per frame, as a capture device or a jitter buffer
+ * would push them */
+static GPtrArray *
+pipe_pcm (BenchSignal signal)
+{
+  GPtrArray *in = g_ptr_array_new_with_free_func (
+      (GDestroyNotify) gst_buffer_unref);
+  GstBuffer *buf;
+  GstMapInfo map;
+  guint i;
+
+  for (i = 0; i < PIPE_FRAMES; i++) {
+    buf = gst_buffer_new_allocate (NULL, RAW_FRAME_BYTES, NULL);
+    gst_buffer_map (buf, &map, GST_MAP_WRITE);
+    bench_signal (signal, 0, (long) i * RAW_FRAME_SAMPLES, RAW_FRAME_SAMPLES,
+        (int16_t *) map.data, 1);
+    gst_buffer_unmap (buf, &map);
+
+    GST_BUFFER_PTS (buf) = i * G729_FRAME_DURATION;
+    GST_BUFFER_DURATION (buf) = G729_FRAME_DURATION;
+    g_ptr_array_add (in, buf);
+  }
+
+  return in;
+}
+
+static gboolean
+pipe_bench (BenchSignal signal, gboolean vad, PipeResult * enc,
+    PipeResult * dec)
+{
+  GPtrArray *pcm, *coded;
+  gchar *desc;
+  gboolean ok;
+
+  pcm = pipe_pcm (signal);
+  coded = g_ptr_array_new_full (PIPE_FRAMES,
+      (GDestroyNotify) gst_buffer_unref);
+
+  desc = g_strdup_printf ("appsrc name=src format=time max-bytes=0 "
+      "caps=audio/x-raw,format=%s,rate=%d,channels=1,layout=interleaved ! "
+      "g729enc vad=%s ! fakesink name=sink sync=false",
+      GST_AUDIO_NE (S16), SAMPLE_RATE, vad ? "true" : "false");
+  ok = pipe_run (desc, pcm, coded, enc);
+  g_free (desc);
+
+  if (ok) {
+    desc = g_strdup_printf ("appsrc name=src format=time max-bytes=0 "
+        "caps=audio/G729,rate=%d,channels=1 ! "
+        "g729dec ! fakesink name=sink sync=false", SAMPLE_RATE);
+    ok = pipe_run (desc, coded, NULL, dec);
+    g_free (desc);
+  }
+
+  g_ptr_array_unref (coded);
+  g_ptr_array_unref (pcm);
+
+  return ok;
+}
+
+static void
+pipe_print (const gchar * name, const PipeResult * enc,
+    const PipeResult * dec, gboolean last)
+{
+  printf ("    \"%s\": {\n", name);
+  printf ("      \"g729enc_ns_per_frame\": %.1f,\n", enc->ns);
+  printf ("      \"g729enc_frames_per_s\": %.0f,\n", 1e9 / enc->ns);
+  printf ("      \"g729enc_channels_per_core\": %.0f,\n", 1e7 / enc->ns);
+  printf ("      \"g729enc_allocs_per_frame\": %.2f,\n", enc->allocs);
+  printf ("      \"g729dec_ns_per_frame\": %.1f,\n", dec->ns);
+  printf ("      \"g729dec_frames_per_s\": %.0f,\n", 1e9 / dec->ns);
+  printf ("      \"g729dec_channels_per_core\": %.0f,\n", 1e7 / dec->ns);
+  printf ("      \"g729dec_allocs_per_frame\": %.2f\n", dec->allocs);
+  printf ("    }%s\n", last ? "" : ",");
+}
+
+int
+main (int argc, char **argv)
+{
+  PipeResult speech_enc, speech_dec, silence_enc, silence_dec;
+
+  gst_init (&argc, &argv);
+
+  /* the plugin from this build tree */
+  gst_registry_scan_path (gst_registry_get (), G729_PLUGIN_DIR);
+
+  if (!pipe_bench (BENCH_SIGNAL_SPEECH, FALSE, &speech_enc, &speech_dec) ||
+      !pipe_bench (BENCH_SIGNAL_SILENCE_HEAVY, TRUE, &silence_enc,
+          &silence_dec)) {
+    fprintf (stderr, "failed to run the pipelines\n");
+    return 1;
+  }
+
+  printf ("{\n");
+  printf ("  \"pipeline\": {\n");
+  pipe_print ("speech", &speech_enc, &speech_dec, FALSE);
+  pipe_print ("silence_heavy_vad", &silence_enc, &silence_dec, TRUE);
+  printf ("  }\n");
+  printf ("}\n");
+
+  return 0;
+}
@@ -0,0 +1,318 @@
+/* GladSToNe g729 post-filter
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+/*
+ * The stateful part of the reference decoder output stages (postfilt.c
+ * and post_pro.c), operating on a G729DecState instead of file scope
+ * variables. pit_pst_filt() keeps no state and is called as it is.
+ */
+
+#include "g729state.h"
+
+/* ref code includes: */
+#include "basic_op.h"
+#include "oper_32b.h"
+#include "tab_ld8a.h"
+
+/* postfilt.c: preemphasis() */
+static void
+g729_preemphasis (
+  Word16 *mem_pre,  /* (i/o)   : last input sample of the previous call  */
+  Word16 *signal,   /* (i/o)   : input signal overwritten by the output */
+  Word16 g,         /* (i) Q15 : preemphasis coefficient                */
+  Word16 L          /* (i)     : size of filtering                      */
+)
+{
+  Word16 temp, i;
+
+  temp = signal[L-1];
+
+  for (i = L-1; i > 0; i--)
+  {
+    signal[i] = sub(signal[i], mult(g, signal[i-1]));
+  }
+
+  signal[0] = sub(signal[0], mult(g, *mem_pre));
+
+  *mem_pre = temp;
+}
+
+/* postfilt.c: agc() */
+static void
+g729_agc (
+  Word16 *past_gain,/* (i/o) Q12 : gain at the end of the previous call */
+  Word16 *sig_in,   /* (i)     : postfilter input signal  */
+  Word16 *sig_out,  /* (i/o)   : postfilter output signal */
+  Word16 l_trm      /* (i)     : subframe size            */
+)
+{
+  Word16 i, exp;
+  Word16 gain_in, gain_out, g0, gain;                     /* Q12 */
+  Word32 s;
+
+  Word16 signal[L_SUBFR];
+
+  /* calculate gain_out with exponent */
+
+  for(i=0; i<l_trm; i++)
+    signal[i] = shr(sig_out[i], 2);
+
+  s = 0;
+  for(i=0; i<l_trm; i++)
+    s = L_mac(s, signal[i], signal[i]);
+
+  if (s == 0) {
+    *past_gain = 0;
+    return;
+  }
+  exp = sub(norm_l(s), 1);
+  gain_out = round(L_shl(s, exp));
+
+  /* calculate gain_in with exponent */
+
+  for(i=0; i<l_trm; i++)
+    signal[i] = shr(sig_in[i], 2);
+
+  s = 0;
+  for(i=0; i<l_trm; i++)
+    s = L_mac(s, signal[i], signal[i]);
+
+  if (s == 0) {
+    g0 = 0;
+  }
+  else {
+    i = norm_l(s);
+    gain_in = round(L_shl(s, i));
+    exp = sub(exp, i);
+
+   /*---------------------------------------------------*
+    *  g0(Q12) = (1-AGC_FAC) * sqrt(gain_in/gain_out);  *
+    *---------------------------------------------------*/
+
+    s = L_deposit_l(div_s(gain_out,gain_in));   /* Q15 */
+    s = L_shl(s, 7);           /* s(Q22) = gain_out / gain_in */
+    s = L_shr(s, exp);         /* Q22, add exponent */
+
+    /* i(Q12) = s(Q19) = 1 / sqrt(s(Q22)) */
+    s = Inv_sqrt(s);           /* Q19 */
+    i = round(L_shl(s,9));     /* Q12 */
+
+    /* g0(Q12) = i(Q12) * (1-AGC_FAC)(Q15) */
+    g0 = mult(i, AGC_FAC1);       /* Q12 */
+  }
+
+  /* compute gain(n) = AGC_FAC gain(n-1) + (1-AGC_FAC)gain_in/gain_out */
+  /* sig_out(n) = gain(n) sig_out(n)                                   */
+
+  gain = *past_gain;
+  for(i=0; i<l_trm; i++) {
+    gain = mult(gain, AGC_FAC);
+    gain = add(gain, g0);
+    sig_out[i] = extract_h(L_shl(L_mult(sig_out[i], gain), 3));
+  }
+  *past_gain = gain;
+}
+
+/* postfilt.c: Post_Filter() */
+void
+g729_post_filter (
+  G729DecState *state,
+  Word16 *syn,       /* in/out: synthesis speech (postfiltered is output)    */
+  Word16 *Az_4,      /* input : interpolated LPC parameters in all subframes */
+  Word16 *T,         /* input : decoded pitch lags in all subframes          */
+  Word16 Vad         /* input : frame type                                   */
+)
+{
+ /*-------------------------------------------------------------------*
+  *           Declaration of parameters                               *
+  *-------------------------------------------------------------------*/
+
+ Word16 *res2 = state->res2;           /* residual after A(z/GAMMA2_PST) */
+ Word16 *scal_res2 = state->scal_res2; /* its scaled version              */
+ Word16 res2_pst[L_SUBFR];  /* res2[] after pitch postfiltering */
+ Word16 syn_pst[L_FRAME];   /* post filtered synthesis speech   */
+
+ Word16 Ap3[MP1], Ap4[MP1];  /* bandwidth expanded LP parameters */
+
+ Word16 *Az;                 /* pointer to Az_4:                 */
+                             /*  LPC parameters in each subframe */
+ Word16   t0_max, t0_min;    /* closed-loop pitch search range   */
+ Word16   i_subfr;           /* index for beginning of subframe  */
+
+ Word16 h[L_H];
+
+ Word16  i, j;
+ Word16  temp1, temp2;
+ Word32  L_tmp;
+
+   /*-----------------------------------------------------*
+    * Post filtering                                      *
+    *-----------------------------------------------------*/
+
+    Az = Az_4;
+
+    for (i_subfr = 0; i_subfr < L_FRAME; i_subfr += L_SUBFR)
+    {
+      /* Find pitch range t0_min - t0_max */
+
+      t0_min = sub(*T++, 3);
+      t0_max = add(t0_min, 6);
+      if (sub(t0_max, PIT_MAX) > 0) {
+        t0_max = PIT_MAX;
+        t0_min = sub(t0_max, 6);
+      }
+
+      /* Find weighted filter coefficients Ap3[] and ap[4] */
+
+      Weight_Az(Az, GAMMA2_PST, M, Ap3);
+      Weight_Az(Az, GAMMA1_PST, M, Ap4);
+
+      /* filtering of synthesis speech by A(z/GAMMA2_PST) to find res2[] */
+
+      Residu(Ap3, &syn[i_subfr], res2, L_SUBFR);
+
+      /* scaling of "res2[]" to avoid energy overflow */
+
+      for (j=0; j<L_SUBFR; j++)
+      {
+        scal_res2[j] = shr(res2[j], 2);
+      }
+
+      /* pitch postfiltering */
+      if (sub(Vad, 1) == 0)
+        pit_pst_filt(res2, scal_res2, t0_min, t0_max, L_SUBFR, res2_pst);
+      else
+        for (j=0; j<L_SUBFR; j++)
+          res2_pst[j] = res2[j];
+
+      /* tilt compensation filter */
+
+      /* impulse response of A(z/GAMMA2_PST)/A(z/GAMMA1_PST) */
+
+      Copy(Ap3, h, M+1);
+      Set_zero(&h[M+1], L_H-M-1);
+      Syn_filt(Ap4, h, h, L_H, &h[M+1], 0);
+
+      /* 1st correlation of h[] */
+
+      L_tmp = L_mult(h[0], h[0]);
+      for (i=1; i<L_H; i++) L_tmp = L_mac(L_tmp, h[i], h[i]);
+      temp1 = extract_h(L_tmp);
+
+      L_tmp = L_mult(h[0], h[1]);
+      for (i=1; i<L_H-1; i++) L_tmp = L_mac(L_tmp, h[i], h[i+1]);
+      temp2 = extract_h(L_tmp);
+
+      if(temp2 <= 0) {
+        temp2 = 0;
+      }
+      else {
+        temp2 = mult(temp2, MU);
+        temp2 = div_s(temp2, temp1);
+      }
+
+      g729_preemphasis(&state->mem_pre, res2_pst, temp2, L_SUBFR);
+
+      /* filtering through  1/A(z/GAMMA1_PST) */
+
+      Syn_filt(Ap4, res2_pst, &syn_pst[i_subfr], L_SUBFR,
+          state->mem_syn_pst, 1);
+
+      /* scale output to input */
+
+      g729_agc(&state->past_gain, &syn[i_subfr], &syn_pst[i_subfr], L_SUBFR);
+
+      /* update res2[] buffer;  shift by L_SUBFR */
+
+      Copy(&res2[L_SUBFR-PIT_MAX], &res2[-PIT_MAX], PIT_MAX);
+      Copy(&scal_res2[L_SUBFR-PIT_MAX], &scal_res2[-PIT_MAX], PIT_MAX);
+
+      Az += MP1;
+    }
+
+    /* update syn[] buffer */
+
+    Copy(&syn[L_FRAME-M], &syn[-M], M);
+
+    /* overwrite synthesis speech by postfiltered synthesis speech */
+
+    Copy(syn_pst, syn, L_FRAME);
+}
+
+/* post_pro.c: Post_Process(), writing to a separate output */
+void
+g729_post_process (
+  G729HighPassState *state,
+  const Word16 signal[], /* input signal      */
+  Word16 out[],       /* output signal       */
+  Word16 lg           /* length of signal    */
+)
+{
+  Word16 i, x2;
+  Word32 L_tmp;
+
+  for(i=0; i<lg; i++)
+  {
+     x2 = state->x1;
+     state->x1 = state->x0;
+     state->x0 = signal[i];
+
+     /*  y[i] = b[0]*x[i]   + b[1]*x[i-1]   + b[2]*x[i-2]    */
+     /*                     + a[1]*y[i-1] + a[2] * y[i-2];      */
+
+     L_tmp =     Mpy_32_16(state->y1_hi, state->y1_lo, a100[1]);
+     L_tmp = L_add(L_tmp, Mpy_32_16(state->y2_hi, state->y2_lo, a100[2]));
+     L_tmp = L_mac(L_tmp, state->x0, b100[0]);
+     L_tmp = L_mac(L_tmp, state->x1, b100[1]);
+     L_tmp = L_mac(L_tmp, x2, b100[2]);
+     L_tmp = L_shl(L_tmp, 2);      /* Q29 --> Q31 (Q13 --> Q15) */
+
+     /* Multiplication by two of output speech with saturation. */
+     out[i] = round(L_shl(L_tmp, 1));
+
+     state->y2_hi = state->y1_hi;
+     state->y2_lo = state->y1_lo;
+     L_Extract(L_tmp, &state->y1_hi, &state->y1_lo);
+  }
+}
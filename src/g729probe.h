@@ -0,0 +1,89 @@
+/* GladSToNe g729 profiling probes
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+#ifndef __G729_PROBE_H__
+#define __G729_PROBE_H__
+
+#include "g729.h"
+
+/*
+ * Stage boundaries of the codec (see G729Stage). With G729_PROBES each one
+ * is a USDT probe named g729:<name>_begin / g729:<name>_end taking the
+ * encoder or decoder handle, for perf and bpftrace, plus a call to the
+ * hook set with g729_stage_set_hook(), if any. Without it they expand to
+ * nothing.
+ *
+ * The probes are a nop instruction until a tracer attaches to them, and
+ * the hook costs a load and a branch when unset.
+ */
+
+#ifdef G729_PROBES
+
+#include <sys/sdt.h>
+
+extern G729StageHook g729_stage_hook;
+extern void *g729_stage_hook_data;
+
+#define G729_STAGE_PROBE(codec, stage, name, end) \
+  do { \
+    G729StageHook _hook; \
+    DTRACE_PROBE1 (g729, name, codec); \
+    _hook = __atomic_load_n (&g729_stage_hook, __ATOMIC_ACQUIRE); \
+    if (__builtin_expect (_hook != NULL, 0)) \
+      _hook (codec, stage, end, g729_stage_hook_data); \
+  } while (0)
+
+#define G729_STAGE_BEGIN(codec, stage, name) \
+  G729_STAGE_PROBE (codec, stage, name##_begin, 0)
+#define G729_STAGE_END(codec, stage, name) \
+  G729_STAGE_PROBE (codec, stage, name##_end, 1)
+
+#else
+
+#define G729_STAGE_BEGIN(codec, stage, name) do { } while (0)
+#define G729_STAGE_END(codec, stage, name) do { } while (0)
+
+#endif
+
+#endif /* __G729_PROBE_H__ */
@@ -0,0 +1,997 @@
+/* GladSToNe g729 reduced searches
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+/*
+ * Reduced search variants of the Annex A encoder, selected by the encoder
+ * complexity (see g729.h):
+ *
+ *  - below G729_COMPLEXITY_MAX the algebraic codebook search only tries
+ *    the pulse positions with the largest correlation with the target on
+ *    each track, instead of the reference depth-first search;
+ *  - at 0 the open-loop pitch search also looks at every other lag only,
+ *    refining the best one of each section.
+ *
+ * The selection metrics are computed exactly (64 bit) rather than with
+ * the reference code's scaled 16 bit arithmetic; what gets transmitted,
+ * and the code vectors handed back to the encoder, are built with the
+ * reference operators.
+ *
+ * At G729_COMPLEXITY_MAX the algebraic codebook search is the reference
+ * one of acelp_ca.c, ported here so that the correlations of Cor_h() can
+ * go through the SIMD kernels (g729kernels.h) like the rest.
+ */
+
+#include "g729search.h"
+#include "g729kernels.h"
+#include "g729.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* ref code includes: */
+#include "typedef.h"
+#include "basic_op.h"
+#include "ld8a.h"
+
+/* positions tried per track: the 8 positions of tracks 0-2, the 16 of
+ * track 3 (which interleaves two sub-tracks) */
+#define G729_SEARCH_TRACKS 4
+#define G729_SEARCH_CANDIDATES 2
+#define G729_SEARCH_CANDIDATES_T3 4
+
+/* Keeps in best[] the n positions of the track with the largest |dn|,
+ * track positions being first + k * step */
+static void
+g729_search_candidates (const Word16 dn[], int first, int step, int n,
+    int best[])
+{
+  int pos, i, j;
+
+  for (i = 0; i < n; i++)
+    best[i] = -1;
+
+  for (pos = first; pos < L_SUBFR; pos += step) {
+    for (i = 0; i < n; i++) {
+      if (best[i] < 0 || abs (dn[pos]) > abs (dn[best[i]])) {
+        for (j = n - 1; j > i; j--)
+          best[j] = best[j - 1];
+        best[i] = pos;
+        break;
+      }
+    }
+  }
+}
+
+/* Correlation of the impulse response with itself shifted to positions
+ * p and q */
+static int64_t
+g729_search_phi (const Word16 h[], int p, int q)
+{
+  int64_t sum = 0;
+  int n, start = p > q ? p : q;
+
+  for (n = start; n < L_SUBFR; n++)
+    sum += (int32_t) h[n - p] * h[n - q];
+
+  return sum;
+}
+
+/* Blocks of rr[] holding the correlations between two tracks, in the
+ * order of acelp_ca.c (rri0i1, rri0i2, ..., rri2i4), -1 for the pairs the
+ * search never uses */
+static const signed char g729_search_rr_block[5][5] = {
+  { -1, 0, 1, 2, 3 },
+  { 0, -1, 4, 5, 6 },
+  { 1, 4, -1, 7, 8 },
+  { 2, 5, 7, -1, -1 },
+  { 3, 6, 8, -1, -1 }
+};
+
+/* Offset in rr[] of the correlation of the pulses at positions p <= q,
+ * -1 if the search doesn't use it */
+static int
+g729_search_rr_offset (int p, int q)
+{
+  int tp = p % STEP, tq = q % STEP;
+  int block;
+
+  if (p == q)
+    return tp * NB_POS + p / STEP;
+
+  block = g729_search_rr_block[tp][tq];
+  if (block < 0)
+    return -1;
+
+  /* rows go with the lower track */
+  if (tp < tq)
+    return 5 * NB_POS + block * MSIZE + (p / STEP) * NB_POS + q / STEP;
+
+  return 5 * NB_POS + block * MSIZE + (q / STEP) * NB_POS + p / STEP;
+}
+
+/* acelp_ca.c: Cor_h(). Every correlation of rr[] is an L_mac() chain
+ * along one diagonal of h[] stopped at the end of the subframe, and the
+ * reference walks each diagonal once, storing the chain as it goes: the
+ * chain at lag d after its terms 0 to m is the correlation of the pulses
+ * at L_SUBFR-1-m-d and L_SUBFR-1-m. The chains are computed here for all
+ * the diagonals at once, then stored in the rr[] layout of the search. */
+static void
+g729_search_cor_h (
+  Word16 *H,     /* (i) Q12 :Impulse response of filters */
+  Word16 *rr     /* (o)     :Correlations of H[]         */
+)
+{
+  Word16 h[L_SUBFR];
+  Word16 cor[L_SUBFR][L_SUBFR];
+  Word32 L_cor;
+  Word16 i, k;
+  int m, d, offset;
+
+ /* Scaling h[] for maximum precision */
+
+  L_cor = 0;
+  for(i=0; i<L_SUBFR; i++)
+    L_cor = L_mac(L_cor, H[i], H[i]);
+
+  if(sub(extract_h(L_cor),32000) > 0)
+  {
+    for(i=0; i<L_SUBFR; i++) {
+      h[i] = shr(H[i], 1);}
+  }
+  else
+  {
+    k = norm_l(L_cor);
+    k = shr(k, 1);
+
+    for(i=0; i<L_SUBFR; i++) {
+      h[i] = shl(H[i], k); }
+  }
+
+  /* the reference doesn't run the chains between pulses of the same
+   * track, which only matters to Overflow */
+  if (!g729_kernels_cor_h_diagonals (h, cor)) {
+    for (d = 0; d < L_SUBFR; d++) {
+      if (d > 0 && d % STEP == 0)
+        continue;
+
+      L_cor = 0;
+      for (m = 0; m < L_SUBFR - d; m++) {
+        L_cor = L_mac(L_cor, h[m], h[m + d]);
+        cor[m][d] = extract_h(L_cor);
+      }
+    }
+  }
+
+  for (m = 0; m < L_SUBFR; m++) {
+    for (d = 0; d < L_SUBFR - m; d++) {
+      offset = g729_search_rr_offset (L_SUBFR - 1 - m - d, L_SUBFR - 1 - m);
+      if (offset >= 0)
+        rr[offset] = cor[m][d];
+    }
+  }
+}
+
+/* acelp_ca.c: D4i40_17_fast() */
+static Word16
+g729_search_d4i40_17_fast (/*(o) : Index of pulses positions.              */
+  Word16 dn[],          /* (i)    : Correlations between h[] and Xn[].       */
+  Word16 rr[],          /* (i)    : Correlations of impulse response h[].    */
+  Word16 h[],           /* (i) Q12: Impulse response of filters.             */
+  Word16 cod[],         /* (o) Q13: Selected algebraic codeword.             */
+  Word16 y[],           /* (o) Q12: Filtered algebraic codeword.             */
+  Word16 *sign          /* (o)    : Signs of 4 pulses.                       */
+)
+{
+  Word16 i0, i1, i2, i3, ip0, ip1, ip2, ip3;
+  Word16 i, j, ix, iy, track, max;
+  Word16 prev_i0, i1_offset;
+  Word16 psk, ps, ps0, ps1, ps2, sq, sq2;
+  Word16 alpk, alp, alp_16;
+  Word32 s, alp0, alp1, alp2;
+  Word16 *p0, *p1, *p2, *p3, *p4;
+  Word16 sign_dn[L_SUBFR], sign_dn_inv[L_SUBFR], *psign;
+  Word16 tmp_vect[NB_POS];
+  Word16 *rri0i0, *rri1i1, *rri2i2, *rri3i3, *rri4i4;
+  Word16 *rri0i1, *rri0i2, *rri0i3, *rri0i4;
+  Word16 *rri1i2, *rri1i3, *rri1i4;
+  Word16 *rri2i3, *rri2i4;
+
+  Word16  *ptr_rri0i3_i4;
+  Word16  *ptr_rri1i3_i4;
+  Word16  *ptr_rri2i3_i4;
+  Word16  *ptr_rri3i3_i4;
+
+  /* Init pointers */
+
+  rri0i0 = rr;
+  rri1i1 = rri0i0 + NB_POS;
+  rri2i2 = rri1i1 + NB_POS;
+  rri3i3 = rri2i2 + NB_POS;
+  rri4i4 = rri3i3 + NB_POS;
+  rri0i1 = rri4i4 + NB_POS;
+  rri0i2 = rri0i1 + MSIZE;
+  rri0i3 = rri0i2 + MSIZE;
+  rri0i4 = rri0i3 + MSIZE;
+  rri1i2 = rri0i4 + MSIZE;
+  rri1i3 = rri1i2 + MSIZE;
+  rri1i4 = rri1i3 + MSIZE;
+  rri2i3 = rri1i4 + MSIZE;
+  rri2i4 = rri2i3 + MSIZE;
+
+  /*-----------------------------------------------------------------------*
+   * Chose the sign of the impulse.                                        *
+   *-----------------------------------------------------------------------*/
+
+  for (i=0; i<L_SUBFR; i++)
+  {
+    if (dn[i] >= 0)
+    {
+      sign_dn[i] = MAX_16;
+      sign_dn_inv[i] = MIN_16;
+    }
+    else
+    {
+      sign_dn[i] = MIN_16;
+      sign_dn_inv[i] = MAX_16;
+      dn[i] = negate(dn[i]);
+    }
+  }
+
+  /*-------------------------------------------------------------------*
+   * Modification of rrixiy[] to take signs into account.              *
+   *-------------------------------------------------------------------*/
+
+  p0 = rri0i1;
+  p1 = rri0i2;
+  p2 = rri0i3;
+  p3 = rri0i4;
+
+  for(i0=0; i0<L_SUBFR; i0+=STEP)
+  {
+    psign = sign_dn;
+    if (psign[i0] < 0) psign = sign_dn_inv;
+
+    for(i1=1; i1<L_SUBFR; i1+=STEP)
+    {
+      *p0 = mult(*p0, psign[i1]);    p0++;
+      *p1 = mult(*p1, psign[i1+1]);  p1++;
+      *p2 = mult(*p2, psign[i1+2]);  p2++;
+      *p3 = mult(*p3, psign[i1+3]);  p3++;
+    }
+  }
+
+  p0 = rri1i2;
+  p1 = rri1i3;
+  p2 = rri1i4;
+
+  for(i1=1; i1<L_SUBFR; i1+=STEP)
+  {
+    psign = sign_dn;
+    if (psign[i1] < 0) psign = sign_dn_inv;
+
+    for(i2=2; i2<L_SUBFR; i2+=STEP)
+    {
+      *p0 = mult(*p0, psign[i2]);   p0++;
+      *p1 = mult(*p1, psign[i2+1]); p1++;
+      *p2 = mult(*p2, psign[i2+2]); p2++;
+    }
+  }
+
+  p0 = rri2i3;
+  p1 = rri2i4;
+
+  for(i2=2; i2<L_SUBFR; i2+=STEP)
+  {
+    psign = sign_dn;
+    if (psign[i2] < 0) psign = sign_dn_inv;
+
+    for(i3=3; i3<L_SUBFR; i3+=STEP)
+    {
+      *p0 = mult(*p0, psign[i3]);   p0++;
+      *p1 = mult(*p1, psign[i3+1]); p1++;
+    }
+  }
+
+  /*-------------------------------------------------------------------*
+   * Search the optimum positions of the four pulses which maximize    *
+   *     square(correlation) / energy                                  *
+   *-------------------------------------------------------------------*/
+
+  psk = -1;
+  alpk = 1;
+
+  ptr_rri0i3_i4 = rri0i3;
+  ptr_rri1i3_i4 = rri1i3;
+  ptr_rri2i3_i4 = rri2i3;
+  ptr_rri3i3_i4 = rri3i3;
+
+  /* Initializations only to remove warning from some compilers */
+
+  ip0=0; ip1=1; ip2=2; ip3=3; ix=0; iy=0; ps=0; i0=0;
+
+  /* search 2 times: track 3 and 4 */
+  for (track=3; track<5; track++)
+  {
+   /*------------------------------------------------------------------*
+    * depth first search 3, phase A: track 2 and 3/4.                  *
+    *------------------------------------------------------------------*/
+
+    sq = -1;
+    alp = 1;
+
+    /* i0 loop: 2 positions in track 2 */
+
+    prev_i0  = -1;
+
+    for (i=0; i<2; i++)
+    {
+      max = -1;
+      /* search "dn[]" maximum position in track 2 */
+      for (j=2; j<L_SUBFR; j+=STEP)
+      {
+        if ((sub(dn[j], max) > 0) && (sub(prev_i0,j) != 0))
+        {
+          max = dn[j];
+          i0 = j;
+        }
+      }
+      prev_i0 = i0;
+
+      j = mult(i0, 6554);        /* j = i0/5 */
+      p0 = rri2i2 + j;
+
+      ps1 = dn[i0];
+      alp1 = L_mult(*p0, _1_4);
+
+      /* i1 loop: 8 positions in track 2 */
+
+      p0 = ptr_rri2i3_i4 + shl(j, 3);
+      p1 = ptr_rri3i3_i4;
+
+      for (i1=track; i1<L_SUBFR; i1+=STEP)
+      {
+        ps2 = add(ps1, dn[i1]);       /* index increment = STEP */
+
+        /* alp1 = alp0 + rr[i0][i1] + 1/2*rr[i1][i1]; */
+        alp2 = L_mac(alp1, *p0++, _1_2);
+        alp2 = L_mac(alp2, *p1++, _1_4);
+
+        sq2 = mult(ps2, ps2);
+        alp_16 = round(alp2);
+
+        s = L_msu(L_mult(alp, sq2), sq, alp_16);
+        if (s > 0)
+        {
+          sq = sq2;
+          ps = ps2;
+          alp = alp_16;
+          ix = i0;
+          iy = i1;
+        }
+      }
+    }
+
+    i0 = ix;
+    i1 = iy;
+    i1_offset = shl(mult(i1, 6554), 3);       /* j = 8*(i1/5) */
+
+   /*------------------------------------------------------------------*
+    * depth first search 3, phase B: track 0 and 1.                    *
+    *------------------------------------------------------------------*/
+
+    ps0 = ps;
+    alp0 = L_mult(alp, _1_4);
+
+    sq = -1;
+    alp = 1;
+
+    /* build vector for next loop to decrease complexity */
+
+    p0 = rri1i2 + mult(i0, 6554);
+    p1 = ptr_rri1i3_i4 + mult(i1, 6554);
+    p2 = rri1i1;
+    p3 = tmp_vect;
+
+    for (i3=1; i3<L_SUBFR; i3+=STEP)
+    {
+      /* rrv[i3] = rr[i3][i3] + rr[i0][i3] + rr[i1][i3]; */
+      s = L_mult(*p0, _1_4);        p0 += NB_POS;
+      s = L_mac(s, *p1, _1_4);      p1 += NB_POS;
+      s = L_mac(s, *p2++, _1_8);
+      *p3++ = round(s);
+    }
+
+    /* i2 loop: 8 positions in track 0 */
+
+    p0 = rri0i2 + mult(i0, 6554);
+    p1 = ptr_rri0i3_i4 + mult(i1, 6554);
+    p2 = rri0i0;
+    p3 = rri0i1;
+
+    for (i2=0; i2<L_SUBFR; i2+=STEP)
+    {
+      ps1 = add(ps0, dn[i2]);         /* index increment = STEP */
+
+      /* alp1 = alp0 + rr[i0][i2] + rr[i1][i2] + 1/2*rr[i2][i2]; */
+      alp1 = L_mac(alp0, *p0, _1_8);       p0 += NB_POS;
+      alp1 = L_mac(alp1, *p1, _1_8);       p1 += NB_POS;
+      alp1 = L_mac(alp1, *p2++, _1_16);
+
+      /* i3 loop: 8 positions in track 1 */
+
+      p4 = tmp_vect;
+
+      for (i3=1; i3<L_SUBFR; i3+=STEP)
+      {
+        ps2 = add(ps1, dn[i3]);       /* index increment = STEP */
+
+        /* alp1 = alp0 + rr[i0][i3] + rr[i1][i3] + rr[i2][i3] + 1/2*rr[i3][i3]; */
+        alp2 = L_mac(alp1, *p3++, _1_8);
+        alp2 = L_mac(alp2, *p4++, _1_2);
+
+        sq2 = mult(ps2, ps2);
+        alp_16 = round(alp2);
+
+        s = L_msu(L_mult(alp, sq2), sq, alp_16);
+        if (s > 0)
+        {
+          sq = sq2;
+          alp = alp_16;
+          ix = i2;
+          iy = i3;
+        }
+      }
+    }
+
+   /*----------------------------------------------------------------*
+    * depth first search 3: compare codevector with the best case.   *
+    *----------------------------------------------------------------*/
+
+    s = L_msu(L_mult(alpk, sq), psk, alp);
+    if (s > 0)
+    {
+      psk = sq;
+      alpk = alp;
+      ip2 = i0;
+      ip3 = i1;
+      ip0 = ix;
+      ip1 = iy;
+    }
+
+   /*------------------------------------------------------------------*
+    * depth first search 4, phase A: track 3 and 0.                    *
+    *------------------------------------------------------------------*/
+
+    sq = -1;
+    alp = 1;
+
+    /* i0 loop: 2 positions in track 3/4 */
+
+    prev_i0  = -1;
+
+    for (i=0; i<2; i++)
+    {
+      max = -1;
+      /* search "dn[]" maximum position in track 3/4 */
+      for (j=track; j<L_SUBFR; j+=STEP)
+      {
+        if ((sub(dn[j], max) > 0) && (sub(prev_i0,j) != 0))
+        {
+          max = dn[j];
+          i0 = j;
+        }
+      }
+      prev_i0 = i0;
+
+      j = mult(i0, 6554);        /* j = i0/5 */
+      p0 = ptr_rri3i3_i4 + j;
+
+      ps1 = dn[i0];
+      alp1 = L_mult(*p0, _1_4);
+
+      /* i1 loop: 8 positions in track 0 */
+
+      p0 = ptr_rri0i3_i4 + j;
+      p1 = rri0i0;
+
+      for (i1=0; i1<L_SUBFR; i1+=STEP)
+      {
+        ps2 = add(ps1, dn[i1]);       /* index increment = STEP */
+
+        /* alp1 = alp0 + rr[i0][i1] + 1/2*rr[i1][i1]; */
+        alp2 = L_mac(alp1, *p0, _1_2);       p0 += NB_POS;
+        alp2 = L_mac(alp2, *p1++, _1_4);
+
+        sq2 = mult(ps2, ps2);
+        alp_16 = round(alp2);
+
+        s = L_msu(L_mult(alp, sq2), sq, alp_16);
+        if (s > 0)
+        {
+          sq = sq2;
+          ps = ps2;
+          alp = alp_16;
+          ix = i0;
+          iy = i1;
+        }
+      }
+    }
+
+    i0 = ix;
+    i1 = iy;
+    i1_offset = shl(mult(i1, 6554), 3);       /* j = 8*(i1/5) */
+
+   /*------------------------------------------------------------------*
+    * depth first search 4, phase B: track 1 and 2.                    *
+    *------------------------------------------------------------------*/
+
+    ps0 = ps;
+    alp0 = L_mult(alp, _1_4);
+
+    sq = -1;
+    alp = 1;
+
+    /* build vector for next loop to decrease complexity */
+
+    p0 = ptr_rri2i3_i4 + mult(i0, 6554);
+    p1 = rri0i2 + i1_offset;
+    p2 = rri2i2;
+    p3 = tmp_vect;
+
+    for (i3=2; i3<L_SUBFR; i3+=STEP)
+    {
+      /* rrv[i3] = rr[i3][i3] + rr[i0][i3] + rr[i1][i3]; */
+      s = L_mult(*p0, _1_4);         p0 += NB_POS;
+      s = L_mac(s, *p1++, _1_4);
+      s = L_mac(s, *p2++, _1_8);
+      *p3++ = round(s);
+    }
+
+    /* i2 loop: 8 positions in track 1 */
+
+    p0 = ptr_rri1i3_i4 + mult(i0, 6554);
+    p1 = rri0i1 + i1_offset;
+    p2 = rri1i1;
+    p3 = rri1i2;
+
+    for (i2=1; i2<L_SUBFR; i2+=STEP)
+    {
+      ps1 = add(ps0, dn[i2]);         /* index increment = STEP */
+
+      /* alp1 = alp0 + rr[i0][i2] + rr[i1][i2] + 1/2*rr[i2][i2]; */
+      alp1 = L_mac(alp0, *p0, _1_8);       p0 += NB_POS;
+      alp1 = L_mac(alp1, *p1++, _1_8);
+      alp1 = L_mac(alp1, *p2++, _1_16);
+
+      /* i3 loop: 8 positions in track 2 */
+
+      p4 = tmp_vect;
+
+      for (i3=2; i3<L_SUBFR; i3+=STEP)
+      {
+        ps2 = add(ps1, dn[i3]);       /* index increment = STEP */
+
+        /* alp1 = alp0 + rr[i0][i3] + rr[i1][i3] + rr[i2][i3] + 1/2*rr[i3][i3]; */
+        alp2 = L_mac(alp1, *p3++, _1_8);
+        alp2 = L_mac(alp2, *p4++, _1_2);
+
+        sq2 = mult(ps2, ps2);
+        alp_16 = round(alp2);
+
+        s = L_msu(L_mult(alp, sq2), sq, alp_16);
+        if (s > 0)
+        {
+          sq = sq2;
+          alp = alp_16;
+          ix = i2;
+          iy = i3;
+        }
+      }
+    }
+
+   /*----------------------------------------------------------------*
+    * depth first search 1: compare codevector with the best case.   *
+    *----------------------------------------------------------------*/
+
+    s = L_msu(L_mult(alpk, sq), psk, alp);
+    if (s > 0)
+    {
+      psk = sq;
+      alpk = alp;
+      ip3 = i0;
+      ip0 = i1;
+      ip1 = ix;
+      ip2 = iy;
+    }
+
+    ptr_rri0i3_i4 = rri0i4;
+    ptr_rri1i3_i4 = rri1i4;
+    ptr_rri2i3_i4 = rri2i4;
+    ptr_rri3i3_i4 = rri4i4;
+  }
+
+  /* Set the sign of impulses */
+
+  i0 = sign_dn[ip0];
+  i1 = sign_dn[ip1];
+  i2 = sign_dn[ip2];
+  i3 = sign_dn[ip3];
+
+  /* Find the codeword corresponding to the selected positions */
+
+  for(i=0; i<L_SUBFR; i++) {cod[i] = 0; }
+
+  cod[ip0] = shr(i0, 2);         /* From Q15 to Q13 */
+  cod[ip1] = shr(i1, 2);
+  cod[ip2] = shr(i2, 2);
+  cod[ip3] = shr(i3, 2);
+
+  /* find the filtered codeword */
+
+  for (i = 0; i < L_SUBFR; i++) {y[i] = 0; }
+
+  if(i0 > 0)
+    for(i=ip0, j=0; i<L_SUBFR; i++, j++) y[i] = add(y[i], h[j]);
+  else
+    for(i=ip0, j=0; i<L_SUBFR; i++, j++) y[i] = sub(y[i], h[j]);
+
+  if(i1 > 0)
+    for(i=ip1, j=0; i<L_SUBFR; i++, j++) y[i] = add(y[i], h[j]);
+  else
+    for(i=ip1, j=0; i<L_SUBFR; i++, j++) y[i] = sub(y[i], h[j]);
+
+  if(i2 > 0)
+    for(i=ip2, j=0; i<L_SUBFR; i++, j++) y[i] = add(y[i], h[j]);
+  else
+    for(i=ip2, j=0; i<L_SUBFR; i++, j++) y[i] = sub(y[i], h[j]);
+
+  if(i3 > 0)
+    for(i=ip3, j=0; i<L_SUBFR; i++, j++) y[i] = add(y[i], h[j]);
+  else
+    for(i=ip3, j=0; i<L_SUBFR; i++, j++) y[i] = sub(y[i], h[j]);
+
+  /* find codebook index;  17-bit address */
+
+  i = 0;
+  if(i0 > 0) i = add(i, 1);
+  if(i1 > 0) i = add(i, 2);
+  if(i2 > 0) i = add(i, 4);
+  if(i3 > 0) i = add(i, 8);
+  *sign = i;
+
+  ip0 = mult(ip0, 6554);         /* ip0/5 */
+  ip1 = mult(ip1, 6554);         /* ip1/5 */
+  ip2 = mult(ip2, 6554);         /* ip2/5 */
+  i   = mult(ip3, 6554);         /* ip3/5 */
+  j   = add(i, shl(i, 2));       /* j = i*5 */
+  j   = sub(ip3, add(j, 3));     /* j= ip3%5 -3 */
+  ip3 = add(shl(i, 1), j);
+
+  i = add(ip0, shl(ip1, 3));
+  i = add(i  , shl(ip2, 6));
+  i = add(i  , shl(ip3, 9));
+
+  return i;
+}
+
+/* acelp_ca.c: ACELP_Code_A() */
+static Word16
+g729_search_acelp_full (
+  Word16 x[],            /* (i)     :Target vector                */
+  Word16 h[],            /* (i) Q12 :Inpulse response of filters  */
+  Word16 T0,             /* (i)     :Pitch lag                    */
+  Word16 pitch_sharp,    /* (i) Q14 :Last quantized pitch gain    */
+  Word16 code[],         /* (o) Q13 :Innovative codebook          */
+  Word16 y[],            /* (o) Q12 :Filtered innovative codebook */
+  Word16 *sign           /* (o)     :Signs of 4 pulses            */
+)
+{
+  Word16 i, index, sharp;
+  Word16 Dn[L_SUBFR];
+  Word16 rr[DIM_RR];
+
+ /*-----------------------------------------------------------------*
+  * Include fixed-gain pitch contribution into impulse resp. h[]    *
+  * Find correlations of h[] needed for the codebook search.        *
+  *-----------------------------------------------------------------*/
+
+  sharp = shl(pitch_sharp, 1);          /* From Q14 to Q15 */
+  if (sub(T0, L_SUBFR)<0)
+     for (i = T0; i < L_SUBFR; i++)     /* h[i] += pitch_sharp*h[i-T0] */
+       h[i] = add(h[i], mult(h[i-T0], sharp));
+
+  g729_search_cor_h(h, rr);
+
+ /*-----------------------------------------------------------------*
+  * Compute correlation of target vector with impulse response.     *
+  *-----------------------------------------------------------------*/
+
+  g729_kernels_cor_h_x(h, x, Dn);
+
+ /*-----------------------------------------------------------------*
+  * Find innovative codebook.                                       *
+  *-----------------------------------------------------------------*/
+
+  index = g729_search_d4i40_17_fast(Dn, rr, h, code, y, sign);
+
+ /*-----------------------------------------------------------------*
+  * Compute innovation vector gain.                                 *
+  * Include fixed-gain pitch contribution into code[].              *
+  *-----------------------------------------------------------------*/
+
+  if(sub(T0, L_SUBFR) <0)
+     for (i = T0; i < L_SUBFR; i++)    /* code[i] += pitch_sharp*code[i-T0] */
+       code[i] = add(code[i], mult(code[i-T0], sharp));
+
+  return index;
+}
+
+/* acelp_ca.c */
+Word16
+g729_search_acelp_code_a (
+  int complexity,        /* (i)     :Encoder complexity           */
+  Word16 x[],            /* (i)     :Target vector                */
+  Word16 h[],            /* (i) Q12 :Impulse response of filters  */
+  Word16 T0,             /* (i)     :Pitch lag                    */
+  Word16 pitch_sharp,    /* (i) Q14 :Last quantized pitch gain    */
+  Word16 code[],         /* (o) Q13 :Innovative codebook          */
+  Word16 y[],            /* (o) Q12 :Filtered innovative codebook */
+  Word16 *sign           /* (o)     :Signs of 4 pulses            */
+)
+{
+  Word16 dn[L_SUBFR];
+  int cand[G729_SEARCH_TRACKS][G729_SEARCH_CANDIDATES_T3];
+  int n_cand[G729_SEARCH_TRACKS] = { G729_SEARCH_CANDIDATES,
+    G729_SEARCH_CANDIDATES, G729_SEARCH_CANDIDATES,
+    G729_SEARCH_CANDIDATES_T3
+  };
+  int64_t phi[G729_SEARCH_TRACKS][G729_SEARCH_CANDIDATES_T3]
+      [G729_SEARCH_TRACKS][G729_SEARCH_CANDIDATES_T3];
+  int s[G729_SEARCH_TRACKS][G729_SEARCH_CANDIDATES_T3];
+  int pos[G729_SEARCH_TRACKS], best[G729_SEARCH_TRACKS] = { 0, 0, 0, 0 };
+  int k[G729_SEARCH_TRACKS];
+  int t, u, a, b, i, n;
+  double num, den, crit, best_crit = -1.0;
+  Word16 sharp, index;
+
+  if (complexity >= G729_COMPLEXITY_MAX)
+    return g729_search_acelp_full (x, h, T0, pitch_sharp, code, y, sign);
+
+  /* include the pitch sharpening in the impulse response, as the
+   * reference */
+  sharp = shl (pitch_sharp, 1);
+  if (sub (T0, L_SUBFR) < 0) {
+    for (i = T0; i < L_SUBFR; i++)
+      h[i] = add (h[i], mult (h[i - T0], sharp));
+  }
+
+  g729_kernels_cor_h_x (h, x, dn);
+
+  g729_search_candidates (dn, 0, 5, n_cand[0], cand[0]);
+  g729_search_candidates (dn, 1, 5, n_cand[1], cand[1]);
+  g729_search_candidates (dn, 2, 5, n_cand[2], cand[2]);
+  /* track 3: positions 3, 4, 8, 9, ... */
+  {
+    int odd[G729_SEARCH_CANDIDATES_T3], even[G729_SEARCH_CANDIDATES_T3];
+
+    g729_search_candidates (dn, 3, 5, n_cand[3], odd);
+    g729_search_candidates (dn, 4, 5, n_cand[3], even);
+    for (a = 0, b = 0, u = 0; u < n_cand[3]; u++) {
+      if (b >= n_cand[3] || abs (dn[odd[a]]) >= abs (dn[even[b]]))
+        cand[3][u] = odd[a++];
+      else
+        cand[3][u] = even[b++];
+    }
+  }
+
+  /* pulse signs follow the correlation, as in the reference search */
+  for (t = 0; t < G729_SEARCH_TRACKS; t++)
+    for (a = 0; a < n_cand[t]; a++)
+      s[t][a] = dn[cand[t][a]] >= 0 ? 1 : -1;
+
+  for (t = 0; t < G729_SEARCH_TRACKS; t++)
+    for (a = 0; a < n_cand[t]; a++)
+      for (u = t; u < G729_SEARCH_TRACKS; u++)
+        for (b = 0; b < n_cand[u]; b++)
+          phi[t][a][u][b] = s[t][a] * s[u][b] *
+              g729_search_phi (h, cand[t][a], cand[u][b]);
+
+  /* every combination of the candidates, maximising the normalised
+   * correlation with the target */
+  for (k[0] = 0; k[0] < n_cand[0]; k[0]++)
+  for (k[1] = 0; k[1] < n_cand[1]; k[1]++)
+  for (k[2] = 0; k[2] < n_cand[2]; k[2]++)
+  for (k[3] = 0; k[3] < n_cand[3]; k[3]++) {
+    num = 0.0;
+    den = 0.0;
+    for (t = 0; t < G729_SEARCH_TRACKS; t++) {
+      num += abs (dn[cand[t][k[t]]]);
+      den += (double) phi[t][k[t]][t][k[t]];
+      for (u = t + 1; u < G729_SEARCH_TRACKS; u++)
+        den += 2.0 * (double) phi[t][k[t]][u][k[u]];
+    }
+    if (den <= 0.0)
+      continue;
+
+    crit = num * num / den;
+    if (crit > best_crit) {
+      best_crit = crit;
+      for (t = 0; t < G729_SEARCH_TRACKS; t++)
+        best[t] = k[t];
+    }
+  }
+
+  /* code vector, its filtered version and the transmitted indices, laid
+   * out as Decod_ACELP() reads them */
+  for (i = 0; i < L_SUBFR; i++) {
+    code[i] = 0;
+    y[i] = 0;
+  }
+
+  *sign = 0;
+  for (t = 0; t < G729_SEARCH_TRACKS; t++) {
+    pos[t] = cand[t][best[t]];
+    if (s[t][best[t]] > 0) {
+      code[pos[t]] = 8191;
+      *sign = add (*sign, shl (1, t));
+      for (n = pos[t]; n < L_SUBFR; n++)
+        y[n] = add (y[n], h[n - pos[t]]);
+    } else {
+      code[pos[t]] = -8192;
+      for (n = pos[t]; n < L_SUBFR; n++)
+        y[n] = add (y[n], negate (h[n - pos[t]]));
+    }
+  }
+
+  index = pos[0] / 5;
+  index = add (index, shl (pos[1] / 5, 3));
+  index = add (index, shl (pos[2] / 5, 6));
+  index = add (index, shl (pos[3] % 5 == 4 ? 1 : 0, 9));
+  index = add (index, shl (pos[3] / 5, 10));
+
+  if (sub (T0, L_SUBFR) < 0) {
+    for (i = T0; i < L_SUBFR; i++)
+      code[i] = add (code[i], mult (code[i - T0], sharp));
+  }
+
+  return index;
+}
+
+/* Open-loop correlation at lag t over every other sample, and the energy
+ * of the delayed signal */
+static int64_t
+g729_search_ol_corr (const Word16 signal[], int t, int L_frame,
+    int64_t * energy)
+{
+  int64_t corr = 0, e = 0;
+  int j;
+
+  for (j = 0; j < L_frame; j += 2) {
+    corr += (int32_t) signal[j] * signal[j - t];
+    e += (int32_t) signal[j - t] * signal[j - t];
+  }
+
+  *energy = e;
+  return corr;
+}
+
+/* Best lag of [lo, hi] looking at every other lag, refined by one on
+ * both sides; returns the normalised correlation */
+static double
+g729_search_ol_section (const Word16 signal[], int lo, int hi, int L_frame,
+    int *lag)
+{
+  int64_t corr, energy, best_corr, best_energy;
+  int t, best;
+
+  best = lo;
+  best_corr = g729_search_ol_corr (signal, lo, L_frame, &best_energy);
+
+  for (t = lo + 2; t <= hi; t += 2) {
+    corr = g729_search_ol_corr (signal, t, L_frame, &energy);
+    if (corr > best_corr) {
+      best_corr = corr;
+      best_energy = energy;
+      best = t;
+    }
+  }
+
+  for (t = best - 1; t <= best + 1; t += 2) {
+    if (t < lo || t > hi)
+      continue;
+    corr = g729_search_ol_corr (signal, t, L_frame, &energy);
+    if (corr > best_corr) {
+      best_corr = corr;
+      best_energy = energy;
+      best = t;
+    }
+  }
+
+  *lag = best;
+  if (best_corr <= 0 || best_energy == 0)
+    return 0.0;
+
+  return (double) best_corr / sqrt ((double) best_energy);
+}
+
+/* pitch_a.c */
+Word16
+g729_search_pitch_ol_fast (
+  int complexity,      /* input : encoder complexity                         */
+  Word16 signal[],     /* input : signal used to compute the open loop pitch */
+                       /*     signal[-pit_max] to signal[-1] should be known */
+  Word16 pit_max,      /* input : maximum pitch lag                          */
+  Word16 L_frame       /* input : length of frame to compute pitch           */
+)
+{
+  double max1, max2, max3;
+  int t1, t2, t3;
+
+  if (complexity > G729_COMPLEXITY_MIN)
+    return g729_kernels_pitch_ol_fast (signal, pit_max, L_frame);
+
+  max1 = g729_search_ol_section (signal, PIT_MIN, 39, L_frame, &t1);
+  max2 = g729_search_ol_section (signal, 40, 79, L_frame, &t2);
+  max3 = g729_search_ol_section (signal, 80, pit_max, L_frame, &t3);
+
+  /* favour submultiples, with the reference weights */
+  if (abs (2 * t2 - t3) < 5)
+    max2 += max3 * 0.25;
+  if (abs (3 * t2 - t3) < 7)
+    max2 += max3 * 0.25;
+  if (abs (2 * t1 - t2) < 5)
+    max1 += max2 * 0.2;
+  if (abs (3 * t1 - t2) < 7)
+    max1 += max2 * 0.2;
+
+  if (max1 < max2) {
+    max1 = max2;
+    t1 = t2;
+  }
+  if (max1 < max3)
+    t1 = t3;
+
+  return t1;
+}
@@ -0,0 +1,67 @@
+/* GladSToNe g729 reduced searches
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+#ifndef __G729_SEARCH_H__
+#define __G729_SEARCH_H__
+
+/*
+ * Cheaper variants of the Annex A encoder searches, called by
+ * g729_coder_frame() in place of the reference ones with the complexity
+ * of the encoder (see g729.h); at G729_COMPLEXITY_MAX they are the
+ * reference searches. They only change which parameters the encoder
+ * picks, so the bitstream stays standard.
+ */
+
+/* ref code includes: */
+#include "typedef.h"
+
+/* ACELP_Code_A() */
+Word16 g729_search_acelp_code_a (int complexity, Word16 x[], Word16 h[],
+    Word16 T0, Word16 pitch_sharp, Word16 code[], Word16 y[], Word16 *sign);
+
+/* Pitch_ol_fast() */
+Word16 g729_search_pitch_ol_fast (int complexity, Word16 signal[],
+    Word16 pit_max, Word16 L_frame);
+
+#endif /* __G729_SEARCH_H__ */
@@ -0,0 +1,200 @@
+/* GladSToNe g729 codec state
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "g729state.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ref code includes: */
+#include "tab_ld8a.h"
+#include "tab_dtx.h"
+#include "sid.h"
+
+static const Word16 lsp_reset[M] = {
+  30000, 26000, 21000, 15000, 8000, 0, -8000, -15000, -21000, -26000
+};
+
+static const Word16 lsp_sid_reset[M] = {
+  31441, 27566, 21458, 13612, 4663, -4663, -13612, -21458, -27566, -31441
+};
+
+/* The SID LSF quantiser tables are built on first use and only read
+ * afterwards. The reference code rebuilds them on every reset, which
+ * would race with instances running on other threads. */
+static pthread_once_t lsfq_noise_once = PTHREAD_ONCE_INIT;
+
+static void
+g729_state_init_tables (void)
+{
+  pthread_once (&lsfq_noise_once, Init_lsfq_noise);
+}
+
+G729EncState *
+g729_enc_state_new (void)
+{
+  G729EncState *state;
+
+  state = malloc (sizeof (G729EncState));
+  if (!state)
+    return NULL;
+
+  g729_enc_state_reset (state);
+
+  return state;
+}
+
+void
+g729_enc_state_free (G729EncState * state)
+{
+  free (state);
+}
+
+/* Init_Pre_Process(), Init_Coder_ld8a() and the initialised statics of the
+ * encoder files */
+void
+g729_enc_state_reset (G729EncState * state)
+{
+  int i;
+
+  g729_state_init_tables ();
+
+  memset (state, 0, sizeof (G729EncState));
+
+  state->new_speech = state->old_speech + L_TOTAL - L_FRAME;
+  state->speech = state->new_speech - L_NEXT;
+  state->p_window = state->old_speech + L_TOTAL - L_WINDOW;
+  state->wsp = state->old_wsp + PIT_MAX;
+  state->exc = state->old_exc + PIT_MAX + L_INTERPOL;
+
+  memcpy (state->lsp_old, lsp_reset, sizeof (lsp_reset));
+  memcpy (state->lsp_old_q, lsp_reset, sizeof (lsp_reset));
+  state->sharp = SHARPMIN;
+
+  state->old_A[0] = 4096;
+
+  for (i = 0; i < MA_NP; i++)
+    Copy (freq_prev_reset, state->freq_prev[i], M);
+  for (i = 0; i < 4; i++) {
+    state->past_qua_en[i] = -14336;
+    state->L_exc_err[i] = 0x00004000L;
+  }
+
+  /* For G.729B */
+  state->pastVad = 1;
+  state->ppastVad = 1;
+  state->seed = INIT_SEED;
+  g729_vad_init (&state->vad);
+  g729_cng_init (&state->cng);
+}
+
+G729DecState *
+g729_dec_state_new (void)
+{
+  G729DecState *state;
+
+  state = malloc (sizeof (G729DecState));
+  if (!state)
+    return NULL;
+
+  g729_dec_state_reset (state);
+
+  return state;
+}
+
+void
+g729_dec_state_free (G729DecState * state)
+{
+  free (state);
+}
+
+/* Init_Decod_ld8a(), Init_Post_Filter(), Init_Post_Process(),
+ * Init_Dec_cng() and the initialised statics of the decoder files */
+void
+g729_dec_state_reset (G729DecState * state)
+{
+  int i;
+
+  g729_state_init_tables ();
+
+  memset (state, 0, sizeof (G729DecState));
+
+  state->exc = state->old_exc + PIT_MAX + L_INTERPOL;
+  memcpy (state->lsp_old, lsp_reset, sizeof (lsp_reset));
+  state->sharp = SHARPMIN;
+  state->old_T0 = 60;
+
+  for (i = 0; i < MA_NP; i++)
+    Copy (freq_prev_reset, state->freq_prev[i], M);
+  Copy (freq_prev_reset, state->prev_lsp, M);
+  for (i = 0; i < 4; i++)
+    state->past_qua_en[i] = -14336;
+
+  /* for G.729B */
+  state->seed_fer = 21845;
+  state->past_ftyp = 1;
+  state->seed = INIT_SEED;
+  state->sh_sid_sav = 1;
+  memcpy (state->lspSid, lsp_sid_reset, sizeof (lsp_sid_reset));
+  state->sid_gain = tab_Sidgain[0];
+
+  g729_dec_state_reset_output (state);
+
+  state->synth = state->synth_buf + M;
+}
+
+/* Init_Post_Filter() and Init_Post_Process() alone */
+void
+g729_dec_state_reset_output (G729DecState * state)
+{
+  memset (state->res2_buf, 0, sizeof (state->res2_buf));
+  memset (state->scal_res2_buf, 0, sizeof (state->scal_res2_buf));
+  memset (state->mem_syn_pst, 0, sizeof (state->mem_syn_pst));
+  state->res2 = state->res2_buf + PIT_MAX;
+  state->scal_res2 = state->scal_res2_buf + PIT_MAX;
+  state->mem_pre = 0;
+  state->past_gain = 4096;
+
+  memset (&state->post_process, 0, sizeof (state->post_process));
+}
@@ -0,0 +1,277 @@
+/* GladSToNe g729 codec state
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __G729_STATE_H__
+#define __G729_STATE_H__
+
+#include "g729common.h"
+
+/* ref code includes: */
+#include "typedef.h"
+#include "ld8a.h"
+#include "dtx.h"
+
+/*
+ * Codec state. The reference code keeps it in file scope variables; here
+ * every instance has its own copy of it, laid out as in the reference
+ * files it comes from, and the stateful functions of the reference code
+ * are replaced by versions taking it as argument (g729coder.c, g729vad.c,
+ * g729cng.c, g729decoder.c, g729postfilter.c). The stateless reference
+ * functions are called as they are.
+ *
+ * Nothing is shared between instances but read-only tables, so different
+ * instances can run concurrently on different threads; a given instance
+ * must not be used by two threads at once.
+ */
+
+/* pre_proc.c, post_pro.c */
+typedef struct {
+  Word16 y2_hi, y2_lo, y1_hi, y1_lo, x0, x1;
+} G729HighPassState;
+
+/* vad.c */
+typedef struct {
+  Word16 MeanLSF[M];
+  Word16 Min_buffer[16];
+  Word16 Prev_Min, Next_Min, Min;
+  Word16 MeanE, MeanSE, MeanSLE, MeanSZC;
+  Word16 prev_energy;
+  Word16 count_sil, count_update, count_ext;
+  Word16 flag, v_flag, less_count;
+} G729VadState;
+
+/* dtx.c */
+typedef struct {
+  Word16 lspSid_q[M];
+  Word16 pastCoeff[MP1];
+  Word16 RCoeff[MP1];
+  Word16 sh_RCoeff;
+  Word16 Acf[SIZ_ACF];
+  Word16 sh_Acf[NB_CURACF];
+  Word16 sumAcf[SIZ_SUMACF];
+  Word16 sh_sumAcf[NB_SUMACF];
+  Word16 ener[NB_GAIN];
+  Word16 sh_ener[NB_GAIN];
+  Word16 fr_cur;
+  Word16 cur_gain;
+  Word16 nb_ener;
+  Word16 sid_gain;
+  Word16 flag_chang;
+  Word16 prev_energy;
+  Word16 count_fr0;
+} G729CngEncState;
+
+typedef struct _G729EncState G729EncState;
+typedef struct _G729DecState G729DecState;
+
+struct _G729EncState {
+  G729HighPassState pre_process;
+
+  /* cod_ld8a.c */
+  Word16 old_speech[L_TOTAL];
+  Word16 *speech, *p_window;
+  Word16 *new_speech;                       /* where the next frame goes  */
+  Word16 old_wsp[L_FRAME+PIT_MAX];
+  Word16 *wsp;
+  Word16 old_exc[L_FRAME+PIT_MAX+L_INTERPOL];
+  Word16 *exc;
+  Word16 lsp_old[M];
+  Word16 lsp_old_q[M];
+  Word16 mem_w0[M], mem_w[M], mem_zero[M];
+  Word16 sharp;
+  Word16 pastVad;
+  Word16 ppastVad;
+  Word16 seed;
+
+  /* lpc.c: last stable filter, shared by the analysis and the DTX */
+  Word16 old_A[M+1];
+  Word16 old_rc[2];
+
+  /* qua_lsp.c, qua_gain.c, taming.c */
+  Word16 freq_prev[MA_NP][M];
+  Word16 past_qua_en[4];
+  Word32 L_exc_err[4];
+
+  G729VadState vad;
+  G729CngEncState cng;
+
+  Word16 parameters[PRM_SIZE+1];            /* analysis parameters        */
+};
+
+struct _G729DecState {
+  /* dec_ld8a.c */
+  Word16 old_exc[L_FRAME+PIT_MAX+L_INTERPOL];
+  Word16 *exc;
+  Word16 lsp_old[M];
+  Word16 mem_syn[M];
+  Word16 sharp;
+  Word16 old_T0;
+  Word16 gain_code;
+  Word16 gain_pitch;
+  Word16 seed_fer;
+  Word16 past_ftyp;
+  Word16 seed;
+  Word16 sid_sav, sh_sid_sav;
+
+  /* lspdec.c */
+  Word16 freq_prev[MA_NP][M];
+  Word16 prev_ma;
+  Word16 prev_lsp[M];
+
+  /* dec_gain.c */
+  Word16 past_qua_en[4];
+
+  /* dec_sid.c */
+  Word16 cur_gain;
+  Word16 lspSid[M];
+  Word16 sid_gain;
+
+  /* postfilt.c */
+  Word16 res2_buf[PIT_MAX+L_SUBFR];
+  Word16 *res2;
+  Word16 scal_res2_buf[PIT_MAX+L_SUBFR];
+  Word16 *scal_res2;
+  Word16 mem_syn_pst[M];
+  Word16 mem_pre;
+  Word16 past_gain;
+
+  G729HighPassState post_process;
+
+  Word16 vad;
+
+  Word16 parameters[PRM_SIZE+2];            /* parameters used for Synthesis */
+  Word16 decoded_az[MP1*2];                 /* post-filter specific Az       */
+  Word16 pitch_lag[2];                      /* pitch lag over 2 subframes    */
+  Word16 synth_buf[L_FRAME+M];
+  Word16 *synth;
+};
+
+G729EncState *g729_enc_state_new (void);
+void g729_enc_state_free (G729EncState *state);
+void g729_enc_state_reset (G729EncState *state);
+
+G729DecState *g729_dec_state_new (void);
+void g729_dec_state_free (G729DecState *state);
+void g729_dec_state_reset (G729DecState *state);
+/* only the post-filter and post-processing memories */
+void g729_dec_state_reset_output (G729DecState *state);
+
+/* Filters of the encoder input and of the decoder output (g729coder.c,
+ * g729postfilter.c) */
+void g729_pre_process (G729HighPassState *state, Word16 signal[], Word16 lg);
+void g729_post_process (G729HighPassState *state, const Word16 signal[],
+    Word16 out[], Word16 lg);
+
+/* Levinson-Durbin recursion of lpc.c, falling back on the last stable
+ * filter kept in old_A/old_rc (g729coder.c) */
+void g729_levinson (Word16 old_A[], Word16 old_rc[], Word16 Rh[],
+    Word16 Rl[], Word16 A[], Word16 rc[], Word16 *Err);
+
+/* Taming procedure of taming.c (g729coder.c) */
+Word16 g729_taming_test (const Word32 L_exc_err[], Word16 T0,
+    Word16 T0_frac);
+void g729_taming_update (Word32 L_exc_err[], Word16 gain_pit, Word16 T0);
+
+/* Coder_ld8a() on state->new_speech, pre-processed, with the searches of
+ * the given complexity (g729coder.c) */
+void g729_coder_frame (G729EncState *state, Word16 ana[], Word16 frame,
+    Word16 vad_enable, int complexity);
+
+/* The same in three steps, for g729_encoder_encode_interleaved() to run
+ * the filters of several encoders at once (g729lanes.c). f carries the
+ * frame from one step to the next. g729_coder_frame_lpc() returns 0 when
+ * the frame is inactive and already complete; otherwise
+ * g729_coder_frame_filters(), or g729_lanes_coder_filters(), and then
+ * g729_coder_frame_search() finish it. */
+typedef struct {
+  Word16 *ana;                          /* next analysis parameter      */
+  Word16 Aq_t[MP1*2];                   /* quantized A(z), 2 subframes  */
+  Word16 Ap_t[MP1*2];                   /* A(z/gamma), 2 subframes      */
+  Word16 h1[2][L_SUBFR];                /* weighted synthesis impulse
+                                         * responses, 2 subframes       */
+  Flag overflow;                        /* Overflow between the steps   */
+} G729CoderFrame;
+
+int g729_coder_frame_lpc (G729EncState *state, G729CoderFrame *f,
+    Word16 ana[], Word16 frame, Word16 vad_enable);
+void g729_coder_frame_filters (G729EncState *state, G729CoderFrame *f);
+void g729_coder_frame_search (G729EncState *state, G729CoderFrame *f,
+    int complexity);
+void g729_coder_weight_coeffs (Word16 Ap[], Word16 Ap1[]);
+
+/* Lane-parallel g729_pre_process() of n encoders, encoder i reading sample
+ * j from pcm[j * stride + i] into its new_speech, and
+ * g729_coder_frame_filters() of n active frames (g729lanes.c) */
+void g729_lanes_pre_process (G729EncState **states, unsigned int n,
+    const Word16 *pcm, unsigned int stride);
+void g729_lanes_coder_filters (G729EncState **states, G729CoderFrame **f,
+    unsigned int n);
+
+/* vad.c (g729vad.c) */
+void g729_vad_init (G729VadState *state);
+void g729_vad_frame (G729VadState *state, Word16 rc, Word16 *lsf,
+    Word16 *r_h, Word16 *r_l, Word16 exp_R0, Word16 *sigpp,
+    Word16 frm_count, Word16 prev_marker, Word16 pprev_marker,
+    Word16 *marker);
+
+/* dtx.c, dec_sid.c, calcexc.c (g729cng.c). L_exc_err is the taming
+ * state to update on the encoder side, NULL on the decoder side. */
+void g729_cng_init (G729CngEncState *state);
+void g729_cng_update (G729CngEncState *state, Word16 *r_h, Word16 exp_r,
+    Word16 Vad);
+void g729_cng_encode (G729EncState *state, Word16 *exc, Word16 pastVad,
+    Word16 *Aq, Word16 *ana);
+void g729_cng_decode (G729DecState *state, Word16 past_ftyp,
+    Word16 sid_sav, Word16 sh_sid_sav, Word16 *parm, Word16 *exc,
+    Word16 *A_t);
+void g729_cng_excitation (Word16 cur_gain, Word16 *exc, Word16 *seed,
+    Word32 *L_exc_err);
+
+/* Decod_ld8a() (g729decoder.c) */
+void g729_decod_frame (G729DecState *state, Word16 parm[], Word16 synth[],
+    Word16 A_t[], Word16 *T2, Word16 *Vad);
+
+/* Post_Filter() (g729postfilter.c) */
+void g729_post_filter (G729DecState *state, Word16 *syn, Word16 *Az_4,
+    Word16 *T, Word16 Vad);
+
+#endif /* __G729_STATE_H__ */
@@ -0,0 +1,457 @@
+/* GladSToNe g729 voice activity detection
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/*
+ * The Annex B voice activity detector of vad.c, operating on a
+ * G729VadState instead of file scope variables.
+ */
+
+#include "g729state.h"
+
+/* ref code includes: */
+#include "basic_op.h"
+#include "oper_32b.h"
+#include "tab_ld8a.h"
+#include "vad.h"
+#include "tab_dtx.h"
+
+void
+g729_vad_init (G729VadState * state)
+{
+  /* Static vectors to zero */
+  Set_zero(state->MeanLSF, M);
+
+  /* Initialize VAD parameters */
+  state->MeanSE = 0;
+  state->MeanSLE = 0;
+  state->MeanE = 0;
+  state->MeanSZC = 0;
+  state->count_sil = 0;
+  state->count_update = 0;
+  state->count_ext = 0;
+  state->less_count = 0;
+  state->flag = 1;
+  state->Min = MAX_16;
+}
+
+/* Decision on the differential parameters, by the 14 boundaries of the
+ * reference */
+static Word16
+g729_vad_make_dec (
+               Word16 dSLE,    /* (i)  : differential low band energy */
+               Word16 dSE,     /* (i)  : differential full band energy */
+               Word16 SD,      /* (i)  : differential spectral distortion */
+               Word16 dSZC     /* (i)  : differential zero crossing rate */
+               )
+{
+  Word32 acc0;
+
+  /* SD vs dSZC */
+  acc0 = L_mult(dSZC, -14680);          /* Q15*Q23*2 = Q39 */
+  acc0 = L_mac(acc0, 8192, -28521);     /* Q15*Q23*2 = Q39 */
+  acc0 = L_shr(acc0, 8);                /* Q39 -> Q31 */
+  acc0 = L_add(acc0, L_deposit_h(SD));
+  if (acc0 > 0) return(VOICE);
+
+  acc0 = L_mult(dSZC, 19065);           /* Q15*Q22*2 = Q38 */
+  acc0 = L_mac(acc0, 8192, -19446);     /* Q15*Q22*2 = Q38 */
+  acc0 = L_shr(acc0, 7);                /* Q38 -> Q31 */
+  acc0 = L_add(acc0, L_deposit_h(SD));
+  if (acc0 > 0) return(VOICE);
+
+  /* dSE vs dSZC */
+  acc0 = L_mult(dSZC, 20480);           /* Q15*Q13*2 = Q29 */
+  acc0 = L_mac(acc0, 8192, 16384);      /* Q13*Q15*2 = Q29 */
+  acc0 = L_shr(acc0, 2);                /* Q29 -> Q27 */
+  acc0 = L_add(acc0, L_deposit_h(dSE));
+  if (acc0 < 0) return(VOICE);
+
+  acc0 = L_mult(dSZC, -16384);          /* Q15*Q13*2 = Q29 */
+  acc0 = L_mac(acc0, 8192, 19660);      /* Q13*Q15*2 = Q29 */
+  acc0 = L_shr(acc0, 2);                /* Q29 -> Q27 */
+  acc0 = L_add(acc0, L_deposit_h(dSE));
+  if (acc0 < 0) return(VOICE);
+
+  acc0 = L_mult(dSE, 32767);            /* Q11*Q15*2 = Q27 */
+  acc0 = L_mac(acc0, 1024, 30802);      /* Q10*Q16*2 = Q27 */
+  if (acc0 < 0) return(VOICE);
+
+  /* dSE vs SD */
+  acc0 = L_mult(SD, -28160);            /* Q15*Q5*2 = Q21 */
+  acc0 = L_mac(acc0, 64, 19988);        /* Q6*Q14*2 = Q21 */
+  acc0 = L_mac(acc0, dSE, 512);         /* Q11*Q9*2 = Q21 */
+  if (acc0 < 0) return(VOICE);
+
+  acc0 = L_mult(SD, 32767);             /* Q15*Q15*2 = Q31 */
+  acc0 = L_mac(acc0, 32, -30199);       /* Q5*Q25*2 = Q31 */
+  if (acc0 > 0) return(VOICE);
+
+  /* dSLE vs dSZC */
+  acc0 = L_mult(dSZC, -20480);          /* Q15*Q13*2 = Q29 */
+  acc0 = L_mac(acc0, 8192, 22938);      /* Q13*Q15*2 = Q29 */
+  acc0 = L_shr(acc0, 2);                /* Q29 -> Q27 */
+  acc0 = L_add(acc0, L_deposit_h(dSLE));
+  if (acc0 < 0) return(VOICE);
+
+  acc0 = L_mult(dSZC, 23831);           /* Q15*Q13*2 = Q29 */
+  acc0 = L_mac(acc0, 4096, 31576);      /* Q12*Q16*2 = Q29 */
+  acc0 = L_shr(acc0, 2);                /* Q29 -> Q27 */
+  acc0 = L_add(acc0, L_deposit_h(dSLE));
+  if (acc0 < 0) return(VOICE);
+
+  acc0 = L_mult(dSLE, 32767);           /* Q11*Q15*2 = Q27 */
+  acc0 = L_mac(acc0, 2048, 17367);      /* Q11*Q15*2 = Q27 */
+  if (acc0 < 0) return(VOICE);
+
+  /* dSLE vs SD */
+  acc0 = L_mult(SD, -22400);            /* Q15*Q4*2 = Q20 */
+  acc0 = L_mac(acc0, 32, 25395);        /* Q5*Q14*2 = Q20 */
+  acc0 = L_mac(acc0, dSLE, 256);        /* Q11*Q8*2 = Q20 */
+  if (acc0 < 0) return(VOICE);
+
+  /* dSLE vs dSE */
+  acc0 = L_mult(dSE, -30427);           /* Q11*Q15*2 = Q27 */
+  acc0 = L_mac(acc0, 256, -29959);      /* Q8*Q18*2 = Q27 */
+  acc0 = L_add(acc0, L_deposit_h(dSLE));
+  if (acc0 > 0) return(VOICE);
+
+  acc0 = L_mult(dSE, 24576);            /* Q11*Q14*2 = Q26 */
+  acc0 = L_mac(acc0, 1024, 29491);      /* Q10*Q15*2 = Q26 */
+  acc0 = L_mac(acc0, dSLE, 16384);      /* Q11*Q14*2 = Q26 */
+  if (acc0 < 0) return(VOICE);
+
+  acc0 = L_mult(dSE, -23406);           /* Q11*Q15*2 = Q27 */
+  acc0 = L_mac(acc0, 512, 28087);       /* Q9*Q17*2 = Q27 */
+  acc0 = L_add(acc0, L_deposit_h(dSLE));
+  if (acc0 < 0) return(VOICE);
+
+  return(NOISE);
+}
+
+/* vad.c: vad() */
+void
+g729_vad_frame (
+         G729VadState *state,
+         Word16 rc,
+         Word16 *lsf,
+         Word16 *r_h,
+         Word16 *r_l,
+         Word16 exp_R0,
+         Word16 *sigpp,
+         Word16 frm_count,
+         Word16 prev_marker,
+         Word16 pprev_marker,
+         Word16 *marker)
+{
+  G729VadState *s = state;
+
+  /* scalar */
+  Word32 acc0;
+  Word16 i, j, exp, frac;
+  Word16 ENERGY, ENERGY_low, SD, ZC, dSE, dSLE, dSZC;
+  Word16 COEF, C_COEF, COEFZC, C_COEFZC, COEFSD, C_COEFSD;
+
+  /* compute the frame energy */
+  acc0 = L_Comp(r_h[0], r_l[0]);
+  Log2(acc0, &exp, &frac);
+  acc0 = Mpy_32_16(exp, frac, 9864);
+  i = sub(exp_R0, 1);
+  i = sub(i, 1);
+  acc0 = L_mac(acc0, 9864, i);
+  acc0 = L_shl(acc0, 11);
+  ENERGY = extract_h(acc0);
+  ENERGY = sub(ENERGY, 4875);
+
+  /* compute the low band energy */
+  acc0 = 0;
+  for (i=1; i<=NP; i++)
+    acc0 = L_mac(acc0, r_h[i], lbf_corr[i]);
+  acc0 = L_shl(acc0, 1);
+  acc0 = L_mac(acc0, r_h[0], lbf_corr[0]);
+  Log2(acc0, &exp, &frac);
+  acc0 = Mpy_32_16(exp, frac, 9864);
+  i = sub(exp_R0, 1);
+  i = sub(i, 1);
+  acc0 = L_mac(acc0, 9864, i);
+  acc0 = L_shl(acc0, 11);
+  ENERGY_low = extract_h(acc0);
+  ENERGY_low = sub(ENERGY_low, 4875);
+
+  /* compute SD */
+  acc0 = 0;
+  for (i=0; i<M; i++){
+    j = sub(lsf[i], s->MeanLSF[i]);
+    acc0 = L_mac(acc0, j, j);
+  }
+  SD = extract_h(acc0);      /* Q15 */
+
+  /* compute # zero crossing */
+  ZC = 0;
+  for (i=ZC_START+1; i<=ZC_END; i++)
+    if (mult(sigpp[i-1], sigpp[i]) < 0)
+      ZC = add(ZC, 410);     /* Q15 */
+
+  /* Initialize and update Mins */
+  if(sub(frm_count, 129) < 0){
+    if (sub(ENERGY, s->Min) < 0){
+      s->Min = ENERGY;
+      s->Prev_Min = ENERGY;
+    }
+
+    if((frm_count & 0x0007) == 0){
+      i = sub(shr(frm_count,3),1);
+      s->Min_buffer[i] = s->Min;
+      s->Min = MAX_16;
+    }
+  }
+
+  if((frm_count & 0x0007) == 0){
+    s->Prev_Min = s->Min_buffer[0];
+    for (i=1; i<16; i++){
+      if (sub(s->Min_buffer[i], s->Prev_Min) < 0)
+        s->Prev_Min = s->Min_buffer[i];
+    }
+  }
+
+  if(sub(frm_count, 129) >= 0){
+    if(((frm_count & 0x0007) ^ (0x0001)) == 0){
+      s->Min = s->Prev_Min;
+      s->Next_Min = MAX_16;
+    }
+    if (sub(ENERGY, s->Min) < 0)
+      s->Min = ENERGY;
+    if (sub(ENERGY, s->Next_Min) < 0)
+      s->Next_Min = ENERGY;
+
+    if((frm_count & 0x0007) == 0){
+      for (i=0; i<15; i++)
+        s->Min_buffer[i] = s->Min_buffer[i+1];
+      s->Min_buffer[15] = s->Next_Min;
+      s->Prev_Min = s->Min_buffer[0];
+      for (i=1; i<16; i++)
+        if (sub(s->Min_buffer[i], s->Prev_Min) < 0)
+          s->Prev_Min = s->Min_buffer[i];
+    }
+
+  }
+
+  if (sub(frm_count, INIT_FRAME) <= 0){
+    if(sub(ENERGY, 3072) < 0){
+      *marker = NOISE;
+      s->less_count++;
+    }
+    else{
+      *marker = VOICE;
+      acc0 = L_deposit_h(s->MeanE);
+      acc0 = L_mac(acc0, ENERGY, 1024);
+      s->MeanE = extract_h(acc0);
+      acc0 = L_deposit_h(s->MeanSZC);
+      acc0 = L_mac(acc0, ZC, 1024);
+      s->MeanSZC = extract_h(acc0);
+      for (i=0; i<M; i++){
+        acc0 = L_deposit_h(s->MeanLSF[i]);
+        acc0 = L_mac(acc0, lsf[i], 1024);
+        s->MeanLSF[i] = extract_h(acc0);
+      }
+    }
+  }
+
+  if (sub(frm_count, INIT_FRAME) >= 0){
+    if (sub(frm_count, INIT_FRAME) == 0){
+      acc0 = L_mult(s->MeanE, factor_fx[s->less_count]);
+      acc0 = L_shl(acc0, shift_fx[s->less_count]);
+      s->MeanE = extract_h(acc0);
+
+      acc0 = L_mult(s->MeanSZC, factor_fx[s->less_count]);
+      acc0 = L_shl(acc0, shift_fx[s->less_count]);
+      s->MeanSZC = extract_h(acc0);
+
+      for (i=0; i<M; i++){
+        acc0 = L_mult(s->MeanLSF[i], factor_fx[s->less_count]);
+        acc0 = L_shl(acc0, shift_fx[s->less_count]);
+        s->MeanLSF[i] = extract_h(acc0);
+      }
+
+      s->MeanSE = sub(s->MeanE, 2048);   /* Q11 */
+      s->MeanSLE = sub(s->MeanE, 2458);  /* Q11 */
+    }
+
+    dSE = sub(s->MeanSE, ENERGY);
+    dSLE = sub(s->MeanSLE, ENERGY_low);
+    dSZC = sub(s->MeanSZC, ZC);
+
+    if(sub(ENERGY, 3072) < 0)
+      *marker = NOISE;
+    else
+      *marker = g729_vad_make_dec(dSLE, dSE, SD, dSZC);
+
+    s->v_flag = 0;
+    if((prev_marker==VOICE) && (*marker==NOISE) && (add(dSE,410) < 0)
+       && (sub(ENERGY, 3072)>0)){
+      *marker = VOICE;
+      s->v_flag = 1;
+    }
+
+    if(s->flag == 1){
+      if((pprev_marker == VOICE) &&
+         (prev_marker == VOICE) &&
+         (*marker == NOISE) &&
+         (sub(abs_s(sub(s->prev_energy,ENERGY)), 614) <= 0)){
+        s->count_ext++;
+        *marker = VOICE;
+        s->v_flag = 1;
+        if(sub(s->count_ext, 4) <= 0)
+          s->flag=1;
+        else{
+          s->count_ext=0;
+          s->flag=0;
+        }
+      }
+    }
+    else
+      s->flag=1;
+
+    if(*marker == NOISE)
+      s->count_sil++;
+
+    if((*marker == VOICE) && (sub(s->count_sil, 10) > 0) &&
+       (sub(sub(ENERGY,s->prev_energy), 614) <= 0)){
+      *marker = NOISE;
+      s->count_sil=0;
+    }
+
+    if(*marker == VOICE)
+      s->count_sil=0;
+
+    if ((sub(sub(ENERGY, 614), s->MeanSE) < 0) && (sub(frm_count, 128) > 0)
+        && (!s->v_flag) && (sub(rc, 19661) < 0))
+      *marker = NOISE;
+
+    if ((sub(sub(ENERGY,614),s->MeanSE) < 0) && (sub(rc, 24576) < 0)
+        && (sub(SD, 83) < 0)){
+      s->count_update++;
+      if (sub(s->count_update, INIT_COUNT) < 0){
+        COEF = 24576;
+        C_COEF = 8192;
+        COEFZC = 26214;
+        C_COEFZC = 6554;
+        COEFSD = 19661;
+        C_COEFSD = 13107;
+      }
+      else
+        if (sub(s->count_update, INIT_COUNT+10) < 0){
+          COEF = 31130;
+          C_COEF = 1638;
+          COEFZC = 30147;
+          C_COEFZC = 2621;
+          COEFSD = 21299;
+          C_COEFSD = 11469;
+        }
+        else
+          if (sub(s->count_update, INIT_COUNT+20) < 0){
+            COEF = 31785;
+            C_COEF = 983;
+            COEFZC = 30802;
+            C_COEFZC = 1966;
+            COEFSD = 22938;
+            C_COEFSD = 9830;
+          }
+          else
+            if (sub(s->count_update, INIT_COUNT+30) < 0){
+              COEF = 32440;
+              C_COEF = 328;
+              COEFZC = 31457;
+              C_COEFZC = 1311;
+              COEFSD = 24576;
+              C_COEFSD = 8192;
+            }
+            else
+              if (sub(s->count_update, INIT_COUNT+40) < 0){
+                COEF = 32604;
+                C_COEF = 164;
+                COEFZC = 32440;
+                C_COEFZC = 328;
+                COEFSD = 24576;
+                C_COEFSD = 8192;
+              }
+              else{
+                COEF = 32604;
+                C_COEF = 164;
+                COEFZC = 32702;
+                C_COEFZC = 66;
+                COEFSD = 24576;
+                C_COEFSD = 8192;
+              }
+
+      /* compute MeanSE */
+      acc0 = L_mult(COEF, s->MeanSE);
+      acc0 = L_mac(acc0, C_COEF, ENERGY);
+      s->MeanSE = extract_h(acc0);
+
+      /* compute MeanSLE */
+      acc0 = L_mult(COEF, s->MeanSLE);
+      acc0 = L_mac(acc0, C_COEF, ENERGY_low);
+      s->MeanSLE = extract_h(acc0);
+
+      /* compute MeanSZC */
+      acc0 = L_mult(COEFZC, s->MeanSZC);
+      acc0 = L_mac(acc0, C_COEFZC, ZC);
+      s->MeanSZC = extract_h(acc0);
+
+      /* compute MeanLSF */
+      for (i=0; i<M; i++){
+        acc0 = L_mult(COEFSD, s->MeanLSF[i]);
+        acc0 = L_mac(acc0, C_COEFSD, lsf[i]);
+        s->MeanLSF[i] = extract_h(acc0);
+      }
+    }
+
+    if((sub(frm_count, 128) > 0) && (((sub(s->MeanSE,s->Min) < 0) &&
+                        (sub(SD, 83) < 0)) || (sub(s->MeanSE,s->Min) > 2048))){
+      s->MeanSE = s->Min;
+      s->count_update = 0;
+    }
+  }
+
+  s->prev_energy = ENERGY;
+}
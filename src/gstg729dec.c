@@ -48,10 +48,44 @@
  *
  * This element decodes a G729 stream to raw integer audio.
  *
+ * With the #GstAudioDecoder:plc property set, lost frames (GAP events, or
+ * timestamp jumps on discontinuous buffers) are synthesised through the
+ * codec frame erasure concealment instead of leaving holes.
+ *
+ * With #GstG729Dec:comfort-noise unset, Annex B DTX periods (SID and
+ * untransmitted frames) come out as silent buffers flagged GAP. They still
+ * go through the decoder, whose state the speech after them depends on,
+ * but skip the post-filter, the post-processing and the output, which
+ * start over from silence when speech resumes.
+ *
+ * Unsetting #GstG729Dec:postfilter skips the perceptual post-filter, which
+ * takes a sizeable share of the decoding time and isn't needed when the
+ * output feeds a machine (speech recognition, level metering, transcoding
+ * to a wider-band codec) rather than a listener.
+ *
+ * The src pad can also produce G.711 (audio/x-mulaw, audio/x-alaw),
+ * companded through lookup tables on the way out of the codec, so that
+ * transcoding to a PSTN leg needs no encoder element after it.
+ *
+ * The element also takes RTP packets (RFC 3551) straight from the network,
+ * without a depayloader. Mono payloads are read straight from the mapped
+ * packet, with no intermediate payload buffer; duplicate and late packets
+ * are dropped, and with plc on the frames of missing sequence numbers are
+ * concealed.
+ *
+ * #GstG729Dec:stats counts the speech, SID, untransmitted and erased
+ * (concealed) frames and the buffers rejected for their size, and keeps a
+ * histogram of the time spent decoding each channel frame. With
+ * #GstG729Dec:stats-interval set, the same structure is also posted as an
+ * element message every time that much audio has been decoded.
+ *
  * <refsect2>
  * <title>Example pipelines</title>
- * TODO
- * documentation of g729dec.
+ * |[
+ * gst-launch-1.0 udpsrc port=5004 caps="application/x-rtp, media=audio, \
+ *     clock-rate=8000, encoding-name=G729" ! rtpjitterbuffer ! \
+ *     g729dec plc=true ! autoaudiosink
+ * ]| receive and play a G729 rtp stream.
  * </refsect2>
  *
  */
@@ -63,11 +97,14 @@
 #include "gstg729dec.h"
 #include <string.h>
 
-void Init_Dec_cng(void);
-
 GST_DEBUG_CATEGORY_EXTERN (g729dec_debug);
 #define GST_CAT_DEFAULT g729dec_debug
 
+#define G729_FRAME_DURATION (FRAME_DURATION * GST_MSECOND)
+
+/* longest timestamp gap concealed, 500 ms */
+#define MAX_CONCEALED_FRAMES 50
+
 static GstStaticPadTemplate g729_dec_src_factory =
 GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
@@ -76,34 +113,96 @@ GST_STATIC_PAD_TEMPLATE ("src",
         "audio/x-raw,"
         "format = (string) " GST_AUDIO_NE (S16) ", "
         "rate = (int) 8000,"
-        "channels = (int) 1, "
-        "layout = (string) interleaved")
+        "channels = (int) [ 1, " G_STRINGIFY (G729_MAX_CHANNELS) " ], "
+        "layout = (string) interleaved; "
+        "audio/x-mulaw, "
+        "rate = (int) 8000, "
+        "channels = (int) [ 1, " G_STRINGIFY (G729_MAX_CHANNELS) " ]; "
+        "audio/x-alaw, "
+        "rate = (int) 8000, "
+        "channels = (int) [ 1, " G_STRINGIFY (G729_MAX_CHANNELS) " ]")
     );
 
 static GstStaticPadTemplate g729_dec_sink_factory =
 GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS ("audio/G729, "
-        "rate = (int) 8000, "
-        "channels = (int) 1")
+    GST_STATIC_CAPS (G729_CAPS "; "
+        "application/x-rtp, "
+        "media = (string) audio, "
+        "clock-rate = (int) 8000, "
+        "encoding-name = (string) G729")
     );
 
+#define DEFAULT_COMFORT_NOISE   TRUE
+#define DEFAULT_POSTFILTER      TRUE
+#define DEFAULT_STATS_INTERVAL  0
+
+#define STATS_NAME              "application/x-g729dec-stats"
+
+enum
+{
+  PROP_0,
+  PROP_COMFORT_NOISE,
+  PROP_POSTFILTER,
+  PROP_STATS,
+  PROP_STATS_INTERVAL,
+};
+
 G_DEFINE_TYPE (GstG729Dec, gst_g729_dec, GST_TYPE_AUDIO_DECODER);
 
+static void gst_g729_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_g729_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+
 static gboolean gst_g729_dec_set_format (GstAudioDecoder *adec, GstCaps *caps);
+static gboolean gst_g729_dec_start (GstAudioDecoder *adec);
 static gboolean gst_g729_dec_stop (GstAudioDecoder *adec);
+static void gst_g729_dec_flush (GstAudioDecoder *adec, gboolean hard);
+static gboolean gst_g729_dec_decide_allocation (GstAudioDecoder *adec, GstQuery *query);
+static gboolean gst_g729_dec_negotiate (GstAudioDecoder *adec);
+static void gst_g729_dec_finalize (GObject * object);
+static void gst_g729_dec_free_channels (GstG729Dec * dec);
+static void gst_g729_dec_free_pool (GstG729Dec * dec);
 static GstFlowReturn gst_g729_dec_handle_frame (GstAudioDecoder *adec, GstBuffer *buf);
 
 static void
 gst_g729_dec_class_init (GstG729DecClass * klass)
 {
+  GObjectClass *gobject_class;
   GstElementClass *gstelement_class;
   GstAudioDecoderClass *gstaudiodecoder_class;
 
+  gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
   gstaudiodecoder_class = (GstAudioDecoderClass *) klass;
 
+  gobject_class->set_property = gst_g729_dec_set_property;
+  gobject_class->get_property = gst_g729_dec_get_property;
+  gobject_class->finalize = gst_g729_dec_finalize;
+
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_COMFORT_NOISE,
+      g_param_spec_boolean ("comfort-noise", "Comfort noise",
+          "Synthesise comfort noise during DTX periods, instead of pushing "
+          "silent GAP buffers", DEFAULT_COMFORT_NOISE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_POSTFILTER,
+      g_param_spec_boolean ("postfilter", "Post-filter",
+          "Apply the perceptual post-filter to the decoded speech",
+          DEFAULT_POSTFILTER, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Frame counters and per-frame decoding time (p50/p99/max in ns) "
+          "since the element started", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_STATS_INTERVAL,
+      g_param_spec_uint64 ("stats-interval", "Statistics interval",
+          "Post the statistics as an element message every time this much "
+          "audio has been decoded (in ns, 0 = never)",
+          0, G_MAXUINT64, DEFAULT_STATS_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&g729_dec_src_factory));
   gst_element_class_add_pad_template (gstelement_class,
@@ -113,45 +212,121 @@ gst_g729_dec_class_init (GstG729DecClass * klass)
     "decode g729 streams to audio",
     "Gibro Vacco <gibrovacco@gmail.com>");
 
+  gstaudiodecoder_class->start = GST_DEBUG_FUNCPTR (gst_g729_dec_start);
   gstaudiodecoder_class->stop = GST_DEBUG_FUNCPTR (gst_g729_dec_stop);
+  gstaudiodecoder_class->flush = GST_DEBUG_FUNCPTR (gst_g729_dec_flush);
   gstaudiodecoder_class->handle_frame = GST_DEBUG_FUNCPTR (gst_g729_dec_handle_frame);
   gstaudiodecoder_class->set_format = GST_DEBUG_FUNCPTR (gst_g729_dec_set_format);
+  gstaudiodecoder_class->decide_allocation = GST_DEBUG_FUNCPTR (gst_g729_dec_decide_allocation);
+  gstaudiodecoder_class->negotiate = GST_DEBUG_FUNCPTR (gst_g729_dec_negotiate);
 }
 
-/* TODO: move elsewhere */
-Word16 bad_lsf = 0;
+static void
+gst_g729_dec_init (GstG729Dec * dec)
+{
+  gst_audio_decoder_set_drainable (GST_AUDIO_DECODER (dec), TRUE);
+  gst_audio_decoder_set_plc_aware (GST_AUDIO_DECODER (dec), TRUE);
+
+  dec->next_ts = GST_CLOCK_TIME_NONE;
+  dec->comfort_noise = DEFAULT_COMFORT_NOISE;
+  dec->postfilter = DEFAULT_POSTFILTER;
+  dec->stats_interval = DEFAULT_STATS_INTERVAL;
+
+  gst_g729_stats_init (&dec->stats);
+}
 
 static void
-gst_g729_dec_reset (GstG729Dec * dec)
+gst_g729_dec_finalize (GObject * object)
 {
-  dec->vad = 0;
-
-  /* ref code specific */
-  Init_Decod_ld8a();
-  Init_Post_Filter();
-  Init_Post_Process();
-  Init_Dec_cng();
-
-  /*
-   * Reference code input data initialisation
-   * First word: synchronization
-   * Second word: size
-   * subsequent 80 words: 1 word per bit (0x007f->0 0x0081->1)
-   */
-  ((guchar*)dec->refcode_input)[0]=0x21;
-  ((guchar*)dec->refcode_input)[1]=0x6B;
-  ((guchar*)dec->refcode_input)[2]=0x50;
-  ((guchar*)dec->refcode_input)[3]=0x00;
-
-  memset(dec->synth_buf,0,sizeof(dec->synth_buf));
-  dec->synth = dec->synth_buf + M;
+  GstG729Dec *dec = GST_G729_DEC (object);
+
+  gst_g729_dec_free_pool (dec);
+  gst_g729_dec_free_channels (dec);
+  gst_g729_stats_clear (&dec->stats);
+
+  G_OBJECT_CLASS (gst_g729_dec_parent_class)->finalize (object);
 }
 
 static void
-gst_g729_dec_init (GstG729Dec * dec)
+gst_g729_dec_free_channels (GstG729Dec * dec)
 {
-  gst_audio_decoder_set_drainable (GST_AUDIO_DECODER (dec), FALSE);
-  gst_g729_dec_reset (dec);
+  guint i;
+
+  for (i = 0; i < dec->channels; i++)
+    g729_decoder_free (dec->decoders[i]);
+
+  g_free (dec->decoders);
+  g_free (dec->pcm);
+
+  dec->decoders = NULL;
+  dec->pcm = NULL;
+  dec->channels = 0;
+}
+
+static gboolean
+gst_g729_dec_alloc_channels (GstG729Dec * dec, guint channels)
+{
+  guint i;
+
+  gst_g729_dec_free_channels (dec);
+
+  dec->decoders = g_new0 (G729Decoder *, channels);
+  dec->pcm = g_new (gint16, channels * RAW_FRAME_SAMPLES);
+  dec->channels = channels;
+
+  for (i = 0; i < channels; i++) {
+    dec->decoders[i] = g729_decoder_new ();
+    if (!dec->decoders[i])
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+gst_g729_dec_free_pool (GstG729Dec * dec)
+{
+  if (dec->pool) {
+    gst_buffer_pool_set_active (dec->pool, FALSE);
+    gst_object_unref (dec->pool);
+    dec->pool = NULL;
+  }
+}
+
+/* Back to the initial codec state; the instances are kept, so this is
+ * cheap enough to run for every new stream */
+static void
+gst_g729_dec_reset_channels (GstG729Dec * dec)
+{
+  guint i;
+
+  for (i = 0; i < dec->channels; i++)
+    g729_decoder_reset (dec->decoders[i]);
+
+  dec->next_ts = GST_CLOCK_TIME_NONE;
+  dec->rtp_synced = FALSE;
+}
+
+static gboolean
+gst_g729_dec_start (GstAudioDecoder *adec)
+{
+  GstG729Dec * dec = GST_G729_DEC (adec);
+
+  gst_g729_dec_reset_channels (dec);
+  gst_g729_stats_reset (&dec->stats);
+
+  return TRUE;
+}
+
+static void
+gst_g729_dec_flush (GstAudioDecoder *adec, gboolean hard)
+{
+  GstG729Dec * dec = GST_G729_DEC (adec);
+
+  /* soft flushes come with discontinuities, where the state is what
+   * conceals the lost frames */
+  if (hard)
+    gst_g729_dec_reset_channels (dec);
 }
 
 static gboolean
@@ -159,7 +334,11 @@ gst_g729_dec_stop (GstAudioDecoder *adec)
 {
   GstG729Dec * dec = GST_G729_DEC (adec);
 
-  gst_g729_dec_reset (dec);
+  gst_g729_dec_free_pool (dec);
+
+  GST_INFO_OBJECT (dec, "concealed %" G_GUINT64_FORMAT " frames",
+      dec->stats.erased);
+  dec->next_ts = GST_CLOCK_TIME_NONE;
 
   return TRUE;
 }
@@ -167,96 +346,320 @@ gst_g729_dec_stop (GstAudioDecoder *adec)
 static gboolean
 gst_g729_dec_set_format (GstAudioDecoder *adec, GstCaps *caps)
 {
-  GstCaps *outcaps;
+  GstG729Dec * dec = GST_G729_DEC (adec);
+  GstStructure *s;
   GstAudioInfo info;
+  GstCaps *allowed;
+  gint channels = 1;
+
+  s = gst_caps_get_structure (caps, 0);
+  gst_structure_get_int (s, "channels", &channels);
+
+  /* RTP G729 is mono (RFC 3551) */
+  dec->rtp = gst_structure_has_name (s, "application/x-rtp");
+  if (dec->rtp)
+    channels = 1;
+
+  /* multi-channel input must say it has the framing of g729enc */
+  if (channels > 1 && g_strcmp0 (gst_structure_get_string (s, "layout"),
+          G729_LAYOUT_SIZED) != 0) {
+    GST_ERROR_OBJECT (dec, "%d channels without layout=" G729_LAYOUT_SIZED,
+        channels);
+    return FALSE;
+  }
+
+  /* codec states survive renegotiation as long as the layout stays */
+  if (dec->channels != channels) {
+    if (!gst_g729_dec_alloc_channels (dec, channels)) {
+      gst_g729_dec_free_channels (dec);
+      GST_ELEMENT_ERROR (dec, RESOURCE, FAILED, (NULL),
+          ("failed to allocate codec state"));
+      return FALSE;
+    }
+  }
+
+  /* G.711 when downstream prefers it, e.g. a PSTN leg payloader */
+  dec->law = G729_G711_NONE;
+  allowed = gst_pad_get_allowed_caps (GST_AUDIO_DECODER_SRC_PAD (adec));
+  if (allowed && !gst_caps_is_empty (allowed)) {
+    s = gst_caps_get_structure (allowed, 0);
+    if (gst_structure_has_name (s, "audio/x-mulaw"))
+      dec->law = G729_G711_ULAW;
+    else if (gst_structure_has_name (s, "audio/x-alaw"))
+      dec->law = G729_G711_ALAW;
+  }
+  if (allowed)
+    gst_caps_unref (allowed);
+
+  /* The base class only describes raw audio: G.711 is U8 to it, which has
+   * the same layout and keeps its sample accounting right, and
+   * negotiate() sets the real caps */
+  gst_audio_info_init (&info);
+  if (dec->law != G729_G711_NONE) {
+    gst_audio_info_set_format (&info, GST_AUDIO_FORMAT_U8, SAMPLE_RATE,
+        channels, NULL);
+    gst_g729_dec_free_pool (dec);
+  } else {
+    gst_audio_info_set_format (&info, GST_AUDIO_FORMAT_S16, SAMPLE_RATE,
+        channels, NULL);
+  }
+  dec->block_bytes = GST_AUDIO_INFO_BPF (&info) * RAW_FRAME_SAMPLES;
+  dec->law_negotiated = FALSE;
+
+  return gst_audio_decoder_set_output_format (adec, &info);
+}
+
+/* G.711 output gets its caps pushed here, and its buffers from the
+ * default allocator. The base class keeps asking while its own format
+ * hasn't been negotiated, hence the flag. */
+static gboolean
+gst_g729_dec_negotiate (GstAudioDecoder *adec)
+{
+  GstG729Dec * dec = GST_G729_DEC (adec);
+  GstCaps *caps;
   gboolean ret;
 
-  outcaps = gst_pad_get_pad_template_caps (GST_AUDIO_DECODER_SRC_PAD (adec));
-  gst_audio_info_from_caps (&info, outcaps);
-  ret = gst_audio_decoder_set_output_format (adec, &info);
-  gst_caps_unref (outcaps);
+  if (dec->law == G729_G711_NONE)
+    return GST_AUDIO_DECODER_CLASS (gst_g729_dec_parent_class)->negotiate (adec);
+
+  if (dec->law_negotiated)
+    return TRUE;
+
+  caps = gst_caps_new_simple (dec->law == G729_G711_ULAW ?
+      "audio/x-mulaw" : "audio/x-alaw",
+      "rate", G_TYPE_INT, SAMPLE_RATE,
+      "channels", G_TYPE_INT, dec->channels, NULL);
+  ret = gst_pad_set_caps (GST_AUDIO_DECODER_SRC_PAD (adec), caps);
+  gst_caps_unref (caps);
+
+  dec->law_negotiated = ret;
 
   return ret;
 }
 
-static guint32
-g729_decode(GstG729Dec * dec, const guint8 *g729_data, guint g729_len, gint16 *pcm_data)
+/* Uses the first pool proposed downstream (e.g. by a mixer) for the
+ * common output buffer, one 10 ms block of all channels */
+static gboolean
+gst_g729_dec_decide_allocation (GstAudioDecoder *adec, GstQuery *query)
+{
+  GstG729Dec * dec = GST_G729_DEC (adec);
+  GstBufferPool *pool = NULL;
+  GstStructure *config;
+  GstCaps *caps;
+  guint size, min, max;
+
+  if (!GST_AUDIO_DECODER_CLASS (gst_g729_dec_parent_class)->decide_allocation (adec, query))
+    return FALSE;
+
+  gst_g729_dec_free_pool (dec);
+
+  if (gst_query_get_n_allocation_pools (query) > 0)
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+  if (!pool)
+    return TRUE;
+
+  gst_query_parse_allocation (query, &caps, NULL);
+  size = dec->block_bytes;
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, size, min, max);
+  if (!gst_buffer_pool_set_config (pool, config) ||
+      !gst_buffer_pool_set_active (pool, TRUE)) {
+    GST_WARNING_OBJECT (dec, "can't use downstream pool");
+    gst_object_unref (pool);
+    return TRUE;
+  }
+
+  gst_query_set_nth_allocation_pool (query, 0, pool, size, min, max);
+  dec->pool = pool;
+
+  return TRUE;
+}
+
+/* Output buffers of the pool size come from the pool when it has one
+ * free, anything else from the base class allocator */
+static GstBuffer *
+gst_g729_dec_alloc_output (GstG729Dec * dec, gsize size)
 {
-  guint16  i;
+  GstBufferPoolAcquireParams params = { 0, };
+  GstBuffer *outbuf;
 
-  for(i=0;i<SERIAL_SIZE-2;i++){
-    ((guchar*)dec->refcode_input)[5+i*2]=0x00;
-    ((guchar*)dec->refcode_input)[4+i*2]=
-      (g729_data[i/8]&(1<<(7-i%8)))!=0?0x81:0x7F;
+  if (dec->pool && size == dec->block_bytes) {
+    params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+    if (gst_buffer_pool_acquire_buffer (dec->pool, &outbuf, &params) == GST_FLOW_OK)
+      return outbuf;
   }
 
-  switch(g729_len){
-    case G729_SID_BYTES:
-      dec->parameters[1] = G729_SID_FRAME;
-      ((guchar*)dec->refcode_input)[2]=0x10;
-      GST_DEBUG_OBJECT(dec, "SID frame");
-      break;
-    case G729_SILENCE_BYTES:
-      dec->parameters[1] = G729_SILENCE_FRAME;
-      ((guchar*)dec->refcode_input)[2]=0x00;
-      GST_DEBUG_OBJECT(dec, "silence frame");
-      break;
-    case G729_FRAME_BYTES:
-      dec->parameters[1] = G729_SPEECH_FRAME;
-      ((guchar*)dec->refcode_input)[2]=0x50;
-      break;
+  return gst_audio_decoder_allocate_output_buffer (GST_AUDIO_DECODER (dec), size);
+}
+
+/* Decodes a frame of the given channel. Without comfort noise, SID and
+ * untransmitted frames still go through the decoder, which has to follow
+ * the DTX period for the speech after it, but come out as silence with no
+ * post-processing; returns whether anything was synthesised. */
+static gboolean
+gst_g729_dec_decode_frame (GstG729Dec * dec, guint channel,
+    const guint8 * data, guint size, gint16 * pcm)
+{
+  gboolean silent;
+
+  silent = !dec->comfort_noise && size != G729_FRAME_BYTES;
+
+  /* picked up here so that the property can change while playing */
+  g729_decoder_set_postfilter (dec->decoders[channel], dec->postfilter);
+  g729_decoder_decode (dec->decoders[channel], data, size,
+      silent ? NULL : pcm);
+
+  if (silent) {
+    memset (pcm, 0, RAW_FRAME_BYTES);
+    return FALSE;
   }
 
-  bits2prm_ld8k( &dec->refcode_input[1], dec->parameters);
+  return TRUE;
+}
+
+/* Folds a 10 ms block into the statistics: the frame sizes of its
+ * channels (NULL for concealed frames) and the time spent on all of them,
+ * spread over the channels as in g729enc. Decoding runs without the lock,
+ * which is only taken here. */
+static void
+gst_g729_dec_add_block (GstG729Dec * dec, const guint8 * sizes,
+    GstClockTime elapsed)
+{
+  guint j;
 
-  dec->parameters[0] = 0;           /* No frame erasure */
-  if(dec->refcode_input[1] != 0) {
-   for (i=0; i < dec->refcode_input[1]; i++)
-     if (dec->refcode_input[i+2] == 0 ) 
-       dec->parameters[0] = 1;  /* frame erased     */
+  GST_G729_STATS_LOCK (&dec->stats);
+  if (sizes) {
+    for (j = 0; j < dec->channels; j++)
+      gst_g729_stats_add_frame (&dec->stats, sizes[j]);
   } else {
-    if(dec->refcode_input[0] != SYNC_WORD) 
-      dec->parameters[0] = 1;
+    dec->stats.erased += dec->channels;
+  }
+  gst_g729_stats_add_time (&dec->stats, elapsed / dec->channels,
+      dec->channels);
+  GST_G729_STATS_UNLOCK (&dec->stats);
+}
+
+/* Interleaves the frames in dec->pcm into out, companded for G.711
+ * output; returns where the next block goes */
+static guint8 *
+gst_g729_dec_write_block (GstG729Dec * dec, guint8 * out)
+{
+  gint16 *out_ptr = (gint16 *) out;
+  guint i, j;
+
+  if (dec->law != G729_G711_NONE) {
+    for (j = 0; j < dec->channels; j++)
+      g729_g711_compress (dec->law, dec->pcm + j * RAW_FRAME_SAMPLES, out + j,
+          dec->channels, RAW_FRAME_SAMPLES);
+    return out + dec->block_bytes;
   }
 
+  for (i = 0; i < RAW_FRAME_SAMPLES; i++) {
+    for (j = 0; j < dec->channels; j++)
+      *out_ptr++ = dec->pcm[j * RAW_FRAME_SAMPLES + i];
+  }
+
+  return (guint8 *) out_ptr;
+}
 
-  if(dec->parameters[1] == 1) {
-    /* check parity and put 1 in dec->parameters[5] if parity error */
-    dec->parameters[5] = Check_Parity_Pitch(
-        dec->parameters[4], dec->parameters[5]);
+/* Multi-channel buffers hold one or more 10 ms blocks, each made of the
+ * per-channel size table and the frames (see g729common.h) */
+static GstFlowReturn
+gst_g729_dec_decode_multichannel (GstG729Dec * dec, const guint8 * data,
+    gsize size, GstBuffer ** outbuf)
+{
+  GstMapInfo omap;
+  GstClockTime start;
+  gsize offset, payload;
+  guint j, num_frames;
+  const guint8 *in_ptr, *table;
+  guint8 *out_ptr;
+  gboolean synthesised = FALSE;
+
+  /* validate the size tables and count the blocks */
+  num_frames = 0;
+  offset = 0;
+  while (offset < size) {
+    if (size - offset < dec->channels)
+      goto wrong_size;
+
+    payload = 0;
+    for (j = 0; j < dec->channels; j++) {
+      switch (data[offset + j]) {
+        case G729_FRAME_BYTES:
+        case G729_SID_BYTES:
+        case G729_SILENCE_BYTES:
+          payload += data[offset + j];
+          break;
+        default:
+          goto wrong_size;
+      }
+    }
+
+    offset += dec->channels + payload;
+    if (offset > size)
+      goto wrong_size;
+
+    num_frames++;
   }
 
-  Decod_ld8a(
-      dec->parameters, dec->synth, dec->decoded_az, dec->pitch_lag, &dec->vad);
-  Post_Filter(dec->synth, dec->decoded_az, dec->pitch_lag, dec->vad);
-  Post_Process(dec->synth, L_FRAME);
+  if (num_frames == 0)
+    goto wrong_size;
+
+  *outbuf = gst_g729_dec_alloc_output (dec,
+      num_frames * dec->block_bytes);
+  if (!*outbuf)
+    return GST_FLOW_OK;
 
-  memcpy(pcm_data,dec->synth,RAW_FRAME_BYTES);
+  gst_buffer_map (*outbuf, &omap, GST_MAP_WRITE);
 
-  return RAW_FRAME_BYTES;
+  in_ptr = data;
+  out_ptr = omap.data;
+
+  while (num_frames--) {
+    table = in_ptr;
+    in_ptr += dec->channels;
+
+    start = gst_util_get_timestamp ();
+    for (j = 0; j < dec->channels; j++) {
+      synthesised |= gst_g729_dec_decode_frame (dec, j, in_ptr, table[j],
+          dec->pcm + j * RAW_FRAME_SAMPLES);
+      in_ptr += table[j];
+    }
+    gst_g729_dec_add_block (dec, table, gst_util_get_timestamp () - start);
+
+    out_ptr = gst_g729_dec_write_block (dec, out_ptr);
+  }
+
+  gst_buffer_unmap (*outbuf, &omap);
+
+  if (!synthesised)
+    GST_BUFFER_FLAG_SET (*outbuf, GST_BUFFER_FLAG_GAP);
+
+  return GST_FLOW_OK;
+
+wrong_size:
+  return GST_FLOW_ERROR;
 }
 
 static GstFlowReturn
-gst_g729_dec_handle_frame (GstAudioDecoder * adec, GstBuffer * buf)
+gst_g729_dec_decode_mono (GstG729Dec * dec, const guint8 * data, gsize size,
+    GstBuffer ** outbuf)
 {
-  GstG729Dec * dec = GST_G729_DEC (adec);
-  guint size;
-  GstMapInfo imap, omap;
-  GstBuffer *outbuf;
+  GstMapInfo omap;
+  GstClockTime start;
   guint i, num_frames;
+  guint8 frame_size;
   const guint8 *in_ptr;
-  gint16 *out_ptr;
-
-  size = gst_buffer_get_size (buf);
+  guint8 *out_ptr;
+  gboolean synthesised = FALSE;
 
   /* G729 frames are either 10 or 2 bytes, and we allow multiple 10 bytes
    * frames at once followed by up to a single 2 byte frame.
    * Also allow 0 byte silence frames. */
   if (size % G729_FRAME_BYTES != 0 && size % G729_FRAME_BYTES != G729_SID_BYTES)
-  {
-    GST_ERROR_OBJECT (dec, "wrong buffer size: %d", size);
     return GST_FLOW_ERROR;
-  }
 
   num_frames = size / G729_FRAME_BYTES;
   if (size % G729_FRAME_BYTES == G729_SID_BYTES)
@@ -264,29 +667,304 @@ gst_g729_dec_handle_frame (GstAudioDecoder * adec, GstBuffer * buf)
   if (size == 0)
     num_frames = 1;
 
-  outbuf = gst_audio_decoder_allocate_output_buffer (GST_AUDIO_DECODER (dec), num_frames * RAW_FRAME_BYTES);
-  if (!outbuf)
+  *outbuf = gst_g729_dec_alloc_output (dec, num_frames * dec->block_bytes);
+  if (!*outbuf)
     return GST_FLOW_OK;
 
-  gst_buffer_map (buf, &imap, GST_MAP_READ);
-  gst_buffer_map (outbuf, &omap, GST_MAP_READ);
+  gst_buffer_map (*outbuf, &omap, GST_MAP_WRITE);
 
-  in_ptr = imap.data;
-  out_ptr = (gint16 *) omap.data;
+  in_ptr = data;
+  out_ptr = omap.data;
 
   for (i = 0; i < num_frames; i++) {
     /* Consider every frame except for the last one as a normal frame. The
      * last frame can be either of the three frame types */
-    g729_decode (dec, in_ptr, size >= G729_FRAME_BYTES ? G729_FRAME_BYTES : size, out_ptr);
+    frame_size = size >= G729_FRAME_BYTES ? G729_FRAME_BYTES : size;
+
+    /* the last decoder stage (post-processing) writes linear output
+     * straight into the output buffer, G.711 goes through dec->pcm to
+     * be companded */
+    start = gst_util_get_timestamp ();
+    if (dec->law != G729_G711_NONE) {
+      synthesised |= gst_g729_dec_decode_frame (dec, 0, in_ptr, frame_size,
+          dec->pcm);
+      out_ptr = gst_g729_dec_write_block (dec, out_ptr);
+    } else {
+      synthesised |= gst_g729_dec_decode_frame (dec, 0, in_ptr, frame_size,
+          (gint16 *) out_ptr);
+      out_ptr += RAW_FRAME_BYTES;
+    }
+    gst_g729_dec_add_block (dec, &frame_size,
+        gst_util_get_timestamp () - start);
 
     in_ptr += G729_FRAME_BYTES;
     size -= G729_FRAME_BYTES;
-    out_ptr += RAW_FRAME_BYTES / 2;
   }
 
-  gst_buffer_unmap (buf, &imap);
+  gst_buffer_unmap (*outbuf, &omap);
+
+  if (!synthesised)
+    GST_BUFFER_FLAG_SET (*outbuf, GST_BUFFER_FLAG_GAP);
+
+  return GST_FLOW_OK;
+}
+
+/* Synthesises num_frames frames per channel through the codec frame
+ * erasure concealment */
+static GstBuffer *
+gst_g729_dec_conceal (GstG729Dec * dec, guint num_frames)
+{
+  GstMapInfo omap;
+  GstBuffer *outbuf;
+  GstClockTime start;
+  guint j, n;
+  guint8 *out_ptr;
+
+  GST_DEBUG_OBJECT (dec, "concealing %u lost frames", num_frames);
+
+  outbuf = gst_g729_dec_alloc_output (dec, num_frames * dec->block_bytes);
+  if (!outbuf)
+    return NULL;
+
+  gst_buffer_map (outbuf, &omap, GST_MAP_WRITE);
+
+  out_ptr = omap.data;
+  for (n = 0; n < num_frames; n++) {
+    start = gst_util_get_timestamp ();
+    for (j = 0; j < dec->channels; j++)
+      g729_decoder_conceal (dec->decoders[j], dec->pcm + j * RAW_FRAME_SAMPLES);
+    gst_g729_dec_add_block (dec, NULL, gst_util_get_timestamp () - start);
+
+    out_ptr = gst_g729_dec_write_block (dec, out_ptr);
+  }
+
   gst_buffer_unmap (outbuf, &omap);
 
-  return gst_audio_decoder_finish_frame (GST_AUDIO_DECODER (dec), outbuf, 1);
+  return outbuf;
+}
+
+/* Checks an RTP packet against the previous one. Returns FALSE for
+ * duplicate and late packets, whose time has already been played out;
+ * otherwise lost is set to the number of frames missing in between. */
+static gboolean
+gst_g729_dec_check_rtp (GstG729Dec * dec, GstRTPBuffer * rtp, guint * lost)
+{
+  guint16 seq = gst_rtp_buffer_get_seq (rtp);
+  guint32 ts = gst_rtp_buffer_get_timestamp (rtp);
+  gint16 gap;
+  gint32 missing;
+
+  *lost = 0;
+
+  if (!dec->rtp_synced)
+    return TRUE;
+
+  gap = (gint16) (seq - dec->rtp_seq);
+  if (gap < 0) {
+    GST_DEBUG_OBJECT (dec, "dropping late packet %u, expected %u", seq,
+        dec->rtp_seq);
+    return FALSE;
+  }
+
+  /* Untransmitted frames don't take sequence numbers, so a timestamp jump
+   * alone is a DTX period. With missing packets, the whole jump is lost. */
+  missing = (gint32) (ts - dec->rtp_ts);
+  if (gap > 0 && missing > 0) {
+    GST_DEBUG_OBJECT (dec, "%d packets lost before %u", gap, seq);
+    *lost = missing / RAW_FRAME_SAMPLES;
+  }
+
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_g729_dec_handle_frame (GstAudioDecoder * adec, GstBuffer * buf)
+{
+  GstG729Dec * dec = GST_G729_DEC (adec);
+  GstFlowReturn ret;
+  GstBuffer *outbuf = NULL;
+  GstStructure *stats;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstMapInfo imap;
+  GstClockTime pts, duration;
+  const guint8 *data;
+  gsize size;
+  guint num_frames, lost = 0;
+  gboolean rejected = FALSE;
+
+  /* drain: every buffer is decoded as a whole, nothing is held back */
+  if (!buf)
+    return GST_FLOW_OK;
+
+  pts = GST_BUFFER_PTS (buf);
+  duration = GST_BUFFER_DURATION (buf);
+
+  /* With plc on, the base class turns GAP events into empty buffers
+   * spanning the gap; they are lost frames, not untransmitted ones */
+  if (gst_audio_decoder_get_plc (adec) && gst_buffer_get_size (buf) == 0 &&
+      GST_CLOCK_TIME_IS_VALID (duration)) {
+    num_frames = MAX ((duration + G729_FRAME_DURATION / 2) / G729_FRAME_DURATION, 1);
+    outbuf = gst_g729_dec_conceal (dec, num_frames);
+    goto finish;
+  }
+
+  if (dec->rtp) {
+    /* the payload is read from the mapped packet, not copied out of it;
+     * the output still goes to a buffer of its own */
+    if (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp)) {
+      GST_G729_STATS_LOCK (&dec->stats);
+      dec->stats.rejected++;
+      GST_G729_STATS_UNLOCK (&dec->stats);
+
+      GST_AUDIO_DECODER_ERROR (dec, 1, STREAM, DECODE, (NULL),
+          ("invalid RTP packet"), ret);
+      if (ret == GST_FLOW_OK)
+        ret = gst_audio_decoder_finish_frame (adec, NULL, 1);
+      return ret;
+    }
+
+    if (!gst_g729_dec_check_rtp (dec, &rtp, &lost)) {
+      gst_rtp_buffer_unmap (&rtp);
+      return gst_audio_decoder_finish_frame (adec, NULL, 1);
+    }
+
+    data = gst_rtp_buffer_get_payload (&rtp);
+    size = gst_rtp_buffer_get_payload_len (&rtp);
+  } else {
+    /* A timestamp jump across a discontinuity means packets were lost
+     * upstream (e.g. missing RTP sequence numbers). */
+    if (GST_BUFFER_IS_DISCONT (buf) && GST_CLOCK_TIME_IS_VALID (pts) &&
+        GST_CLOCK_TIME_IS_VALID (dec->next_ts) &&
+        pts >= dec->next_ts + G729_FRAME_DURATION / 2)
+      lost = (pts - dec->next_ts + G729_FRAME_DURATION / 2) / G729_FRAME_DURATION;
+
+    gst_buffer_map (buf, &imap, GST_MAP_READ);
+    data = imap.data;
+    size = imap.size;
+  }
+
+  /* The concealed frames are pushed without consuming input, so they take
+   * the timestamps of the gap. Long gaps are real discontinuities, not
+   * losses. */
+  if (lost > 0 && lost <= MAX_CONCEALED_FRAMES &&
+      gst_audio_decoder_get_plc (adec)) {
+    outbuf = gst_g729_dec_conceal (dec, lost);
+    if (outbuf) {
+      ret = gst_audio_decoder_finish_frame (adec, outbuf, 0);
+      outbuf = NULL;
+      if (ret != GST_FLOW_OK)
+        goto unmap;
+    }
+  }
+
+  if (dec->channels > 1)
+    ret = gst_g729_dec_decode_multichannel (dec, data, size, &outbuf);
+  else
+    ret = gst_g729_dec_decode_mono (dec, data, size, &outbuf);
+  rejected = ret != GST_FLOW_OK;
+  if (rejected) {
+    GST_G729_STATS_LOCK (&dec->stats);
+    dec->stats.rejected++;
+    GST_G729_STATS_UNLOCK (&dec->stats);
+  }
+
+  /* the next packet is expected right after this one */
+  if (dec->rtp && !rejected) {
+    dec->rtp_seq = gst_rtp_buffer_get_seq (&rtp) + 1;
+    dec->rtp_ts = gst_rtp_buffer_get_timestamp (&rtp) +
+        (size + G729_FRAME_BYTES - 1) / G729_FRAME_BYTES * RAW_FRAME_SAMPLES;
+    dec->rtp_synced = TRUE;
+  }
+
+unmap:
+  if (dec->rtp)
+    gst_rtp_buffer_unmap (&rtp);
+  else
+    gst_buffer_unmap (buf, &imap);
+
+  if (rejected) {
+    /* within the max-errors of the base class, the buffer is dropped */
+    GST_AUDIO_DECODER_ERROR (dec, 1, STREAM, DECODE, (NULL),
+        ("wrong buffer size: %" G_GSIZE_FORMAT, size), ret);
+    if (ret == GST_FLOW_OK)
+      ret = gst_audio_decoder_finish_frame (adec, NULL, 1);
+    return ret;
+  }
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+finish:
+  if (!outbuf)
+    return GST_FLOW_OK;
+
+  /* where the next buffer should start if nothing is lost */
+  num_frames = gst_buffer_get_size (outbuf) / dec->block_bytes;
+  if (GST_CLOCK_TIME_IS_VALID (pts))
+    dec->next_ts = pts + num_frames * G729_FRAME_DURATION;
+  else if (GST_CLOCK_TIME_IS_VALID (dec->next_ts))
+    dec->next_ts += num_frames * G729_FRAME_DURATION;
+
+  GST_G729_STATS_LOCK (&dec->stats);
+  stats = gst_g729_stats_advance (&dec->stats,
+      num_frames * G729_FRAME_DURATION, dec->stats_interval, STATS_NAME);
+  GST_G729_STATS_UNLOCK (&dec->stats);
+
+  if (stats)
+    gst_element_post_message (GST_ELEMENT (dec),
+        gst_message_new_element (GST_OBJECT (dec), stats));
+
+  return gst_audio_decoder_finish_frame (adec, outbuf, 1);
+}
+
+static void
+gst_g729_dec_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstG729Dec *dec;
+
+  dec = GST_G729_DEC (object);
+
+  switch (prop_id) {
+    case PROP_COMFORT_NOISE:
+      g_value_set_boolean (value, dec->comfort_noise);
+      break;
+    case PROP_POSTFILTER:
+      g_value_set_boolean (value, dec->postfilter);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value,
+          gst_g729_stats_get_structure (&dec->stats, STATS_NAME));
+      break;
+    case PROP_STATS_INTERVAL:
+      g_value_set_uint64 (value, dec->stats_interval);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_g729_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstG729Dec *dec;
+
+  dec = GST_G729_DEC (object);
+
+  switch (prop_id) {
+    case PROP_COMFORT_NOISE:
+      dec->comfort_noise = g_value_get_boolean (value);
+      break;
+    case PROP_POSTFILTER:
+      dec->postfilter = g_value_get_boolean (value);
+      break;
+    case PROP_STATS_INTERVAL:
+      dec->stats_interval = g_value_get_uint64 (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
 }
 
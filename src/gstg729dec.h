@@ -46,10 +46,11 @@
 
 #include <gst/gst.h>
 #include <gst/audio/audio.h>
+#include <gst/rtp/gstrtpbuffer.h>
 #include "g729common.h"
-
-//ref code includes:
-#include "basic_op.h"
+#include "g729.h"
+#include "gstg729stats.h"
+#include "g729g711.h"
 
 G_BEGIN_DECLS
 
@@ -70,22 +71,31 @@ typedef struct _GstG729DecClass GstG729DecClass;
 struct _GstG729Dec {
   GstAudioDecoder       parent;
 
-  void                  *state;
-  guint16               vad;
+  guint                 channels;
+  G729G711Law           law;        /* of the output, if G.711 */
+  guint                 block_bytes;  /* output of one 10 ms block */
+  gboolean              law_negotiated;
+  G729Decoder           **decoders;  /* one per channel */
+  gint16                *pcm;       /* decoded frames, one per channel */
+  GstBufferPool         *pool;      /* downstream pool, if any */
+
+  gboolean              comfort_noise;
+  gboolean              postfilter;
+
+  GstClockTime          next_ts;    /* expected timestamp of the next buffer */
+
+  gboolean              rtp;        /* RTP input, no depayloader */
+  gboolean              rtp_synced;
+  guint16               rtp_seq;    /* expected in the next packet */
+  guint32               rtp_ts;
+
+  GstG729Stats          stats;
+  GstClockTime          stats_interval;
 
   guint64               packetno;
 
   GstSegment            segment;    /* STREAM LOCK */
   gint64                granulepos; /* -1 = needs to be set from current time */
-
-  //ref code specific
-  guint16 parameters[PRM_SIZE+2];           /* parameters used for Synthesis */
-  guint16 refcode_input[SERIAL_SIZE];       /* decoder input stream          */
-  guint16 decoded_az[MP1*2];                /* post-filter specific Az       */
-  guint16 pitch_lag[2];                     /* pitch lag over 2 subframes    */
-  guint16 synth_buf[L_FRAME+M];
-  guint16 *synth; 
-
 };
 
 struct _GstG729DecClass {
@@ -47,10 +47,38 @@
  *
  * This element encodes audio as a G729 stream.
  *
+ * #GstG729Enc:n-threads spreads the channels of a multi-channel stream over
+ * a thread pool. Every channel has its own codec state, so the threads
+ * encode their channels in parallel, with nothing shared between them.
+ *
+ * #GstG729Enc:complexity trades some quality for CPU time by pruning the
+ * encoder searches; the stream stays standard at every level.
+ *
+ * #GstG729Enc:stats counts the speech, SID and untransmitted frames produced
+ * and keeps a histogram of the time spent encoding each channel frame, and
+ * another of the tick latency, the wall-clock time spent on each 10 ms
+ * block of all channels (tick-latency-p50/p99/max). With
+ * #GstG729Enc:stats-interval set, the same structure is also posted as an
+ * element message every time that much audio has been encoded.
+ *
+ * The sink pad also takes G.711 (audio/x-mulaw, audio/x-alaw), expanded
+ * through lookup tables on the way into the codec, so that transcoding
+ * from a PSTN leg needs no decoder element in front.
+ *
+ * S16 and F32 input at 16, 32 and 48 kHz goes through a built-in anti-alias
+ * decimator down to 8 kHz, so no audioresample is needed in front either.
+ * Its filter adds under 2 ms to the reported latency.
+ *
+ * When downstream accepts application/x-rtp, mono streams come out as RTP
+ * packets (RFC 3551, static payload type 18 by default) with no payloader
+ * in between: every output buffer is one packet, with the marker bit set
+ * on the first speech packet after each DTX period.
+ *
  * <refsect2>
  * <title>Example pipelines</title>
  * |[
- * TODO
+ * gst-launch-1.0 autoaudiosrc ! audioconvert ! audioresample ! g729enc ! \
+ *     application/x-rtp ! udpsink host=127.0.0.1 port=5004
  * ]| send a G729 rtp stream.
  * </refsect2>
  */
@@ -62,8 +90,6 @@
 #include "gstg729enc.h"
 #include <string.h>
 
-void Init_Cod_cng(void);
-
 GST_DEBUG_CATEGORY_EXTERN (g729enc_debug);
 #define GST_CAT_DEFAULT g729enc_debug
 
@@ -71,25 +97,61 @@ static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-raw, "
-        "format = (string)" GST_AUDIO_NE (S16) ", "
+        "format = (string) { " GST_AUDIO_NE (S16) ", " GST_AUDIO_NE (F32) " }, "
+        "rate = (int) { 8000, 16000, 32000, 48000 }, "
+        "channels = (int) [ 1, " G_STRINGIFY (G729_MAX_CHANNELS) " ], "
+        "layout = (string) interleaved; "
+        "audio/x-mulaw, "
         "rate = (int) 8000, "
-        "channels = (int) 1, "
-        "layout = (string) interleaved")
+        "channels = (int) [ 1, " G_STRINGIFY (G729_MAX_CHANNELS) " ]; "
+        "audio/x-alaw, "
+        "rate = (int) 8000, "
+        "channels = (int) [ 1, " G_STRINGIFY (G729_MAX_CHANNELS) " ]")
     );
 
 static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS ("audio/G729, "
-        "rate = (int) 8000, " "channels = (int) 1")
+    GST_STATIC_CAPS (G729_CAPS "; "
+        "application/x-rtp, "
+        "media = (string) audio, "
+        "clock-rate = (int) 8000, "
+        "encoding-name = (string) G729, "
+        "payload = (int) [ 0, 127 ]")
     );
 
 #define DEFAULT_VAD             FALSE
+#define DEFAULT_N_THREADS       1
+#define DEFAULT_FRAMES_PER_BUFFER 1
+#define MAX_FRAMES_PER_BUFFER   20
+#define DEFAULT_LOW_LATENCY     FALSE
+#define DEFAULT_COMPLEXITY      G729_COMPLEXITY_MAX
+#define DEFAULT_STATS_INTERVAL  0
+#define DEFAULT_PT              18
+#define DEFAULT_SSRC            G_MAXUINT
+#define DEFAULT_TIMESTAMP_OFFSET G_MAXUINT
+#define DEFAULT_SEQNUM_OFFSET   -1
+
+#define STATS_NAME              "application/x-g729enc-stats"
+
+/* a 10 ms frame plus the 5 ms look-ahead */
+#define ALGORITHMIC_DELAY       (15 * GST_MSECOND)
 
 enum
 {
   PROP_0,
   PROP_VAD,
+  PROP_N_THREADS,
+  PROP_MAX_TICK_LATENCY,
+  PROP_FRAMES_PER_BUFFER,
+  PROP_LOW_LATENCY,
+  PROP_COMPLEXITY,
+  PROP_STATS,
+  PROP_STATS_INTERVAL,
+  PROP_PT,
+  PROP_SSRC,
+  PROP_TIMESTAMP_OFFSET,
+  PROP_SEQNUM_OFFSET,
 };
 
 static void gst_g729_enc_get_property (GObject * object, guint prop_id,
@@ -99,7 +161,14 @@ static void gst_g729_enc_set_property (GObject * object, guint prop_id,
 
 static GstFlowReturn gst_g729_enc_handle_frame (GstAudioEncoder * aenc, GstBuffer * buffer);
 static gboolean gst_g729_enc_set_format (GstAudioEncoder * aenc, GstAudioInfo * info);
+static gboolean gst_g729_enc_sink_event (GstAudioEncoder * aenc, GstEvent * event);
+static GstCaps *gst_g729_enc_getcaps (GstAudioEncoder * aenc, GstCaps * filter);
+static gboolean gst_g729_enc_start (GstAudioEncoder * aenc);
 static gboolean gst_g729_enc_stop (GstAudioEncoder * aenc);
+static void gst_g729_enc_flush (GstAudioEncoder * aenc);
+static void gst_g729_enc_finalize (GObject * object);
+static void gst_g729_enc_free_channels (GstG729Enc * enc);
+static void gst_g729_enc_free_pool (GstG729Enc * enc);
 
 G_DEFINE_TYPE (GstG729Enc, gst_g729_enc, GST_TYPE_AUDIO_ENCODER);
 
@@ -116,10 +185,66 @@ gst_g729_enc_class_init (GstG729EncClass * klass)
 
   gobject_class->set_property = gst_g729_enc_set_property;
   gobject_class->get_property = gst_g729_enc_get_property;
+  gobject_class->finalize = gst_g729_enc_finalize;
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_VAD,
       g_param_spec_boolean ("vad", "VAD",
           "Enable voice activity detection", DEFAULT_VAD, G_PARAM_READWRITE));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads encoding the channels of a multi-channel stream",
+          1, G729_MAX_CHANNELS, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_MAX_TICK_LATENCY,
+      g_param_spec_uint64 ("max-tick-latency", "Maximum tick latency",
+          "Longest time spent encoding one 10 ms block of all channels (in ns)",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_FRAMES_PER_BUFFER,
+      g_param_spec_uint ("frames-per-buffer", "Frames per buffer",
+          "Number of 10 ms frames per output buffer (ptime / 10 ms)",
+          1, MAX_FRAMES_PER_BUFFER, DEFAULT_FRAMES_PER_BUFFER,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_LOW_LATENCY,
+      g_param_spec_boolean ("low-latency", "Low latency",
+          "Push every frame as soon as it is encoded, ignoring frames-per-buffer",
+          DEFAULT_LOW_LATENCY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_COMPLEXITY,
+      g_param_spec_uint ("complexity", "Complexity",
+          "Encoder search effort (0 = pruned codebook and pitch searches, "
+          "1 = pruned codebook search, 2 = reference searches)",
+          G729_COMPLEXITY_MIN, G729_COMPLEXITY_MAX, DEFAULT_COMPLEXITY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Frame counters, per-frame encoding time and tick latency "
+          "(p50/p99/max in ns) since the element started", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_STATS_INTERVAL,
+      g_param_spec_uint64 ("stats-interval", "Statistics interval",
+          "Post the statistics as an element message every time this much "
+          "audio has been encoded (in ns, 0 = never)",
+          0, G_MAXUINT64, DEFAULT_STATS_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_PT,
+      g_param_spec_uint ("pt", "Payload type",
+          "Payload type of the RTP output", 0, 127, DEFAULT_PT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_SSRC,
+      g_param_spec_uint ("ssrc", "SSRC",
+          "SSRC of the RTP output (-1 = random)", 0, G_MAXUINT, DEFAULT_SSRC,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (G_OBJECT_CLASS (klass),
+      PROP_TIMESTAMP_OFFSET,
+      g_param_spec_uint ("timestamp-offset", "Timestamp Offset",
+          "First RTP timestamp of the RTP output (-1 = random)",
+          0, G_MAXUINT, DEFAULT_TIMESTAMP_OFFSET,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_SEQNUM_OFFSET,
+      g_param_spec_int ("seqnum-offset", "Sequence number Offset",
+          "First sequence number of the RTP output (-1 = random)",
+          -1, G_MAXUINT16, DEFAULT_SEQNUM_OFFSET,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&src_factory));
@@ -132,20 +257,218 @@ gst_g729_enc_class_init (GstG729EncClass * klass)
 
   gstaudioencoder_class->handle_frame = GST_DEBUG_FUNCPTR (gst_g729_enc_handle_frame);
   gstaudioencoder_class->set_format = GST_DEBUG_FUNCPTR (gst_g729_enc_set_format);
+  gstaudioencoder_class->sink_event = GST_DEBUG_FUNCPTR (gst_g729_enc_sink_event);
+  gstaudioencoder_class->getcaps = GST_DEBUG_FUNCPTR (gst_g729_enc_getcaps);
+  gstaudioencoder_class->start = GST_DEBUG_FUNCPTR (gst_g729_enc_start);
   gstaudioencoder_class->stop = GST_DEBUG_FUNCPTR (gst_g729_enc_stop);
+  gstaudioencoder_class->flush = GST_DEBUG_FUNCPTR (gst_g729_enc_flush);
 }
 
 static void
 gst_g729_enc_init (GstG729Enc * enc)
 {
-  gst_audio_encoder_set_drainable (GST_AUDIO_ENCODER (enc), FALSE);
-  gst_audio_encoder_set_latency (GST_AUDIO_ENCODER (enc), 30 * GST_MSECOND, 30 * GST_MSECOND);
+  gst_audio_encoder_set_drainable (GST_AUDIO_ENCODER (enc), TRUE);
+  gst_audio_encoder_set_latency (GST_AUDIO_ENCODER (enc), ALGORITHMIC_DELAY, ALGORITHMIC_DELAY);
 
   enc->vad = DEFAULT_VAD;
+  enc->n_threads = DEFAULT_N_THREADS;
+  enc->frames_per_buffer = DEFAULT_FRAMES_PER_BUFFER;
+  enc->low_latency = DEFAULT_LOW_LATENCY;
+  enc->rate = SAMPLE_RATE;
+  enc->factor = 1;
+  enc->complexity = DEFAULT_COMPLEXITY;
+  enc->stats_interval = DEFAULT_STATS_INTERVAL;
+  enc->pt = DEFAULT_PT;
+  enc->ssrc = DEFAULT_SSRC;
+  enc->ts_offset = DEFAULT_TIMESTAMP_OFFSET;
+  enc->seqnum_offset = DEFAULT_SEQNUM_OFFSET;
+
+  g_mutex_init (&enc->jobs_lock);
+  g_cond_init (&enc->jobs_cond);
+  gst_g729_stats_init (&enc->stats);
+}
+
+static void
+gst_g729_enc_finalize (GObject * object)
+{
+  GstG729Enc *enc = GST_G729_ENC (object);
+
+  gst_g729_enc_free_pool (enc);
+  gst_g729_enc_free_channels (enc);
+
+  g_mutex_clear (&enc->jobs_lock);
+  g_cond_clear (&enc->jobs_cond);
+  gst_g729_stats_clear (&enc->stats);
+
+  G_OBJECT_CLASS (gst_g729_enc_parent_class)->finalize (object);
+}
+
+static void
+gst_g729_enc_free_channels (GstG729Enc * enc)
+{
+  guint i;
+
+  for (i = 0; i < enc->channels; i++)
+    g729_encoder_free (enc->encoders[i]);
+
+  g_free (enc->encoders);
+  g_free (enc->frames);
+  g_free (enc->sizes);
+  g_free (enc->packet);
+  g_free (enc->pad);
+  g_free (enc->tail);
+  g729_decimator_free (enc->decimator);
+
+  enc->encoders = NULL;
+  enc->frames = NULL;
+  enc->sizes = NULL;
+  enc->packet = NULL;
+  enc->pad = NULL;
+  enc->tail = NULL;
+  enc->decimator = NULL;
+  enc->channels = 0;
+}
+
+static gboolean
+gst_g729_enc_alloc_channels (GstG729Enc * enc, guint channels)
+{
+  guint i;
+
+  gst_g729_enc_free_channels (enc);
+
+  enc->encoders = g_new0 (G729Encoder *, channels);
+  enc->frames = g_new (guint8, channels * G729_FRAME_BYTES);
+  enc->sizes = g_new (gint, channels);
+  enc->tail = g_new (gint16, channels * RAW_FRAME_SAMPLES);
+  enc->channels = channels;
+
+  for (i = 0; i < channels; i++) {
+    enc->encoders[i] = g729_encoder_new (enc->vad);
+    if (!enc->encoders[i])
+      return FALSE;
+    g729_encoder_set_complexity (enc->encoders[i], enc->complexity);
+  }
+
+  return TRUE;
+}
+
+/* Encodes count channels starting from first, straight from the mapped
+ * interleaved input */
+static void
+gst_g729_enc_encode_channels (GstG729Enc * enc, const gint16 * in,
+    guint first, guint count)
+{
+  g729_encoder_encode_interleaved (&enc->encoders[first], count,
+      in + first, enc->channels, enc->frames + first * G729_FRAME_BYTES,
+      &enc->sizes[first]);
+}
+
+static void
+gst_g729_enc_run_job (gpointer data, gpointer user_data)
+{
+  GstG729EncJob *job = data;
+  GstG729Enc *enc = job->enc;
+  GstClockTime start;
+
+  start = gst_util_get_timestamp ();
+  gst_g729_enc_encode_channels (enc, job->in, job->first, job->count);
+  job->elapsed = gst_util_get_timestamp () - start;
+
+  g_mutex_lock (&enc->jobs_lock);
+  if (--enc->jobs_pending == 0)
+    g_cond_signal (&enc->jobs_cond);
+  g_mutex_unlock (&enc->jobs_lock);
+}
+
+static void
+gst_g729_enc_free_pool (GstG729Enc * enc)
+{
+  if (enc->pool)
+    g_thread_pool_free (enc->pool, FALSE, TRUE);
+  g_free (enc->jobs);
 
-  Init_Pre_Process();
-  Init_Coder_ld8a();
-  Init_Cod_cng();
+  enc->pool = NULL;
+  enc->jobs = NULL;
+  enc->n_jobs = 0;
+}
+
+/* Splits the channels into n-threads groups of about the same size. The
+ * streaming thread runs the first one, the pool the others. */
+static gboolean
+gst_g729_enc_setup_pool (GstG729Enc * enc)
+{
+  GError *err = NULL;
+  guint i, first;
+
+  gst_g729_enc_free_pool (enc);
+
+  enc->n_jobs = MIN (enc->n_threads, enc->channels);
+  if (enc->n_jobs <= 1)
+    return TRUE;
+
+  enc->jobs = g_new0 (GstG729EncJob, enc->n_jobs);
+  for (i = 0, first = 0; i < enc->n_jobs; i++) {
+    enc->jobs[i].enc = enc;
+    enc->jobs[i].first = first;
+    enc->jobs[i].count = (enc->channels - first) / (enc->n_jobs - i);
+    first += enc->jobs[i].count;
+  }
+
+  enc->pool = g_thread_pool_new (gst_g729_enc_run_job, NULL,
+      enc->n_jobs - 1, TRUE, &err);
+  if (!enc->pool) {
+    GST_ERROR_OBJECT (enc, "failed to create thread pool: %s", err->message);
+    g_error_free (err);
+    gst_g729_enc_free_pool (enc);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Back to the initial codec state; the instances are kept, so this is
+ * cheap enough to run for every new stream */
+static void
+gst_g729_enc_reset_channels (GstG729Enc * enc)
+{
+  guint i;
+
+  for (i = 0; i < enc->channels; i++)
+    g729_encoder_reset (enc->encoders[i]);
+
+  if (enc->decimator)
+    g729_decimator_reset (enc->decimator);
+
+  enc->lookahead_pending = FALSE;
+}
+
+static gboolean
+gst_g729_enc_start (GstAudioEncoder * aenc)
+{
+  GstG729Enc* enc = GST_G729_ENC (aenc);
+
+  gst_g729_enc_reset_channels (enc);
+  gst_g729_stats_reset (&enc->stats);
+
+  /* picked once per stream, like the RTP payloaders do */
+  enc->rtp_ssrc = enc->ssrc == G_MAXUINT ? g_random_int () : enc->ssrc;
+  enc->rtp_ts_base = enc->ts_offset == G_MAXUINT ?
+      g_random_int () : enc->ts_offset;
+  enc->rtp_seq_base = enc->seqnum_offset == -1 ?
+      g_random_int_range (0, G_MAXUINT16) : enc->seqnum_offset;
+  enc->rtp_ts = enc->rtp_ts_base;
+  enc->rtp_seq = enc->rtp_seq_base;
+  enc->rtp_marker = TRUE;
+
+  return TRUE;
+}
+
+static void
+gst_g729_enc_flush (GstAudioEncoder * aenc)
+{
+  GstG729Enc* enc = GST_G729_ENC (aenc);
+
+  gst_g729_enc_reset_channels (enc);
 }
 
 static gboolean
@@ -153,101 +476,503 @@ gst_g729_enc_stop (GstAudioEncoder * aenc)
 {
   GstG729Enc* enc = GST_G729_ENC (aenc);
 
-  enc->frameno = 0;
+  gst_g729_enc_free_pool (enc);
+
+  GST_INFO_OBJECT (enc, "maximum tick latency %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (enc->max_tick_latency));
+  enc->max_tick_latency = 0;
 
   return TRUE;
 }
 
+/* The base class only takes raw audio. G.711 caps are passed on as U8,
+ * which has the same layout, one byte per sample, so that the base class
+ * splits and timestamps the input right; handle_frame expands it. */
+static gboolean
+gst_g729_enc_sink_event (GstAudioEncoder * aenc, GstEvent * event)
+{
+  GstG729Enc* enc = GST_G729_ENC (aenc);
+  GstStructure *s;
+  GstCaps *caps;
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_CAPS)
+    goto done;
+
+  gst_event_parse_caps (event, &caps);
+  s = gst_caps_get_structure (caps, 0);
+
+  if (gst_structure_has_name (s, "audio/x-mulaw"))
+    enc->law = G729_G711_ULAW;
+  else if (gst_structure_has_name (s, "audio/x-alaw"))
+    enc->law = G729_G711_ALAW;
+  else
+    enc->law = G729_G711_NONE;
+
+  if (enc->law != G729_G711_NONE) {
+    s = gst_structure_copy (s);
+    gst_structure_set_name (s, "audio/x-raw");
+    gst_structure_set (s, "format", G_TYPE_STRING, "U8",
+        "layout", G_TYPE_STRING, "interleaved", NULL);
+
+    caps = gst_caps_new_full (s, NULL);
+    gst_event_unref (event);
+    event = gst_event_new_caps (caps);
+    gst_caps_unref (caps);
+  }
+
+done:
+  return GST_AUDIO_ENCODER_CLASS (gst_g729_enc_parent_class)->sink_event (aenc,
+      event);
+}
+
+/* Only the channels of the downstream caps apply upstream: the rate
+ * there is always 8000, the decimator taking the other input rates, so
+ * the default proxying of the rate would rule them out. RTP is mono. */
+static GstCaps *
+gst_g729_enc_getcaps (GstAudioEncoder * aenc, GstCaps * filter)
+{
+  GstCaps *templ, *allowed, *caps;
+  GstStructure *s, *t;
+  const GValue *channels;
+  GValue mono = G_VALUE_INIT, value = G_VALUE_INIT;
+  guint i, j;
+
+  templ = gst_pad_get_pad_template_caps (GST_AUDIO_ENCODER_SINK_PAD (aenc));
+  allowed = gst_pad_get_allowed_caps (GST_AUDIO_ENCODER_SRC_PAD (aenc));
+
+  if (!allowed || gst_caps_is_any (allowed)) {
+    caps = templ;
+    goto done;
+  }
+
+  g_value_init (&mono, G_TYPE_INT);
+  g_value_set_int (&mono, 1);
+
+  caps = gst_caps_new_empty ();
+  for (i = 0; i < gst_caps_get_size (allowed); i++) {
+    s = gst_caps_get_structure (allowed, i);
+    if (gst_structure_has_name (s, "application/x-rtp"))
+      channels = &mono;
+    else
+      channels = gst_structure_get_value (s, "channels");
+
+    for (j = 0; j < gst_caps_get_size (templ); j++) {
+      t = gst_structure_copy (gst_caps_get_structure (templ, j));
+      if (channels) {
+        if (!gst_value_intersect (&value,
+                gst_structure_get_value (t, "channels"), channels)) {
+          gst_structure_free (t);
+          continue;
+        }
+        gst_structure_set_value (t, "channels", &value);
+        g_value_unset (&value);
+      }
+      caps = gst_caps_merge_structure (caps, t);
+    }
+  }
+
+  g_value_unset (&mono);
+  gst_caps_unref (templ);
+
+done:
+  if (allowed)
+    gst_caps_unref (allowed);
+
+  if (filter) {
+    templ = caps;
+    caps = gst_caps_intersect_full (filter, templ, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (templ);
+  }
+
+  GST_LOG_OBJECT (aenc, "sink caps %" GST_PTR_FORMAT, caps);
+
+  return caps;
+}
+
 static gboolean
 gst_g729_enc_set_format (GstAudioEncoder * aenc, GstAudioInfo * info)
 {
+  GstG729Enc* enc = GST_G729_ENC (aenc);
   GstCaps *caps;
-  gboolean ret;
+  GstClockTime latency;
+  guint per_buffer, factor;
+  gboolean float_input, ret;
+
+  /* RTP when downstream prefers it, e.g. straight into udpsink */
+  caps = gst_pad_get_allowed_caps (GST_AUDIO_ENCODER_SRC_PAD (aenc));
+  enc->rtp = caps && !gst_caps_is_empty (caps) &&
+      gst_structure_has_name (gst_caps_get_structure (caps, 0),
+      "application/x-rtp");
+  if (caps)
+    gst_caps_unref (caps);
+
+  if (enc->rtp && GST_AUDIO_INFO_CHANNELS (info) > 1) {
+    GST_ELEMENT_ERROR (enc, CORE, NEGOTIATION, (NULL),
+        ("RTP output is mono only, got %d channels",
+            GST_AUDIO_INFO_CHANNELS (info)));
+    return FALSE;
+  }
+
+  /* codec states survive renegotiation as long as the layout stays */
+  if (enc->channels != GST_AUDIO_INFO_CHANNELS (info)) {
+    if (!gst_g729_enc_alloc_channels (enc, GST_AUDIO_INFO_CHANNELS (info))) {
+      gst_g729_enc_free_channels (enc);
+      GST_ELEMENT_ERROR (enc, RESOURCE, FAILED, (NULL),
+          ("failed to allocate codec state"));
+      return FALSE;
+    }
+  }
+
+  /* the filter history too, as long as the input format stays */
+  factor = GST_AUDIO_INFO_RATE (info) / SAMPLE_RATE;
+  float_input = GST_AUDIO_INFO_FORMAT (info) == GST_AUDIO_FORMAT_F32;
+  if (enc->decimator && (enc->factor != factor ||
+          enc->float_input != float_input)) {
+    g729_decimator_free (enc->decimator);
+    enc->decimator = NULL;
+  }
+  if (!enc->decimator && (factor > 1 || float_input)) {
+    enc->decimator = g729_decimator_new (factor, enc->channels);
+    if (!enc->decimator) {
+      GST_ELEMENT_ERROR (enc, RESOURCE, FAILED, (NULL),
+          ("failed to allocate decimator"));
+      return FALSE;
+    }
+  }
+  enc->rate = GST_AUDIO_INFO_RATE (info);
+  enc->bps = GST_AUDIO_INFO_BPS (info);
+  enc->factor = factor;
+  enc->float_input = float_input;
+
+  g_free (enc->pad);
+  enc->pad = g_malloc (enc->channels * RAW_FRAME_SAMPLES * factor * enc->bps);
+
+  if (!gst_g729_enc_setup_pool (enc))
+    return FALSE;
+
+  per_buffer = enc->low_latency ? 1 : enc->frames_per_buffer;
+
+  /* worst case: every frame a speech frame, plus the size tables */
+  g_free (enc->packet);
+  enc->packet = g_new (guint8, per_buffer * enc->channels *
+      (G729_FRAME_BYTES + (enc->channels > 1 ? 1 : 0)));
 
   gst_audio_encoder_set_frame_max (aenc, 1);
-  gst_audio_encoder_set_frame_samples_min (aenc, RAW_FRAME_SAMPLES);
-  gst_audio_encoder_set_frame_samples_max (aenc, RAW_FRAME_SAMPLES);
-  gst_audio_encoder_set_hard_min (aenc, TRUE);
+  gst_audio_encoder_set_frame_samples_min (aenc,
+      per_buffer * RAW_FRAME_SAMPLES * factor);
+  gst_audio_encoder_set_frame_samples_max (aenc,
+      per_buffer * RAW_FRAME_SAMPLES * factor);
+  /* the base class only hands over less at EOS, and that gets padded */
+  gst_audio_encoder_set_hard_min (aenc, FALSE);
+
+  /* each extra frame per buffer waits 10 ms more */
+  latency = ALGORITHMIC_DELAY + (per_buffer - 1) * FRAME_DURATION * GST_MSECOND;
+  if (enc->decimator)
+    latency += gst_util_uint64_scale (g729_decimator_get_delay (enc->decimator),
+        GST_SECOND, enc->rate);
+  gst_audio_encoder_set_latency (aenc, latency, latency);
 
-  caps = gst_pad_get_pad_template_caps (GST_AUDIO_ENCODER_SRC_PAD (aenc));
+  if (enc->rtp)
+    caps = gst_caps_new_simple ("application/x-rtp",
+        "media", G_TYPE_STRING, "audio",
+        "clock-rate", G_TYPE_INT, SAMPLE_RATE,
+        "encoding-name", G_TYPE_STRING, "G729",
+        "payload", G_TYPE_INT, enc->pt,
+        "ssrc", G_TYPE_UINT, enc->rtp_ssrc,
+        "timestamp-offset", G_TYPE_UINT, enc->rtp_ts_base,
+        "seqnum-offset", G_TYPE_UINT, (guint) enc->rtp_seq_base, NULL);
+  else if (enc->channels > 1)
+    caps = gst_caps_new_simple ("audio/G729",
+        "rate", G_TYPE_INT, SAMPLE_RATE,
+        "channels", G_TYPE_INT, enc->channels,
+        "layout", G_TYPE_STRING, G729_LAYOUT_SIZED, NULL);
+  else
+    caps = gst_caps_new_simple ("audio/G729",
+        "rate", G_TYPE_INT, SAMPLE_RATE,
+        "channels", G_TYPE_INT, enc->channels, NULL);
   ret = gst_audio_encoder_set_output_format (aenc, caps);
   gst_caps_unref (caps);
 
   return ret;
 }
 
-static gint g729_encode_frame (GstG729Enc* enc, const gint16* in, guint8* out){
-  int i,j,index;
-  extern Word16 *new_speech;
-  gint ret = G729_FRAME_BYTES;
+/* Encodes one 10 ms block of all channels into enc->frames/enc->sizes */
+static void
+gst_g729_enc_encode_block (GstG729Enc * enc, const gint16 * in)
+{
+  GstClockTime start, elapsed, busy;
+  guint i;
 
-  memcpy(new_speech,in,RAW_FRAME_BYTES);
+  start = gst_util_get_timestamp ();
 
-  Pre_Process(new_speech,L_FRAME);
-  Coder_ld8a(enc->parameters, enc->frameno, enc->vad);
-  prm2bits_ld8k(enc->parameters, enc->encoder_output);
+  /* one frame per channel, encoded in one go, or a range of them per job.
+   * Every job writes its own channel slots, so the output is the same
+   * whatever the scheduling. */
+  if (enc->pool) {
+    enc->jobs_pending = enc->n_jobs - 1;
+    for (i = 1; i < enc->n_jobs; i++) {
+      enc->jobs[i].in = in;
+      g_thread_pool_push (enc->pool, &enc->jobs[i], NULL);
+    }
+
+    gst_g729_enc_encode_channels (enc, in, enc->jobs[0].first,
+        enc->jobs[0].count);
+    busy = gst_util_get_timestamp () - start;
 
-  memset (out,0x0,G729_FRAME_BYTES);
+    g_mutex_lock (&enc->jobs_lock);
+    while (enc->jobs_pending > 0)
+      g_cond_wait (&enc->jobs_cond, &enc->jobs_lock);
+    g_mutex_unlock (&enc->jobs_lock);
 
-  for(i=0;i<10;i++){
-    for(j=0;j<8;j++){
-      index=2+(i*8)+j;
-      out[i]|=enc->encoder_output[index]==0x81?(1<<(7-j)):0;
+    for (i = 1; i < enc->n_jobs; i++)
+      busy += enc->jobs[i].elapsed;
+  } else {
+    gst_g729_enc_encode_channels (enc, in, 0, enc->channels);
+  }
+
+  elapsed = gst_util_get_timestamp () - start;
+  if (!enc->pool)
+    busy = elapsed;
+
+  /* the time of a frame is what all threads spent on the block, spread
+   * over the channels: what a channel costs, whatever the threading */
+  GST_G729_STATS_LOCK (&enc->stats);
+  for (i = 0; i < enc->channels; i++)
+    gst_g729_stats_add_frame (&enc->stats, enc->sizes[i]);
+  gst_g729_stats_add_time (&enc->stats, busy / enc->channels, enc->channels);
+  gst_g729_stats_add_tick (&enc->stats, elapsed);
+  GST_G729_STATS_UNLOCK (&enc->stats);
+
+  if (elapsed > enc->max_tick_latency) {
+    enc->max_tick_latency = elapsed;
+    GST_DEBUG_OBJECT (enc, "new maximum tick latency %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (elapsed));
+  }
+}
+
+/* Pushes the frames gathered in enc->packet as one buffer, or as one RTP
+ * packet, header and frames written in place */
+static GstFlowReturn
+gst_g729_enc_push_packet (GstG729Enc * enc)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *outbuf;
+  guint samples = enc->packet_samples;
+  guint size = enc->packet_size;
+
+  if (samples == 0)
+    return GST_FLOW_OK;
+
+  enc->packet_samples = 0;
+  enc->packet_size = 0;
+
+  if (enc->rtp) {
+    outbuf = gst_rtp_buffer_new_allocate (size, 0, 0);
+    gst_rtp_buffer_map (outbuf, GST_MAP_WRITE, &rtp);
+    gst_rtp_buffer_set_payload_type (&rtp, enc->pt);
+    gst_rtp_buffer_set_ssrc (&rtp, enc->rtp_ssrc);
+    gst_rtp_buffer_set_seq (&rtp, enc->rtp_seq++);
+    gst_rtp_buffer_set_timestamp (&rtp, enc->rtp_ts);
+    /* a SID frame can only come last, so this is a speech packet */
+    if (enc->rtp_marker && size >= G729_FRAME_BYTES) {
+      gst_rtp_buffer_set_marker (&rtp, TRUE);
+      enc->rtp_marker = FALSE;
     }
+    memcpy (gst_rtp_buffer_get_payload (&rtp), enc->packet, size);
+    gst_rtp_buffer_unmap (&rtp);
+  } else {
+    outbuf = gst_audio_encoder_allocate_output_buffer (GST_AUDIO_ENCODER (enc),
+        size);
+    if (!outbuf)
+      return GST_FLOW_OK;
+
+    gst_buffer_fill (outbuf, 0, enc->packet, size);
   }
 
-  switch (enc->parameters[0]){
-    case G729_SID_FRAME:
-      GST_DEBUG_OBJECT (enc, "SID detected");
-      ret = G729_SID_BYTES;
-      break;
-    case G729_SILENCE_FRAME:
-      GST_DEBUG_OBJECT (enc, "No-transmission detected");
-      ret = G729_SILENCE_BYTES;
-      break;
+  enc->rtp_ts += samples / enc->factor;
+
+  return gst_audio_encoder_finish_frame (GST_AUDIO_ENCODER (enc), outbuf,
+      samples);
+}
+
+/* Adds the frames of the last encoded block, standing for samples input
+ * samples per channel, to the packet being gathered; pushes it when a
+ * frame can't go in the same packet as the next ones */
+static GstFlowReturn
+gst_g729_enc_add_block (GstG729Enc * enc, guint samples)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint8 *out_ptr;
+  guint j;
+
+  out_ptr = enc->packet + enc->packet_size;
+
+  if (enc->channels > 1) {
+    /* size table, then the frames */
+    for (j = 0; j < enc->channels; j++)
+      *out_ptr++ = enc->sizes[j];
+    for (j = 0; j < enc->channels; j++) {
+      memcpy (out_ptr, enc->frames + j * G729_FRAME_BYTES, enc->sizes[j]);
+      out_ptr += enc->sizes[j];
+    }
+
+    enc->packet_size = out_ptr - enc->packet;
+    enc->packet_samples += samples;
+    return GST_FLOW_OK;
+  }
+
+  if (enc->sizes[0] == G729_SILENCE_BYTES) {
+    /* nothing is sent for this frame, so what's before it goes out on
+     * its own to keep every buffer contiguous in time */
+    ret = gst_g729_enc_push_packet (enc);
+    if (ret == GST_FLOW_OK)
+      ret = gst_audio_encoder_finish_frame (GST_AUDIO_ENCODER (enc), NULL,
+          samples);
+
+    /* the RTP clock runs on over untransmitted frames */
+    enc->rtp_ts += samples / enc->factor;
+    enc->rtp_marker = TRUE;
+    return ret;
+  }
+
+  memcpy (out_ptr, enc->frames, enc->sizes[0]);
+  enc->packet_size += enc->sizes[0];
+  enc->packet_samples += samples;
+
+  /* RFC 3551: a SID frame can only be the last one of a packet, and
+   * the next speech packet starts a talkspurt */
+  if (enc->sizes[0] == G729_SID_BYTES) {
+    ret = gst_g729_enc_push_packet (enc);
+    enc->rtp_marker = TRUE;
   }
 
   return ret;
 }
 
+/* The coder analyses each frame with LOOKAHEAD_SAMPLES of look-ahead, so
+ * it encodes its input that much late: at EOS the end of the last frame
+ * has only been look-ahead. One more frame of silence gets it out,
+ * finished with the 5 ms it stands for; the base class lets a drain
+ * finish more samples than it handed over. */
 static GstFlowReturn
-gst_g729_enc_handle_frame (GstAudioEncoder * aenc, GstBuffer * buf)
+gst_g729_enc_drain (GstG729Enc * enc)
 {
-  GstG729Enc* enc = GST_G729_ENC (aenc);
-  GstFlowReturn ret = GST_FLOW_OK;
-  GstMapInfo imap, omap;
-  GstBuffer *outbuf;
-  gint out;
+  GstFlowReturn ret;
 
-  outbuf = gst_audio_encoder_allocate_output_buffer (GST_AUDIO_ENCODER (enc), G729_FRAME_BYTES);
+  if (!enc->lookahead_pending)
+    return GST_FLOW_OK;
+  enc->lookahead_pending = FALSE;
 
-  if (!outbuf)
-    goto done;
+  GST_DEBUG_OBJECT (enc, "flushing the look-ahead");
 
-  if (enc->frameno == 32767){
-    enc->frameno = 256;
+  enc->packet_size = 0;
+  enc->packet_samples = 0;
+
+  if (enc->decimator) {
+    memset (enc->pad, 0, RAW_FRAME_SAMPLES * enc->factor * enc->channels *
+        enc->bps);
+    if (enc->float_input)
+      g729_decimator_process_f32 (enc->decimator, (const gfloat *) enc->pad,
+          enc->tail);
+    else
+      g729_decimator_process_s16 (enc->decimator, (const gint16 *) enc->pad,
+          enc->tail);
   } else {
-    enc->frameno++;
+    memset (enc->tail, 0, enc->channels * RAW_FRAME_BYTES);
   }
+  gst_g729_enc_encode_block (enc, enc->tail);
+
+  ret = gst_g729_enc_add_block (enc, LOOKAHEAD_SAMPLES * enc->factor);
+  if (ret == GST_FLOW_OK)
+    ret = gst_g729_enc_push_packet (enc);
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_g729_enc_handle_frame (GstAudioEncoder * aenc, GstBuffer * buf)
+{
+  GstG729Enc* enc = GST_G729_ENC (aenc);
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstMapInfo imap;
+  GstStructure *stats;
+  const guint8 *in, *block;
+  gsize frame_bytes, remaining;
+  guint samples, frame_samples, stride;
+
+  /* drain: only the look-ahead is held back between calls */
+  if (!buf)
+    return gst_g729_enc_drain (enc);
 
   gst_buffer_map (buf, &imap, GST_MAP_READ);
-  gst_buffer_map (outbuf, &omap, GST_MAP_WRITE);
 
-  out = g729_encode_frame (enc, (const gint16 *) imap.data, omap.data);
+  in = imap.data;
+  stride = enc->channels * enc->bps;
+  frame_samples = RAW_FRAME_SAMPLES * enc->factor;
+  frame_bytes = frame_samples * stride;
 
-  gst_buffer_unmap (buf, &imap);
-  gst_buffer_unmap (outbuf, &omap);
+  enc->packet_size = 0;
+  enc->packet_samples = 0;
 
-  if(out == G729_SILENCE_BYTES){
-    gst_buffer_unref(outbuf);
-    outbuf = NULL;
-  } else {
-    gst_buffer_set_size (outbuf, out);
+  for (remaining = imap.size; remaining > 0 && ret == GST_FLOW_OK;
+      remaining -= samples * stride) {
+    if (remaining >= frame_bytes) {
+      samples = frame_samples;
+    } else {
+      /* end of stream: the last frame is zero-padded */
+      samples = remaining / stride;
+      if (samples == 0)
+        break;
+
+      GST_DEBUG_OBJECT (enc, "padding last frame of %u samples", samples);
+    }
+
+    if (enc->law != G729_G711_NONE) {
+      /* expanded into the scratch block, padding included */
+      g729_g711_expand (enc->law, in, enc->tail, samples * enc->channels);
+      memset (enc->tail + samples * enc->channels, 0,
+          (RAW_FRAME_SAMPLES - samples) * enc->channels * 2);
+      gst_g729_enc_encode_block (enc, enc->tail);
+    } else {
+      block = in;
+      if (samples < frame_samples) {
+        memset (enc->pad, 0, frame_bytes);
+        memcpy (enc->pad, in, samples * stride);
+        block = enc->pad;
+      }
+
+      if (!enc->decimator) {
+        gst_g729_enc_encode_block (enc, (const gint16 *) block);
+      } else {
+        if (enc->float_input)
+          g729_decimator_process_f32 (enc->decimator, (const gfloat *) block,
+              enc->tail);
+        else
+          g729_decimator_process_s16 (enc->decimator, (const gint16 *) block,
+              enc->tail);
+        gst_g729_enc_encode_block (enc, enc->tail);
+      }
+    }
+    in += samples * stride;
+    enc->lookahead_pending = TRUE;
+
+    ret = gst_g729_enc_add_block (enc, samples);
   }
 
-  ret = gst_audio_encoder_finish_frame (GST_AUDIO_ENCODER (enc), outbuf, RAW_FRAME_SAMPLES);
+  GST_G729_STATS_LOCK (&enc->stats);
+  stats = gst_g729_stats_advance (&enc->stats,
+      gst_util_uint64_scale (imap.size / stride, GST_SECOND, enc->rate),
+      enc->stats_interval, STATS_NAME);
+  GST_G729_STATS_UNLOCK (&enc->stats);
 
-done:
+  gst_buffer_unmap (buf, &imap);
+
+  if (stats)
+    gst_element_post_message (GST_ELEMENT (enc),
+        gst_message_new_element (GST_OBJECT (enc), stats));
+
+  if (ret == GST_FLOW_OK)
+    ret = gst_g729_enc_push_packet (enc);
 
   return ret;
 }
@@ -264,6 +989,40 @@ gst_g729_enc_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_VAD:
       g_value_set_boolean (value, enc->vad);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, enc->n_threads);
+      break;
+    case PROP_MAX_TICK_LATENCY:
+      g_value_set_uint64 (value, enc->max_tick_latency);
+      break;
+    case PROP_FRAMES_PER_BUFFER:
+      g_value_set_uint (value, enc->frames_per_buffer);
+      break;
+    case PROP_LOW_LATENCY:
+      g_value_set_boolean (value, enc->low_latency);
+      break;
+    case PROP_COMPLEXITY:
+      g_value_set_uint (value, enc->complexity);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value,
+          gst_g729_stats_get_structure (&enc->stats, STATS_NAME));
+      break;
+    case PROP_STATS_INTERVAL:
+      g_value_set_uint64 (value, enc->stats_interval);
+      break;
+    case PROP_PT:
+      g_value_set_uint (value, enc->pt);
+      break;
+    case PROP_SSRC:
+      g_value_set_uint (value, enc->ssrc);
+      break;
+    case PROP_TIMESTAMP_OFFSET:
+      g_value_set_uint (value, enc->ts_offset);
+      break;
+    case PROP_SEQNUM_OFFSET:
+      g_value_set_int (value, enc->seqnum_offset);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -275,12 +1034,44 @@ gst_g729_enc_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
 {
   GstG729Enc *enc;
+  guint i;
 
   enc = GST_G729_ENC (object);
 
   switch (prop_id) {
     case PROP_VAD:
       enc->vad = g_value_get_boolean (value);
+      for (i = 0; i < enc->channels; i++)
+        g729_encoder_set_vad (enc->encoders[i], enc->vad);
+      break;
+    case PROP_N_THREADS:
+      enc->n_threads = g_value_get_uint (value);
+      break;
+    case PROP_FRAMES_PER_BUFFER:
+      enc->frames_per_buffer = g_value_get_uint (value);
+      break;
+    case PROP_LOW_LATENCY:
+      enc->low_latency = g_value_get_boolean (value);
+      break;
+    case PROP_COMPLEXITY:
+      enc->complexity = g_value_get_uint (value);
+      for (i = 0; i < enc->channels; i++)
+        g729_encoder_set_complexity (enc->encoders[i], enc->complexity);
+      break;
+    case PROP_STATS_INTERVAL:
+      enc->stats_interval = g_value_get_uint64 (value);
+      break;
+    case PROP_PT:
+      enc->pt = g_value_get_uint (value);
+      break;
+    case PROP_SSRC:
+      enc->ssrc = g_value_get_uint (value);
+      break;
+    case PROP_TIMESTAMP_OFFSET:
+      enc->ts_offset = g_value_get_uint (value);
+      break;
+    case PROP_SEQNUM_OFFSET:
+      enc->seqnum_offset = g_value_get_int (value);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
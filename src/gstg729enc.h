@@ -46,7 +46,12 @@
 
 #include <gst/gst.h>
 #include <gst/audio/audio.h>
+#include <gst/rtp/gstrtpbuffer.h>
 #include "g729common.h"
+#include "g729.h"
+#include "gstg729stats.h"
+#include "g729g711.h"
+#include "g729decimate.h"
 
 G_BEGIN_DECLS
 
@@ -64,16 +69,68 @@ G_BEGIN_DECLS
 
 typedef struct _GstG729Enc GstG729Enc;
 typedef struct _GstG729EncClass GstG729EncClass;
+typedef struct _GstG729EncJob GstG729EncJob;
+
+/* a contiguous group of channels encoded by one pool thread */
+struct _GstG729EncJob {
+  GstG729Enc            *enc;
+  const gint16          *in;        /* interleaved input of the current tick */
+  guint                 first;
+  guint                 count;
+  GstClockTime          elapsed;    /* spent on the current tick */
+};
 
 struct _GstG729Enc {
   GstAudioEncoder       parent;
 
   guint16               vad;
-  guint16               frameno;
+  guint                 complexity;
+
+  guint                 channels;
+  G729G711Law           law;        /* of the input, if G.711 */
+  gint                  rate;
+  guint                 bps;        /* bytes per input sample */
+  guint                 factor;     /* rate / 8000 */
+  gboolean              float_input;
+  G729Decimator         *decimator; /* for wideband or float input */
+  G729Encoder           **encoders;  /* one per channel */
+  guint8                *frames;    /* encoded frames, one slot per channel */
+  gint                  *sizes;
+
+  guint                 frames_per_buffer;
+  gboolean              low_latency;
+  guint8                *packet;    /* output being gathered */
+  guint                 packet_size;
+  guint                 packet_samples;
+  guint8                *pad;       /* zero-padded last input frame */
+  gint16                *tail;      /* expanded G.711 or decimated input */
+  gboolean              lookahead_pending;  /* input not flushed at EOS */
+
+  guint                 n_threads;
+  GThreadPool           *pool;
+  GstG729EncJob         *jobs;
+  guint                 n_jobs;
+  guint                 jobs_pending;  /* jobs_lock */
+  GMutex                jobs_lock;
+  GCond                 jobs_cond;
+
+  GstClockTime          max_tick_latency;
+
+  GstG729Stats          stats;
+  GstClockTime          stats_interval;
 
-  /* Reference code specific */
-  guint16 parameters[PRM_SIZE+1];
-  guint16 encoder_output[SERIAL_SIZE];
+  /* RTP output */
+  guint                 pt;
+  guint                 ssrc;         /* G_MAXUINT = random */
+  guint                 ts_offset;    /* G_MAXUINT = random */
+  gint                  seqnum_offset;  /* -1 = random */
+  gboolean              rtp;
+  guint32               rtp_ssrc;
+  guint32               rtp_ts;       /* of the first frame of packet */
+  guint16               rtp_seq;
+  guint32               rtp_ts_base;
+  guint16               rtp_seq_base;
+  gboolean              rtp_marker;   /* next packet starts a talkspurt */
 };
 
 struct _GstG729EncClass {
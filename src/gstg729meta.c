@@ -0,0 +1,138 @@
+/* GladSToNe g729 parameters meta
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstg729meta.h"
+#include <string.h>
+
+GType
+gst_g729_params_meta_api_get_type (void)
+{
+  static volatile GType type;
+  static const gchar *tags[] = { NULL };
+
+  if (g_once_init_enter (&type)) {
+    GType _type = gst_meta_api_type_register ("GstG729ParamsMetaAPI", tags);
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+static gboolean
+gst_g729_params_meta_init (GstMeta * meta, gpointer params, GstBuffer * buffer)
+{
+  GstG729ParamsMeta *pmeta = (GstG729ParamsMeta *) meta;
+
+  pmeta->n_frames = 0;
+  pmeta->frames = NULL;
+
+  return TRUE;
+}
+
+static void
+gst_g729_params_meta_free (GstMeta * meta, GstBuffer * buffer)
+{
+  GstG729ParamsMeta *pmeta = (GstG729ParamsMeta *) meta;
+
+  g_free (pmeta->frames);
+}
+
+/* The parameters describe the whole payload, so they only survive copies
+ * of all of it */
+static gboolean
+gst_g729_params_meta_transform (GstBuffer * dest, GstMeta * meta,
+    GstBuffer * buffer, GQuark type, gpointer data)
+{
+  GstG729ParamsMeta *pmeta = (GstG729ParamsMeta *) meta;
+  GstG729ParamsMeta *dmeta;
+
+  if (!GST_META_TRANSFORM_IS_COPY (type))
+    return FALSE;
+
+  if (((GstMetaTransformCopy *) data)->region)
+    return FALSE;
+
+  dmeta = gst_buffer_add_g729_params_meta (dest, pmeta->n_frames);
+  if (!dmeta)
+    return FALSE;
+
+  memcpy (dmeta->frames, pmeta->frames,
+      pmeta->n_frames * sizeof (GstG729FrameParams));
+
+  return TRUE;
+}
+
+const GstMetaInfo *
+gst_g729_params_meta_get_info (void)
+{
+  static const GstMetaInfo *meta_info = NULL;
+
+  if (g_once_init_enter ((GstMetaInfo **) & meta_info)) {
+    const GstMetaInfo *mi = gst_meta_register (GST_G729_PARAMS_META_API_TYPE,
+        "GstG729ParamsMeta", sizeof (GstG729ParamsMeta),
+        gst_g729_params_meta_init, gst_g729_params_meta_free,
+        gst_g729_params_meta_transform);
+    g_once_init_leave ((GstMetaInfo **) & meta_info, (GstMetaInfo *) mi);
+  }
+  return meta_info;
+}
+
+/* Adds a meta with room for n_frames zeroed entries */
+GstG729ParamsMeta *
+gst_buffer_add_g729_params_meta (GstBuffer * buffer, guint n_frames)
+{
+  GstG729ParamsMeta *meta;
+
+  meta = (GstG729ParamsMeta *) gst_buffer_add_meta (buffer,
+      GST_G729_PARAMS_META_INFO, NULL);
+  if (!meta)
+    return NULL;
+
+  meta->n_frames = n_frames;
+  meta->frames = g_new0 (GstG729FrameParams, n_frames);
+
+  return meta;
+}
@@ -0,0 +1,111 @@
+/* GladSToNe g729 parameters meta
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __GST_G729_META_H__
+#define __GST_G729_META_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_G729_PARAMS_META_API_TYPE (gst_g729_params_meta_api_get_type())
+#define GST_G729_PARAMS_META_INFO (gst_g729_params_meta_get_info())
+
+#define gst_buffer_get_g729_params_meta(b) \
+  ((GstG729ParamsMeta*)gst_buffer_get_meta((b),GST_G729_PARAMS_META_API_TYPE))
+
+typedef struct _GstG729FrameParams GstG729FrameParams;
+typedef struct _GstG729ParamsMeta GstG729ParamsMeta;
+
+typedef enum {
+  GST_G729_FRAME_NONE,      /* untransmitted, DTX */
+  GST_G729_FRAME_SPEECH,
+  GST_G729_FRAME_SID        /* Annex B silence descriptor */
+} GstG729FrameType;
+
+/* The quantisation indices of one frame, as transmitted. Fields not
+ * carried by the frame type are 0. */
+struct _GstG729FrameParams {
+  GstG729FrameType      type;
+  guint                 channel;
+
+  /* speech: L0+L1 (8 bits) and L2+L3 (10 bits); SID: the MA predictor
+   * switch (1 bit) and the two LSF codebook indices (5 and 4 bits) */
+  guint16               lsp[3];
+
+  /* speech, per subframe: the pitch delay indices (8 bits absolute, 5 bits
+   * relative), the integer pitch lags they decode to in samples, and the
+   * conjugate gain codebook indices GA+GB (7 bits) */
+  guint8                pitch_index[2];
+  guint8                pitch_lag[2];
+  guint8                gain_index[2];
+  gboolean              parity_ok;
+
+  /* SID: the quantised energy index (5 bits) */
+  guint8                energy_index;
+};
+
+/**
+ * GstG729ParamsMeta:
+ * @meta: parent #GstMeta
+ * @n_frames: number of entries in @frames
+ * @frames: the parameters of every frame in the buffer, in stream order
+ *
+ * Parameters of the G729 frames carried by a buffer, extracted without
+ * decoding them.
+ */
+struct _GstG729ParamsMeta {
+  GstMeta               meta;
+
+  guint                 n_frames;
+  GstG729FrameParams    *frames;
+};
+
+GType gst_g729_params_meta_api_get_type (void);
+const GstMetaInfo *gst_g729_params_meta_get_info (void);
+
+GstG729ParamsMeta *gst_buffer_add_g729_params_meta (GstBuffer *buffer,
+    guint n_frames);
+
+G_END_DECLS
+
+#endif /* __GST_G729_META_H__ */
@@ -0,0 +1,288 @@
+/* GladSToNe g729 parameters tap
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+/**
+ * SECTION:element-g729params
+ * @see_also: g729dec
+ *
+ * This element passes a G729 stream through untouched, attaching to every
+ * buffer a #GstG729ParamsMeta with the transmitted parameters of its
+ * frames: frame type, pitch delays and lags, gain and LSP indices.
+ *
+ * The frames are only unpacked, not decoded, which makes it a cheap way to
+ * get voice activity, pitch and energy hints out of a stream that doesn't
+ * need to be listened to.
+ *
+ * <refsect2>
+ * <title>Example pipelines</title>
+ * |[
+ * gst-launch-1.0 udpsrc caps=... ! rtpg729depay ! g729params ! appsink
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstg729params.h"
+#include "g729bits.h"
+
+GST_DEBUG_CATEGORY_EXTERN (g729params_debug);
+#define GST_CAT_DEFAULT g729params_debug
+
+/* pitch delay range, as PIT_MIN/PIT_MAX in the reference code */
+#define G729_PIT_MIN 20
+#define G729_PIT_MAX 143
+
+static GstStaticPadTemplate g729_params_src_factory =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (G729_CAPS)
+    );
+
+static GstStaticPadTemplate g729_params_sink_factory =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (G729_CAPS)
+    );
+
+G_DEFINE_TYPE (GstG729Params, gst_g729_params, GST_TYPE_BASE_TRANSFORM);
+
+static gboolean gst_g729_params_set_caps (GstBaseTransform * trans,
+    GstCaps * incaps, GstCaps * outcaps);
+static GstFlowReturn gst_g729_params_transform_ip (GstBaseTransform * trans,
+    GstBuffer * buf);
+
+static void
+gst_g729_params_class_init (GstG729ParamsClass * klass)
+{
+  GstElementClass *gstelement_class;
+  GstBaseTransformClass *gstbasetransform_class;
+
+  gstelement_class = (GstElementClass *) klass;
+  gstbasetransform_class = (GstBaseTransformClass *) klass;
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&g729_params_src_factory));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&g729_params_sink_factory));
+  gst_element_class_set_static_metadata (gstelement_class,
+    "G729 parameters tap",
+    "Codec/Analyzer/Audio",
+    "attach the transmitted parameters of g729 frames as metadata",
+    "Gibro Vacco <gibrovacco@gmail.com>");
+
+  gstbasetransform_class->set_caps = GST_DEBUG_FUNCPTR (gst_g729_params_set_caps);
+  gstbasetransform_class->transform_ip =
+      GST_DEBUG_FUNCPTR (gst_g729_params_transform_ip);
+}
+
+static void
+gst_g729_params_init (GstG729Params * params)
+{
+  /* the payload goes through untouched, but the meta needs a writable
+   * buffer */
+  gst_base_transform_set_in_place (GST_BASE_TRANSFORM (params), TRUE);
+
+  params->channels = 1;
+}
+
+static gboolean
+gst_g729_params_set_caps (GstBaseTransform * trans, GstCaps * incaps,
+    GstCaps * outcaps)
+{
+  GstG729Params *params = GST_G729_PARAMS (trans);
+  GstStructure *s;
+  gint channels = 1;
+
+  s = gst_caps_get_structure (incaps, 0);
+  gst_structure_get_int (s, "channels", &channels);
+  params->channels = channels;
+
+  return TRUE;
+}
+
+/* The integer part of the pitch lags, as Dec_lag3() computes them */
+static void
+gst_g729_params_pitch_lags (GstG729FrameParams * frame)
+{
+  guint t0, t0_min, t0_max;
+  guint index = frame->pitch_index[0];
+
+  if (index < 197)
+    t0 = (((index + 2) * 10923) >> 15) + 19;
+  else
+    t0 = index - 112;
+  frame->pitch_lag[0] = t0;
+
+  t0_min = MAX (t0, G729_PIT_MIN + 5) - 5;
+  t0_max = t0_min + 9;
+  if (t0_max > G729_PIT_MAX)
+    t0_min = G729_PIT_MAX - 9;
+
+  index = frame->pitch_index[1];
+  frame->pitch_lag[1] = (((index + 2) * 10923) >> 15) - 1 + t0_min;
+}
+
+static gboolean
+gst_g729_params_parse_frame (const guint8 * data, guint size,
+    GstG729FrameParams * frame)
+{
+  gint16 prm[1 + G729_BITS_SPEECH_PARAMS];
+
+  if (g729_bits_unpack (data, size, prm) < 0)
+    return FALSE;
+
+  switch (prm[0]) {
+    case G729_SPEECH_FRAME:
+      frame->type = GST_G729_FRAME_SPEECH;
+      frame->lsp[0] = prm[1];
+      frame->lsp[1] = prm[2];
+      frame->pitch_index[0] = prm[3];
+      frame->parity_ok = g729_bits_parity_ok (prm[3], prm[4]);
+      frame->gain_index[0] = prm[7];
+      frame->pitch_index[1] = prm[8];
+      frame->gain_index[1] = prm[11];
+      gst_g729_params_pitch_lags (frame);
+      break;
+    case G729_SID_FRAME:
+      frame->type = GST_G729_FRAME_SID;
+      frame->lsp[0] = prm[1];
+      frame->lsp[1] = prm[2];
+      frame->lsp[2] = prm[3];
+      frame->energy_index = prm[4];
+      break;
+    default:
+      frame->type = GST_G729_FRAME_NONE;
+      break;
+  }
+
+  return TRUE;
+}
+
+/* Walks the payload, filling frames when not NULL. Returns the number of
+ * frames, or -1 if the payload is malformed. */
+static gint
+gst_g729_params_parse (GstG729Params * params, const guint8 * data,
+    gsize size, GstG729FrameParams * frames)
+{
+  const guint8 *table;
+  gsize offset = 0, payload;
+  guint n = 0, i;
+
+  if (params->channels == 1) {
+    /* plain RFC 3551: speech frames, possibly ending with a SID */
+    while (offset < size) {
+      guint frame_size = size - offset >= G729_FRAME_BYTES ?
+          G729_FRAME_BYTES : size - offset;
+
+      if (frame_size != G729_FRAME_BYTES && frame_size != G729_SID_BYTES)
+        return -1;
+      if (frames && !gst_g729_params_parse_frame (data + offset, frame_size,
+              &frames[n]))
+        return -1;
+
+      offset += frame_size;
+      n++;
+    }
+    return n;
+  }
+
+  while (offset < size) {
+    if (size - offset < params->channels)
+      return -1;
+
+    table = data + offset;
+    offset += params->channels;
+
+    for (i = 0, payload = 0; i < params->channels; i++)
+      payload += table[i];
+    if (size - offset < payload)
+      return -1;
+
+    for (i = 0; i < params->channels; i++) {
+      if (frames) {
+        frames[n].channel = i;
+        if (!gst_g729_params_parse_frame (data + offset, table[i], &frames[n]))
+          return -1;
+      } else if (table[i] != G729_FRAME_BYTES && table[i] != G729_SID_BYTES &&
+          table[i] != G729_SILENCE_BYTES) {
+        return -1;
+      }
+      offset += table[i];
+      n++;
+    }
+  }
+
+  return n;
+}
+
+static GstFlowReturn
+gst_g729_params_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
+{
+  GstG729Params *params = GST_G729_PARAMS (trans);
+  GstG729ParamsMeta *meta;
+  GstMapInfo map;
+  gint n_frames;
+
+  if (!gst_buffer_map (buf, &map, GST_MAP_READ))
+    return GST_FLOW_OK;
+
+  n_frames = gst_g729_params_parse (params, map.data, map.size, NULL);
+  if (n_frames < 0) {
+    GST_WARNING_OBJECT (params, "malformed payload of %" G_GSIZE_FORMAT
+        " bytes, not attaching parameters", map.size);
+  } else if (n_frames > 0) {
+    meta = gst_buffer_add_g729_params_meta (buf, n_frames);
+    if (meta)
+      gst_g729_params_parse (params, map.data, map.size, meta->frames);
+  }
+
+  gst_buffer_unmap (buf, &map);
+
+  return GST_FLOW_OK;
+}
@@ -47,13 +47,26 @@
 
 #include "gstg729enc.h"
 #include "gstg729dec.h"
+#include "gstg729params.h"
+#include "gstg729splice.h"
+#include "g729g711.h"
+#ifdef G729_PROBES
+#include "gstg729tracer.h"
+#endif
 
 GST_DEBUG_CATEGORY (g729enc_debug);
 GST_DEBUG_CATEGORY (g729dec_debug);
+GST_DEBUG_CATEGORY (g729params_debug);
+GST_DEBUG_CATEGORY (g729splice_debug);
+#ifdef G729_PROBES
+GST_DEBUG_CATEGORY (g729tracer_debug);
+#endif
 
 static gboolean
 plugin_init (GstPlugin * plugin)
 {
+  g729_g711_init ();
+
   if (!gst_element_register (plugin, "g729enc", GST_RANK_NONE,
         gst_g729_enc_get_type ()))
     return FALSE;
@@ -62,10 +75,30 @@ plugin_init (GstPlugin * plugin)
         gst_g729_dec_get_type ()))
     return FALSE;
 
+  if (!gst_element_register (plugin, "g729params", GST_RANK_NONE,
+        gst_g729_params_get_type ()))
+    return FALSE;
+
+  if (!gst_element_register (plugin, "g729splice", GST_RANK_NONE,
+        gst_g729_splice_get_type ()))
+    return FALSE;
+
   GST_DEBUG_CATEGORY_INIT (g729enc_debug, "g729enc", 0,
       "g729 encoding element");
   GST_DEBUG_CATEGORY_INIT (g729dec_debug, "g729dec", 0,
       "g729 decoding element");
+  GST_DEBUG_CATEGORY_INIT (g729params_debug, "g729params", 0,
+      "g729 parameters tap");
+  GST_DEBUG_CATEGORY_INIT (g729splice_debug, "g729splice", 0,
+      "g729 compressed domain splicer");
+
+#ifdef G729_PROBES
+  if (!gst_tracer_register (plugin, "g729stages", gst_g729_tracer_get_type ()))
+    return FALSE;
+
+  GST_DEBUG_CATEGORY_INIT (g729tracer_debug, "g729stages", 0,
+      "g729 codec stage tracer");
+#endif
 
   return TRUE;
 }
@@ -0,0 +1,542 @@
+/* GladSToNe g729 splicer
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+/**
+ * SECTION:element-g729splice
+ * @see_also: g729enc, g729dec
+ *
+ * This element edits G729 streams in the compressed domain, at frame
+ * boundaries, without decoding or re-encoding them.
+ *
+ * With #GstG729Splice:max-silence set, Annex B DTX periods (SID frames and
+ * untransmitted frames) are cut down to that length and the following
+ * timestamps are moved back accordingly.
+ *
+ * At splice points, which are discontinuous buffers and new segments,
+ * #GstG729Splice:bridge inserts a SID frame before the new material so
+ * that the decoder goes through comfort noise instead of predicting the
+ * new speech from the old one. The SID repeats the last noise description
+ * seen in the stream, or the quietest one the codec can express.
+ *
+ * <refsect2>
+ * <title>Example pipelines</title>
+ * |[
+ * gst-launch-1.0 filesrc location=prompts.mkv ! matroskademux !
+ *     g729splice max-silence=500000000 ! matroskamux ! filesink location=out.mkv
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstg729splice.h"
+#include <string.h>
+
+GST_DEBUG_CATEGORY_EXTERN (g729splice_debug);
+#define GST_CAT_DEFAULT g729splice_debug
+
+#define G729_FRAME_DURATION (FRAME_DURATION * GST_MSECOND)
+
+#define DEFAULT_MAX_SILENCE     GST_CLOCK_TIME_NONE
+#define DEFAULT_BRIDGE          TRUE
+
+/* all-zero parameters: first LSF codebook entries, lowest energy */
+static const guint8 g729_splice_default_sid[G729_SID_BYTES] = { 0x00, 0x00 };
+
+enum
+{
+  PROP_0,
+  PROP_MAX_SILENCE,
+  PROP_BRIDGE,
+};
+
+static GstStaticPadTemplate g729_splice_src_factory =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (G729_CAPS)
+    );
+
+static GstStaticPadTemplate g729_splice_sink_factory =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (G729_CAPS)
+    );
+
+G_DEFINE_TYPE (GstG729Splice, gst_g729_splice, GST_TYPE_ELEMENT);
+
+static void gst_g729_splice_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_g729_splice_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_g729_splice_finalize (GObject * object);
+static GstStateChangeReturn gst_g729_splice_change_state (GstElement * element,
+    GstStateChange transition);
+static gboolean gst_g729_splice_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event);
+static GstFlowReturn gst_g729_splice_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buf);
+
+static void
+gst_g729_splice_class_init (GstG729SpliceClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstElementClass *gstelement_class;
+
+  gobject_class = (GObjectClass *) klass;
+  gstelement_class = (GstElementClass *) klass;
+
+  gobject_class->set_property = gst_g729_splice_set_property;
+  gobject_class->get_property = gst_g729_splice_get_property;
+  gobject_class->finalize = gst_g729_splice_finalize;
+
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_MAX_SILENCE,
+      g_param_spec_uint64 ("max-silence", "Maximum silence",
+          "Longest DTX period kept, in nanoseconds, longer ones are trimmed "
+          "(-1 = keep everything)", 0, G_MAXUINT64, DEFAULT_MAX_SILENCE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_BRIDGE,
+      g_param_spec_boolean ("bridge", "Bridge",
+          "Insert a SID frame at splice points", DEFAULT_BRIDGE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&g729_splice_src_factory));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&g729_splice_sink_factory));
+  gst_element_class_set_static_metadata (gstelement_class, "G729 splicer",
+    "Filter/Editor/Audio",
+    "trim silence and bridge splice points of g729 streams without "
+    "re-encoding",
+    "Gibro Vacco <gibrovacco@gmail.com>");
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_g729_splice_change_state);
+}
+
+static void
+gst_g729_splice_init (GstG729Splice * splice)
+{
+  splice->sinkpad =
+      gst_pad_new_from_static_template (&g729_splice_sink_factory, "sink");
+  gst_pad_set_chain_function (splice->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_g729_splice_chain));
+  gst_pad_set_event_function (splice->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_g729_splice_sink_event));
+  GST_PAD_SET_PROXY_CAPS (splice->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (splice->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (splice), splice->sinkpad);
+
+  splice->srcpad =
+      gst_pad_new_from_static_template (&g729_splice_src_factory, "src");
+  GST_PAD_SET_PROXY_CAPS (splice->srcpad);
+  gst_element_add_pad (GST_ELEMENT (splice), splice->srcpad);
+
+  splice->max_silence = DEFAULT_MAX_SILENCE;
+  splice->bridge = DEFAULT_BRIDGE;
+  splice->channels = 0;
+}
+
+static void
+gst_g729_splice_finalize (GObject * object)
+{
+  GstG729Splice *splice = GST_G729_SPLICE (object);
+
+  g_free (splice->last_sid);
+
+  G_OBJECT_CLASS (gst_g729_splice_parent_class)->finalize (object);
+}
+
+static void
+gst_g729_splice_reset (GstG729Splice * splice)
+{
+  splice->next_ts = GST_CLOCK_TIME_NONE;
+  splice->offset = 0;
+  splice->silence = 0;
+  splice->in_dtx = FALSE;
+  splice->have_segment = FALSE;
+  splice->splice_pending = FALSE;
+}
+
+static void
+gst_g729_splice_set_channels (GstG729Splice * splice, guint channels)
+{
+  guint i;
+
+  if (channels == splice->channels)
+    return;
+
+  g_free (splice->last_sid);
+  splice->last_sid = g_new (guint8, channels * G729_SID_BYTES);
+  for (i = 0; i < channels; i++)
+    memcpy (splice->last_sid + i * G729_SID_BYTES, g729_splice_default_sid,
+        G729_SID_BYTES);
+
+  splice->channels = channels;
+}
+
+/* Accounts for duration of DTX, returns how much of it is kept */
+static GstClockTime
+gst_g729_splice_silence (GstG729Splice * splice, GstClockTime duration)
+{
+  GstClockTime keep = duration;
+
+  if (GST_CLOCK_TIME_IS_VALID (splice->max_silence)) {
+    if (splice->silence < splice->max_silence)
+      keep = MIN (duration, splice->max_silence - splice->silence);
+    else
+      keep = 0;
+  }
+
+  splice->in_dtx = TRUE;
+  splice->silence += keep;
+  splice->offset -= duration - keep;
+  splice->dropped += (duration - keep) / G729_FRAME_DURATION;
+
+  return keep;
+}
+
+/* Finds the length of the 10 ms block at data, remembering its SID
+ * frames. Returns FALSE if the payload is malformed. */
+static gboolean
+gst_g729_splice_next_block (GstG729Splice * splice, const guint8 * data,
+    gsize size, gsize * len, gboolean * speech)
+{
+  const guint8 *frame;
+  guint i;
+
+  *speech = FALSE;
+
+  if (splice->channels == 1) {
+    /* plain RFC 3551: speech frames, possibly ending with a SID */
+    *len = MIN (size, G729_FRAME_BYTES);
+    if (*len == G729_FRAME_BYTES)
+      *speech = TRUE;
+    else if (*len == G729_SID_BYTES)
+      memcpy (splice->last_sid, data, G729_SID_BYTES);
+    else
+      return FALSE;
+
+    return TRUE;
+  }
+
+  if (size < splice->channels)
+    return FALSE;
+
+  frame = data + splice->channels;
+  *len = splice->channels;
+
+  for (i = 0; i < splice->channels; i++) {
+    if (*len + data[i] > size)
+      return FALSE;
+
+    switch (data[i]) {
+      case G729_FRAME_BYTES:
+        *speech = TRUE;
+        break;
+      case G729_SID_BYTES:
+        memcpy (splice->last_sid + i * G729_SID_BYTES, frame, G729_SID_BYTES);
+        break;
+      case G729_SILENCE_BYTES:
+        break;
+      default:
+        return FALSE;
+    }
+
+    frame += data[i];
+    *len += data[i];
+  }
+
+  return TRUE;
+}
+
+/* Pushes the last SID frame of every channel, 10 ms long at ts */
+static GstFlowReturn
+gst_g729_splice_push_bridge (GstG729Splice * splice, GstClockTime ts)
+{
+  GstBuffer *outbuf;
+  GstMapInfo map;
+  guint8 *ptr;
+  guint table = splice->channels > 1 ? splice->channels : 0;
+
+  outbuf = gst_buffer_new_allocate (NULL,
+      table + splice->channels * G729_SID_BYTES, NULL);
+  if (!outbuf)
+    return GST_FLOW_ERROR;
+
+  gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
+  ptr = map.data;
+  memset (ptr, G729_SID_BYTES, table);
+  memcpy (ptr + table, splice->last_sid, splice->channels * G729_SID_BYTES);
+  gst_buffer_unmap (outbuf, &map);
+
+  GST_BUFFER_PTS (outbuf) = ts;
+  GST_BUFFER_DURATION (outbuf) = G729_FRAME_DURATION;
+  GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+
+  GST_DEBUG_OBJECT (splice, "bridging splice point at %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (ts));
+
+  splice->inserted++;
+  splice->in_dtx = TRUE;
+  splice->silence = G729_FRAME_DURATION;
+
+  return gst_pad_push (splice->srcpad, outbuf);
+}
+
+static GstFlowReturn
+gst_g729_splice_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  GstG729Splice *splice = GST_G729_SPLICE (parent);
+  GstBuffer *outbuf;
+  GstMapInfo imap, omap;
+  GstClockTime ts, out_ts = GST_CLOCK_TIME_NONE;
+  GstFlowReturn ret;
+  gsize pos = 0, out_size = 0, len;
+  guint blocks = 0, kept = 0;
+  gboolean speech;
+
+  if (splice->channels == 0) {
+    GST_ELEMENT_ERROR (splice, CORE, NEGOTIATION, (NULL),
+        ("no caps received before the first buffer"));
+    gst_buffer_unref (buf);
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  ts = GST_BUFFER_PTS (buf);
+  if (!GST_CLOCK_TIME_IS_VALID (ts))
+    ts = splice->next_ts;
+
+  if (GST_BUFFER_IS_DISCONT (buf) && GST_CLOCK_TIME_IS_VALID (splice->next_ts))
+    splice->splice_pending = TRUE;
+
+  if (splice->splice_pending) {
+    splice->splice_pending = FALSE;
+
+    if (splice->bridge && GST_CLOCK_TIME_IS_VALID (ts)) {
+      ret = gst_g729_splice_push_bridge (splice, ts + splice->offset);
+      if (ret != GST_FLOW_OK) {
+        gst_buffer_unref (buf);
+        return ret;
+      }
+      splice->offset += G729_FRAME_DURATION;
+
+      buf = gst_buffer_make_writable (buf);
+      GST_BUFFER_FLAG_UNSET (buf, GST_BUFFER_FLAG_DISCONT);
+    }
+  } else if (splice->in_dtx && GST_CLOCK_TIME_IS_VALID (ts) &&
+      GST_CLOCK_TIME_IS_VALID (splice->next_ts) && ts > splice->next_ts) {
+    /* untransmitted frames, not carried by mono streams */
+    gst_g729_splice_silence (splice, ts - splice->next_ts);
+  }
+
+  gst_buffer_map (buf, &imap, GST_MAP_READ);
+  outbuf = gst_buffer_new_allocate (NULL, imap.size, NULL);
+  gst_buffer_map (outbuf, &omap, GST_MAP_WRITE);
+
+  while (pos < imap.size) {
+    if (!gst_g729_splice_next_block (splice, imap.data + pos,
+            imap.size - pos, &len, &speech)) {
+      GST_WARNING_OBJECT (splice, "malformed payload, passing %"
+          G_GSIZE_FORMAT " bytes through", imap.size - pos);
+      memcpy (omap.data + out_size, imap.data + pos, imap.size - pos);
+      out_size += imap.size - pos;
+      break;
+    }
+
+    if (speech) {
+      splice->in_dtx = FALSE;
+      splice->silence = 0;
+    }
+
+    if (speech || gst_g729_splice_silence (splice, G729_FRAME_DURATION)) {
+      if (!GST_CLOCK_TIME_IS_VALID (out_ts) && GST_CLOCK_TIME_IS_VALID (ts))
+        out_ts = ts + blocks * G729_FRAME_DURATION + splice->offset;
+      memcpy (omap.data + out_size, imap.data + pos, len);
+      out_size += len;
+      kept++;
+    }
+
+    pos += len;
+    blocks++;
+  }
+
+  gst_buffer_unmap (outbuf, &omap);
+  gst_buffer_unmap (buf, &imap);
+
+  if (GST_CLOCK_TIME_IS_VALID (ts))
+    splice->next_ts = ts + blocks * G729_FRAME_DURATION;
+
+  if (out_size == 0) {
+    gst_buffer_unref (outbuf);
+    gst_buffer_unref (buf);
+    return GST_FLOW_OK;
+  }
+
+  if (out_size == imap.size) {
+    /* nothing trimmed, only the timestamp might move */
+    gst_buffer_unref (outbuf);
+    outbuf = gst_buffer_make_writable (buf);
+  } else {
+    gst_buffer_set_size (outbuf, out_size);
+    gst_buffer_copy_into (outbuf, buf, GST_BUFFER_COPY_FLAGS, 0, -1);
+    GST_BUFFER_DURATION (outbuf) = kept * G729_FRAME_DURATION;
+    gst_buffer_unref (buf);
+  }
+  GST_BUFFER_PTS (outbuf) = out_ts;
+
+  return gst_pad_push (splice->srcpad, outbuf);
+}
+
+static gboolean
+gst_g729_splice_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstG729Splice *splice = GST_G729_SPLICE (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps;
+      gint channels = 1;
+
+      gst_event_parse_caps (event, &caps);
+      gst_structure_get_int (gst_caps_get_structure (caps, 0), "channels",
+          &channels);
+      gst_g729_splice_set_channels (splice, channels);
+      break;
+    }
+    case GST_EVENT_SEGMENT:
+      /* the timestamps of the new segment have nothing to do with the
+       * old ones */
+      if (splice->have_segment)
+        splice->splice_pending = TRUE;
+      splice->have_segment = TRUE;
+      splice->next_ts = GST_CLOCK_TIME_NONE;
+      splice->offset = 0;
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      gst_g729_splice_reset (splice);
+      break;
+    default:
+      break;
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static GstStateChangeReturn
+gst_g729_splice_change_state (GstElement * element, GstStateChange transition)
+{
+  GstG729Splice *splice = GST_G729_SPLICE (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      gst_g729_splice_reset (splice);
+      splice->dropped = 0;
+      splice->inserted = 0;
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (gst_g729_splice_parent_class)->change_state (element,
+      transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      GST_INFO_OBJECT (splice, "trimmed %" G_GUINT64_FORMAT " frames, "
+          "inserted %" G_GUINT64_FORMAT, splice->dropped, splice->inserted);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
+
+static void
+gst_g729_splice_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstG729Splice *splice;
+
+  splice = GST_G729_SPLICE (object);
+
+  switch (prop_id) {
+    case PROP_MAX_SILENCE:
+      g_value_set_uint64 (value, splice->max_silence);
+      break;
+    case PROP_BRIDGE:
+      g_value_set_boolean (value, splice->bridge);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_g729_splice_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstG729Splice *splice;
+
+  splice = GST_G729_SPLICE (object);
+
+  switch (prop_id) {
+    case PROP_MAX_SILENCE:
+      splice->max_silence = g_value_get_uint64 (value);
+      break;
+    case PROP_BRIDGE:
+      splice->bridge = g_value_get_boolean (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
@@ -0,0 +1,233 @@
+/* GladSToNe g729 element statistics
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstg729stats.h"
+#include "g729common.h"
+#include <string.h>
+
+void
+gst_g729_stats_init (GstG729Stats * stats)
+{
+  memset (stats, 0, sizeof (GstG729Stats));
+  g_mutex_init (&stats->lock);
+}
+
+void
+gst_g729_stats_clear (GstG729Stats * stats)
+{
+  g_mutex_clear (&stats->lock);
+}
+
+void
+gst_g729_stats_reset (GstG729Stats * stats)
+{
+  GST_G729_STATS_LOCK (stats);
+  stats->speech = stats->sid = stats->untransmitted = 0;
+  stats->erased = stats->rejected = 0;
+  stats->timed = 0;
+  memset (stats->histogram, 0, sizeof (stats->histogram));
+  stats->max_time = 0;
+  stats->ticks = 0;
+  memset (stats->tick_histogram, 0, sizeof (stats->tick_histogram));
+  stats->max_tick = 0;
+  stats->duration = stats->posted = 0;
+  GST_G729_STATS_UNLOCK (stats);
+}
+
+/* Counts a frame by its payload size (10, 2 or 0 bytes) */
+void
+gst_g729_stats_add_frame (GstG729Stats * stats, guint size)
+{
+  switch (size) {
+    case G729_FRAME_BYTES:
+      stats->speech++;
+      break;
+    case G729_SID_BYTES:
+      stats->sid++;
+      break;
+    default:
+      stats->untransmitted++;
+      break;
+  }
+}
+
+/* Values below 4 get a bucket each, above that every power of two is split
+ * in four by the two bits under the leading one: at most 25% off. */
+static guint
+gst_g729_stats_bucket (guint64 value)
+{
+  guint msb;
+
+  if (value < 4)
+    return value;
+
+  msb = 63 - __builtin_clzll (value);
+  return (msb - 1) * 4 + ((value >> (msb - 2)) & 3);
+}
+
+/* Largest value falling in the bucket */
+static guint64
+gst_g729_stats_bucket_max (guint bucket)
+{
+  guint msb;
+
+  if (bucket < 4)
+    return bucket;
+  if (bucket == GST_G729_STATS_BUCKETS - 1)
+    return G_MAXUINT64;
+
+  bucket++;
+  msb = bucket / 4 + 1;
+  return ((guint64) (4 + bucket % 4) << (msb - 2)) - 1;
+}
+
+/* Records n_frames frames of time ns each */
+void
+gst_g729_stats_add_time (GstG729Stats * stats, GstClockTime time,
+    guint n_frames)
+{
+  stats->histogram[gst_g729_stats_bucket (time)] += n_frames;
+  stats->timed += n_frames;
+  if (time > stats->max_time)
+    stats->max_time = time;
+}
+
+/* Records one tick of time ns */
+void
+gst_g729_stats_add_tick (GstG729Stats * stats, GstClockTime time)
+{
+  stats->tick_histogram[gst_g729_stats_bucket (time)]++;
+  stats->ticks++;
+  if (time > stats->max_tick)
+    stats->max_tick = time;
+}
+
+/* Upper bound of the bucket holding the given fraction of the total
+ * samples, never above the maximum actually seen */
+static GstClockTime
+gst_g729_stats_percentile (const guint64 * histogram, guint64 total,
+    GstClockTime max, gdouble fraction)
+{
+  guint64 rank, count = 0;
+  guint i;
+
+  if (total == 0)
+    return 0;
+
+  rank = MAX ((guint64) (fraction * total + 0.5), 1);
+  for (i = 0; i < GST_G729_STATS_BUCKETS; i++) {
+    count += histogram[i];
+    if (count >= rank)
+      break;
+  }
+
+  return MIN (gst_g729_stats_bucket_max (i), max);
+}
+
+static GstStructure *
+gst_g729_stats_get_structure_unlocked (GstG729Stats * stats,
+    const gchar * name)
+{
+  guint64 frames = stats->speech + stats->sid + stats->untransmitted;
+  GstStructure *s;
+
+  s = gst_structure_new (name,
+      "speech-frames", G_TYPE_UINT64, stats->speech,
+      "sid-frames", G_TYPE_UINT64, stats->sid,
+      "untransmitted-frames", G_TYPE_UINT64, stats->untransmitted,
+      "erased-frames", G_TYPE_UINT64, stats->erased,
+      "rejected-buffers", G_TYPE_UINT64, stats->rejected,
+      "dtx-ratio", G_TYPE_DOUBLE,
+      frames ? (gdouble) (stats->sid + stats->untransmitted) / frames : 0.0,
+      "timed-frames", G_TYPE_UINT64, stats->timed,
+      "frame-time-p50", G_TYPE_UINT64, gst_g729_stats_percentile (
+          stats->histogram, stats->timed, stats->max_time, 0.50),
+      "frame-time-p99", G_TYPE_UINT64, gst_g729_stats_percentile (
+          stats->histogram, stats->timed, stats->max_time, 0.99),
+      "frame-time-max", G_TYPE_UINT64, stats->max_time,
+      "duration", G_TYPE_UINT64, stats->duration, NULL);
+
+  /* only g729enc times whole ticks */
+  if (stats->ticks > 0)
+    gst_structure_set (s,
+        "ticks", G_TYPE_UINT64, stats->ticks,
+        "tick-latency-p50", G_TYPE_UINT64, gst_g729_stats_percentile (
+            stats->tick_histogram, stats->ticks, stats->max_tick, 0.50),
+        "tick-latency-p99", G_TYPE_UINT64, gst_g729_stats_percentile (
+            stats->tick_histogram, stats->ticks, stats->max_tick, 0.99),
+        "tick-latency-max", G_TYPE_UINT64, stats->max_tick, NULL);
+
+  return s;
+}
+
+GstStructure *
+gst_g729_stats_get_structure (GstG729Stats * stats, const gchar * name)
+{
+  GstStructure *s;
+
+  GST_G729_STATS_LOCK (stats);
+  s = gst_g729_stats_get_structure_unlocked (stats, name);
+  GST_G729_STATS_UNLOCK (stats);
+
+  return s;
+}
+
+/* Accounts for duration more of processed audio, with the lock. Returns
+ * the statistics when another interval has elapsed since the last time
+ * they were returned, NULL otherwise or when interval is 0. */
+GstStructure *
+gst_g729_stats_advance (GstG729Stats * stats, GstClockTime duration,
+    GstClockTime interval, const gchar * name)
+{
+  stats->duration += duration;
+
+  if (interval == 0 || stats->duration - stats->posted < interval)
+    return NULL;
+
+  stats->posted = stats->duration;
+  return gst_g729_stats_get_structure_unlocked (stats, name);
+}
@@ -0,0 +1,104 @@
+/* GladSToNe g729 element statistics
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef __GST_G729_STATS_H__
+#define __GST_G729_STATS_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* log-linear buckets, four per power of two: enough for any guint64 */
+#define GST_G729_STATS_BUCKETS 252
+
+typedef struct _GstG729Stats GstG729Stats;
+
+/* Frame counters and a per-frame processing time histogram shared by
+ * g729enc and g729dec, plus a histogram of the time spent on each 10 ms
+ * block of all channels (ticks, g729enc only). Updated from the streaming
+ * thread, read from any thread; the elements gather the counts and times
+ * of each 10 ms block without the lock and take it once to fold them in. */
+struct _GstG729Stats {
+  GMutex                lock;
+
+  guint64               speech;         /* frames of each type, all channels */
+  guint64               sid;
+  guint64               untransmitted;
+  guint64               erased;
+  guint64               rejected;       /* buffers */
+
+  guint64               timed;          /* frames in the histogram */
+  guint64               histogram[GST_G729_STATS_BUCKETS];
+  GstClockTime          max_time;
+
+  guint64               ticks;          /* ticks in tick_histogram */
+  guint64               tick_histogram[GST_G729_STATS_BUCKETS];
+  GstClockTime          max_tick;
+
+  GstClockTime          duration;       /* of the audio processed */
+  GstClockTime          posted;         /* duration at the last message */
+};
+
+#define GST_G729_STATS_LOCK(s)   g_mutex_lock (&(s)->lock)
+#define GST_G729_STATS_UNLOCK(s) g_mutex_unlock (&(s)->lock)
+
+void            gst_g729_stats_init (GstG729Stats * stats);
+void            gst_g729_stats_clear (GstG729Stats * stats);
+void            gst_g729_stats_reset (GstG729Stats * stats);
+
+/* with the lock */
+void            gst_g729_stats_add_frame (GstG729Stats * stats, guint size);
+void            gst_g729_stats_add_time (GstG729Stats * stats,
+                    GstClockTime time, guint n_frames);
+void            gst_g729_stats_add_tick (GstG729Stats * stats,
+                    GstClockTime time);
+
+GstStructure *  gst_g729_stats_get_structure (GstG729Stats * stats,
+                    const gchar * name);
+GstStructure *  gst_g729_stats_advance (GstG729Stats * stats,
+                    GstClockTime duration, GstClockTime interval,
+                    const gchar * name);
+
+G_END_DECLS
+
+#endif /* __GST_G729_STATS_H__ */
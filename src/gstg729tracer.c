@@ -0,0 +1,275 @@
+/* GladSToNe g729 stage tracer
+ * Copyright (C) <2009> Gibrovacco <gibrovacco@gmail.com>
+ *
+ * It is possible to redistribute this code using the LGPL license:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ * Alternatively, you can redistribute at your choice using the MIT license,
+ * reported below:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+/**
+ * SECTION:tracer-g729stages
+ *
+ * Logs the time spent in every stage of the G729 codec (see G729Stage in
+ * g729.h) for every frame, as "g729stage" tracer records carrying the
+ * stage name, the encoder or decoder handle and the duration in ns:
+ *
+ * |[
+ * GST_TRACERS=g729stages GST_DEBUG=GST_TRACER:7 gst-launch-1.0 ...
+ * ]|
+ *
+ * The stage hook runs inside the codec, possibly with element locks held,
+ * so it only takes timestamps: the durations go to a queue owned by the
+ * thread, and are logged after the next buffer or buffer list push, from
+ * the pushing thread. Stages of a full queue are dropped and counted.
+ *
+ * It is only there when the plugin and libg729 are configured with
+ * --enable-probes; the USDT probes at the same places can be used instead
+ * without setting anything up.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstg729tracer.h"
+#include "g729.h"
+
+GST_DEBUG_CATEGORY_EXTERN (g729tracer_debug);
+#define GST_CAT_DEFAULT g729tracer_debug
+
+/* stages a thread can queue between two pushes, a power of two: enough
+ * for a few 10 ms blocks of 64 channels */
+#define QUEUE_SIZE 2048
+
+static const gchar *stage_names[G729_N_STAGES] = {
+  "enc-pre-process",
+  "enc-coder",
+  "enc-pack",
+  "dec-unpack",
+  "dec-decoder",
+  "dec-post-filter",
+  "dec-post-process",
+};
+
+typedef struct {
+  const void            *codec;
+  G729Stage             stage;
+  GstClockTime          time;
+} GstG729StageRecord;
+
+/* Stages timed by one thread, written by that thread only and read by
+ * whichever thread flushes the queues: head and tail are the only shared
+ * fields, each written by one side. */
+typedef struct {
+  GstClockTime          start[G729_N_STAGES];   /* stages never overlap */
+
+  guint                 head;       /* next record, atomic */
+  guint                 tail;       /* oldest record, atomic */
+  guint                 dropped;    /* atomic */
+  guint                 reported;   /* dropped records already logged */
+
+  GstG729StageRecord    records[QUEUE_SIZE];
+} GstG729StageQueue;
+
+static GstTracerRecord *tr_stage;
+
+/* every thread's queue; the lock is never taken by the stage hook, only
+ * to add a thread, flush and remove a thread */
+static GMutex queues_lock;
+static GList *queues;
+
+static void gst_g729_tracer_queue_free (gpointer data);
+
+static GPrivate stage_queue = G_PRIVATE_INIT (gst_g729_tracer_queue_free);
+
+G_DEFINE_TYPE (GstG729Tracer, gst_g729_tracer, GST_TYPE_TRACER);
+
+/* Logs and empties a queue, with queues_lock */
+static void
+gst_g729_tracer_queue_flush (GstG729StageQueue * queue)
+{
+  GstG729StageRecord *record;
+  guint head, tail, dropped;
+
+  head = g_atomic_int_get (&queue->head);
+  for (tail = queue->tail; tail != head; tail++) {
+    record = &queue->records[tail % QUEUE_SIZE];
+    gst_tracer_record_log (tr_stage, stage_names[record->stage],
+        (guint64) (guintptr) record->codec, record->time);
+  }
+  g_atomic_int_set (&queue->tail, tail);
+
+  dropped = g_atomic_int_get (&queue->dropped);
+  if (dropped != queue->reported) {
+    GST_WARNING ("dropped %u stage records of a full queue",
+        dropped - queue->reported);
+    queue->reported = dropped;
+  }
+}
+
+static void
+gst_g729_tracer_flush (void)
+{
+  GList *l;
+
+  g_mutex_lock (&queues_lock);
+  for (l = queues; l; l = l->next)
+    gst_g729_tracer_queue_flush (l->data);
+  g_mutex_unlock (&queues_lock);
+}
+
+static GstG729StageQueue *
+gst_g729_tracer_queue_new (void)
+{
+  GstG729StageQueue *queue = g_new0 (GstG729StageQueue, 1);
+
+  g_mutex_lock (&queues_lock);
+  queues = g_list_prepend (queues, queue);
+  g_mutex_unlock (&queues_lock);
+
+  return queue;
+}
+
+/* on thread exit: what it timed last is still logged */
+static void
+gst_g729_tracer_queue_free (gpointer data)
+{
+  GstG729StageQueue *queue = data;
+
+  g_mutex_lock (&queues_lock);
+  gst_g729_tracer_queue_flush (queue);
+  queues = g_list_remove (queues, queue);
+  g_mutex_unlock (&queues_lock);
+
+  g_free (queue);
+}
+
+static void
+gst_g729_tracer_stage (const void *codec, G729Stage stage, int end,
+    void *user_data)
+{
+  GstG729StageQueue *queue = g_private_get (&stage_queue);
+  GstG729StageRecord *record;
+  GstClockTime now = gst_util_get_timestamp ();
+  guint head;
+
+  if (G_UNLIKELY (!queue)) {
+    queue = gst_g729_tracer_queue_new ();
+    g_private_set (&stage_queue, queue);
+  }
+
+  if (!end) {
+    queue->start[stage] = now;
+    return;
+  }
+
+  head = queue->head;
+  if (head - g_atomic_int_get (&queue->tail) >= QUEUE_SIZE) {
+    g_atomic_int_inc (&queue->dropped);
+    return;
+  }
+
+  record = &queue->records[head % QUEUE_SIZE];
+  record->codec = codec;
+  record->stage = stage;
+  record->time = now - queue->start[stage];
+  g_atomic_int_set (&queue->head, head + 1);
+}
+
+/* pad-push-post and pad-push-list-post: the codec is done with the
+ * buffer, and no element lock is held */
+static void
+gst_g729_tracer_push_post (GObject * self, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  gst_g729_tracer_flush ();
+}
+
+static void
+gst_g729_tracer_finalize (GObject * object)
+{
+  g729_stage_set_hook (NULL, NULL);
+  gst_g729_tracer_flush ();
+
+  G_OBJECT_CLASS (gst_g729_tracer_parent_class)->finalize (object);
+}
+
+static void
+gst_g729_tracer_class_init (GstG729TracerClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
+  gobject_class->finalize = gst_g729_tracer_finalize;
+
+  tr_stage = gst_tracer_record_new ("g729stage.class",
+      "stage", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE,
+          GST_TRACER_VALUE_SCOPE_PROCESS,
+          "description", G_TYPE_STRING, "codec stage", NULL),
+      "codec", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE,
+          GST_TRACER_VALUE_SCOPE_PROCESS,
+          "description", G_TYPE_STRING,
+          "encoder or decoder handle (one per channel)", NULL),
+      "time", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE,
+          GST_TRACER_VALUE_SCOPE_PROCESS,
+          "description", G_TYPE_STRING, "time spent in the stage (in ns)",
+          "min", G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
+          "max", G_TYPE_UINT64, G_MAXUINT64, NULL),
+      NULL);
+  GST_OBJECT_FLAG_SET (tr_stage, GST_OBJECT_FLAG_MAY_BE_LEAKED);
+}
+
+static void
+gst_g729_tracer_init (GstG729Tracer * tracer)
+{
+  if (!g729_stage_set_hook (gst_g729_tracer_stage, tracer)) {
+    GST_WARNING_OBJECT (tracer, "libg729 was built without stage probes");
+    return;
+  }
+
+  gst_tracing_register_hook (GST_TRACER (tracer), "pad-push-post",
+      G_CALLBACK (gst_g729_tracer_push_post));
+  gst_tracing_register_hook (GST_TRACER (tracer), "pad-push-list-post",
+      G_CALLBACK (gst_g729_tracer_push_post));
+}